@@ -16,5 +16,8 @@ REM Compile the vertex shader
 REM Compile the fragment shader
 "%GLSLC%" "%SHADER_DIR%\point_light.frag" -o "%SHADER_DIR%\point_light.frag.spv"
 
+REM Compile the culling compute shader
+"%GLSLC%" "%SHADER_DIR%\cull.comp" -o "%SHADER_DIR%\cull.comp.spv"
+
 echo Shader compilation complete.
 pause
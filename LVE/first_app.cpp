@@ -21,44 +21,58 @@
 namespace lve {
 
 	FirstApp::FirstApp() {
+		// a single set for every frame in flight, the frame's slot of the global ubo is picked with a dynamic offset
 		globalPool = LveDescriptorPool::Builder(lveDevice)
-			.setMaxSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT)
-			.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, LveSwapChain::MAX_FRAMES_IN_FLIGHT)
+			.setMaxSets(1)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1)
 			.build();
 
+		if (PARALLEL_RECORDING)
+			lveRenderer.enableParallelRecording();
+
 		loadGameObjects();
 
+		// every model's copies go out in one batch, the first frame is submitted after it on the same queue
+		uploadQueue.submit();
+		uploadQueue.printStats(std::cout);
+		geometryPool.printReport(std::cout);
+		lveDevice.memoryAllocator().printStats(std::cout);
+		lveDevice.memoryAllocator().printBudget(std::cout);
+
 	} // FirstApp
 
 	// this is a check to see if the user has closed the window
 	void FirstApp::run() {
-		std::vector<std::unique_ptr<LveBuffer>> uboBuffers(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-		for (int i = 0; i < uboBuffers.size(); i++) {
-			uboBuffers[i] = std::make_unique<LveBuffer>(
-				lveDevice, 
-				sizeof(GlobalUbo), 
-				1,
-				VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, 
-				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT  
+		// one persistently mapped buffer with a slot per frame in flight, each slot aligned so it can be bound on its own
+		LveBuffer uboBuffer{
+			lveDevice,
+			sizeof(GlobalUbo),
+			LveSwapChain::MAX_FRAMES_IN_FLIGHT,
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			lveDevice.properties.limits.minUniformBufferOffsetAlignment
 
-			); // uboBuffers
+		}; // uboBuffer
 
-			uboBuffers[i]->map();
+		uboBuffer.map();
 
-		} // for
+		// what each slot currently holds, so a frame only writes and flushes the parts of the ubo that changed
+		std::vector<GlobalUbo> uboShadows(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+		for (size_t i = 0; i < uboShadows.size(); i++)
+			uboBuffer.writeToIndex(&uboShadows[i], static_cast<int>(i));
+
+		uboBuffer.flushDirty();
 
 		auto globalSetLayout = LveDescriptorSetLayout::Builder(lveDevice)
-			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_ALL_GRAPHICS)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_ALL_GRAPHICS)
 			.build();
 
-		std::vector<VkDescriptorSet> globalDescriptorSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-		for	(int i = 0; i < globalDescriptorSets.size(); i++) {
-			auto bufferInfo = uboBuffers[i]->descriptorInfo();
-			LveDescriptorWriter(*globalSetLayout, *globalPool) // we want to access the contents 
-				.writeBuffer(0, &bufferInfo)
-				.build(globalDescriptorSets[i]);
-
-		} // for
+		// the descriptor covers one slot, the dynamic offset given at bind time moves it to the frame's slot
+		VkDescriptorSet globalDescriptorSet;
+		auto bufferInfo = uboBuffer.descriptorInfo(sizeof(GlobalUbo), 0);
+		LveDescriptorWriter(*globalSetLayout, *globalPool) // we want to access the contents
+			.writeBuffer(0, &bufferInfo)
+			.build(globalDescriptorSet);
 
 		SimpleRenderSystem simpleRenderSystem{ lveDevice, lveRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
 		PointLightSystem pointLightSystem{ lveDevice, lveRenderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout() };
@@ -68,10 +82,11 @@ namespace lve {
 
 		// this model has nothing in it and won't be rendered. It sole purpose is to store the camera's current state
 		auto viewerObject = LveGameObject::createGameObject();
-		viewerObject.transform.translation.z = -2.5f;
+		viewerObject.transform.setTranslation({ 0.f, 0.f, -2.5f });
 		KeyboardMovementController cameraController{};
 
 		auto currentTime = std::chrono::high_resolution_clock::now();
+		float memoryLogTime = 0.f;
 
 		while (!lveWindow.shouldClose()) { // the condition checks if they have noc closed it
 
@@ -81,8 +96,19 @@ namespace lve {
 
 			frameTime = glm::min(frameTime, 10.f);
 
+			// other processes change what the driver leaves us, so the budget is logged while running, not just at startup
+			memoryLogTime += frameTime;
+			if (memoryLogTime >= MEMORY_LOG_INTERVAL) {
+				lveDevice.memoryAllocator().printBudget(std::cout);
+				memoryLogTime = 0.f;
+
+			} // if
+
+			// sends off whatever was loaded since the last frame and hands finished uploads to the graphics queue
+			uploadQueue.submit();
+
 			cameraController.moveInPlaneXZ(lveWindow.getGLFWwindow(), frameTime, viewerObject);
-			camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
+			camera.setViewYXZ(viewerObject.transform.getTranslation(), viewerObject.transform.getRotation());
 
 			glfwPollEvents(); // a window processing events call
 
@@ -91,14 +117,22 @@ namespace lve {
 
 			if (auto commandBuffer = lveRenderer.beginFrame()) {
 				int frameIndex = lveRenderer.getFrameIndex();
+				frameAllocator.beginFrame(frameIndex);
+
+				// a bounded slice of compaction each frame, the copies have to be recorded outside the render pass
+				geometryPool.defragment(commandBuffer);
+
 				FrameInfo frameInfo	
 				{
 					frameIndex,
 					frameTime,
 					commandBuffer,
 					camera,
-					globalDescriptorSets[frameIndex],
-					gameObjects
+					globalDescriptorSet,
+					static_cast<uint32_t>(frameIndex * uboBuffer.getAlignmentSize()),
+					gameObjects,
+					frameAllocator,
+					lveRenderer.getParallelRecorder()
 
 				}; // FrameInfo
 
@@ -108,8 +142,11 @@ namespace lve {
 				ubo.view = camera.getView();   
 				ubo.inverseView = camera.getInverseView();
 				pointLightSystem.update(frameInfo, ubo);
-				uboBuffers[frameIndex]->writeToBuffer(&ubo);
-				uboBuffers[frameIndex]->flush();
+				uboBuffer.writeChangedToIndex(&ubo, &uboShadows[frameIndex], frameIndex);
+				uboBuffer.flushDirty();
+
+				// instances and the GPU culling pass, recorded before the render pass begins
+				simpleRenderSystem.prepareGameObjects(frameInfo);
 
 				// render
 				lveRenderer.beginSwapChainRenderPass(commandBuffer); 
@@ -120,6 +157,7 @@ namespace lve {
 				pointLightSystem.render(frameInfo); 
 
 				lveRenderer.endSwapChainRenderPass(commandBuffer);
+				frameAllocator.flush();
 				lveRenderer.endFrame();
 
 			} // if
@@ -127,36 +165,46 @@ namespace lve {
 		} // while
 
 		vkDeviceWaitIdle(lveDevice.device());
+		frameAllocator.printStats(std::cout);
+		geometryPool.printReport(std::cout);
+		simpleRenderSystem.getRenderQueue().printStats(std::cout, "game objects");
+		pointLightSystem.getRenderQueue().printStats(std::cout, "point lights");
 
 	} // run
 
 	
 	void FirstApp::loadGameObjects() {
-		std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(lveDevice, "models/smooth_vase.obj");
+		ModelLoadConfigInfo modelConfig{};
+		modelConfig.optimizeMesh = true;
+		modelConfig.compactVertices = true;
+		modelConfig.buildMeshlets = true;
+		modelConfig.buildLods = true;
+
+		std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(geometryPool, "models/smooth_vase.obj", modelConfig);
 
 		// we need to make sure our objects are within a Viewing Volume,
 		// Viewing Volume: only what is inside the viewing volume is displayed
 
 		auto flatVase = LveGameObject::createGameObject();
 		flatVase.model = lveModel;
-		flatVase.transform.translation = { -.5f, .5f, 0.f };
-		flatVase.transform.scale = { 3.f, 1.5f, 3.f };
+		flatVase.transform.setTranslation({ -.5f, .5f, 0.f });
+		flatVase.transform.setScale({ 3.f, 1.5f, 3.f });
 
 		gameObjects.emplace(flatVase.getId(), std::move(flatVase)); 
 
-		lveModel = LveModel::createModelFromFile(lveDevice, "models/flat_vase.obj");
+		lveModel = LveModel::createModelFromFile(geometryPool, "models/flat_vase.obj", modelConfig);
 		auto smoothVase = LveGameObject::createGameObject();
 		smoothVase.model = lveModel;
-		smoothVase.transform.translation = { .5f, .5f, 0.f };
-		smoothVase.transform.scale = { 3.f, 1.5f, 3.f };
+		smoothVase.transform.setTranslation({ .5f, .5f, 0.f });
+		smoothVase.transform.setScale({ 3.f, 1.5f, 3.f });
 
 		gameObjects.emplace(smoothVase.getId(), std::move(smoothVase)); 
 
-		lveModel = LveModel::createModelFromFile(lveDevice, "models/quad.obj");
+		lveModel = LveModel::createModelFromFile(geometryPool, "models/quad.obj", modelConfig);
 		auto quad = LveGameObject::createGameObject();
 		quad.model = lveModel;
-		quad.transform.translation = { 0.f, .5f, 0.f };
-		quad.transform.scale = { 3.f, 1.f, 3.f };
+		quad.transform.setTranslation({ 0.f, .5f, 0.f });
+		quad.transform.setScale({ 3.f, 1.f, 3.f });
 
 		gameObjects.emplace(quad.getId(), std::move(quad)); 
 
@@ -181,7 +229,7 @@ namespace lve {
 
 			); // rotateLight
 
-			pointLight.transform.translation = glm::vec3(rotateLight * glm::vec4(-1.f, -1.f, -1.f, 1.f));
+			pointLight.transform.setTranslation(glm::vec3(rotateLight * glm::vec4(-1.f, -1.f, -1.f, 1.f)));
 			gameObjects.emplace(pointLight.getId(), std::move(pointLight));
 
 		} // for
@@ -5,6 +5,8 @@
 #include "lve_renderer.hpp"
 #include "lve_game_object.hpp"
 #include "lve_descriptors.hpp"
+#include "lve_geometry_pool.hpp"
+#include "lve_frame_allocator.hpp"
 
 // std
 #include <memory>
@@ -16,6 +18,10 @@ namespace lve {
     public:
         int static constexpr WIDTH = 800;
         int static constexpr HEIGHT = 600;
+        // seconds between two memory budget lines in the log
+        float static constexpr MEMORY_LOG_INTERVAL = 5.f;
+        // records the render pass as secondary command buffers on every hardware thread, pays off with many objects
+        bool static constexpr PARALLEL_RECORDING = false;
         void run();
 
         FirstApp();
@@ -30,10 +36,15 @@ namespace lve {
         LveWindow lveWindow{ WIDTH, HEIGHT, "Hello Vulkan!" };
         LveDevice lveDevice{ lveWindow };
         LveRenderer lveRenderer{ lveWindow, lveDevice };
+        LveFrameAllocator frameAllocator{ lveDevice, LveSwapChain::MAX_FRAMES_IN_FLIGHT };
         std::unique_ptr<LveModel> lveModel;
 
         // Note: order of declaration matters
         // we want the pool to be desctroyed before the devices
+        // the models in gameObjects give their ranges back to the geometry pool, so it has to outlive them
+        // the geometry pool queues its copies on the upload queue, so the queue has to outlive it
+        LveUploadQueue uploadQueue{ lveDevice };
+        LveGeometryPool geometryPool{ lveDevice, uploadQueue };
         std::unique_ptr<LveDescriptorPool> globalPool{};
         LveGameObject::Map gameObjects;
 
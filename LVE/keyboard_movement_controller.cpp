@@ -20,18 +20,21 @@ namespace lve {
 		if (glfwGetKey(window, keys.lookDown) == GLFW_PRESS)
 			rotate.x -= 1.f;
 
+		glm::vec3 rotation = gameObject.transform.getRotation();
+
 		// Normalize rotation if it's non-zero
 		if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon()) {
 			// the reason we need to do this check is because should be try to normalize the vector ourselves the equation will not work
-			gameObject.transform.rotation += lookSpeed * dt * glm::normalize(rotate);
+			rotation += lookSpeed * dt * glm::normalize(rotate);
 	
 		} // if
 
 		// to prevent the game object from going upside down, we clamp it so the rotation is limit to about +- 85 degrees
-		gameObject.transform.rotation.x = glm::clamp(gameObject.transform.rotation.x, -glm::half_pi<float>(), glm::half_pi<float>());
-		gameObject.transform.rotation.y = glm::mod(gameObject.transform.rotation.y, glm::two_pi<float>()); // prevents spinning in 1 directin so the value does not overflow
+		rotation.x = glm::clamp(rotation.x, -glm::half_pi<float>(), glm::half_pi<float>());
+		rotation.y = glm::mod(rotation.y, glm::two_pi<float>()); // prevents spinning in 1 directin so the value does not overflow
+		gameObject.transform.setRotation(rotation);
 		
-		float yaw = gameObject.transform.rotation.y;
+		float yaw = rotation.y;
 		const glm::vec3 forwardDir{ sin(yaw), 0.f, cos(yaw) };
 		const glm::vec3 rightDir{ forwardDir.z, 0.f, -forwardDir.x };
 		const glm::vec3 upDir{ 0.f, -1.f, 0.f };
@@ -59,7 +62,7 @@ namespace lve {
 		// remember when a vector is dot product with itself the answer is 0
 		if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon()) {
 			// the reason we need to do this check is because should be try to normalize the vector ourselves the equation will not work
-			gameObject.transform.translation += moveSpeed * dt * glm::normalize(moveDir);
+			gameObject.transform.setTranslation(gameObject.transform.getTranslation() + moveSpeed * dt * glm::normalize(moveDir));
 
 		} // if
 
@@ -0,0 +1,1700 @@
+#include "lve_benchmarks.hpp"
+#include "lve_buffer.hpp"
+#include "lve_camera.hpp"
+#include "lve_device.hpp"
+#include "lve_geometry_pool.hpp"
+#include "lve_mesh_optimizer.hpp"
+#include "lve_model.hpp"
+#include "lve_frustum.hpp"
+#include "lve_frustum_culler.hpp"
+#include "lve_gpu_culling.hpp"
+#include "lve_obj_parser.hpp"
+#include "lve_parallel_recorder.hpp"
+#include "lve_range_allocator.hpp"
+#include "lve_range_pool.hpp"
+#include "lve_render_queue.hpp"
+#include "lve_transform_batch.hpp"
+
+// libs
+#include <glm/gtc/constants.hpp>
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace lve {
+
+	namespace {
+
+		struct Benchmark {
+			const char* name;
+			const char* usage;
+			std::function<int(const std::vector<std::string>&)> run;
+
+		}; // Benchmark
+
+		const std::vector<Benchmark>& benchmarks() {
+			static const std::vector<Benchmark> list = {
+				{ "obj-loaders", "[directory=models] [iterations=5]", benchmarkObjLoaders },
+				{ "vertex-weld", "[file=models/Snorlax.obj] [iterations=10]", benchmarkVertexWeld },
+				{ "mesh-optimizer", "[directory=models]", benchmarkMeshOptimizer },
+				{ "compact-vertices", "[directory=models]", benchmarkCompactVertices },
+				{ "meshlets", "[directory=models] [views=64]", benchmarkMeshlets },
+				{ "lods", "[directory=models] [samples=2000]", benchmarkLods },
+				{ "range-allocator", "[operations=100000] [alignment=1]", benchmarkRangeAllocator },
+				{ "defragmenter", "[frames=20000] [budgetKiB=2048]", benchmarkDefragmenter },
+				{ "frustum-culling", "[iterations=10] [objects=10000 100000 1000000]", benchmarkFrustumCulling },
+				{ "render-queue", "[packets=100000] [models=256] [iterations=10]", benchmarkRenderQueue },
+				{ "transforms", "[objects=100000] [dynamicPercent=10] [iterations=10]", benchmarkTransforms },
+				{ "gpu-culling", "[objects=10000] [batches=8] [iterations=10]", benchmarkGpuCulling },
+				{ "parallel-recording", "[tasks=256] [itemsPerTask=256] [maxThreads=hardware] [iterations=10]", benchmarkParallelRecording },
+
+			}; // list
+
+			return list;
+
+		} // benchmarks
+
+		// best of n runs in milliseconds, the first run also warms the file cache
+		double timeBestOf(int iterations, const std::function<void()>& function) {
+			double best = 0.0;
+			for (int i = 0; i < iterations; i++) {
+				auto start = std::chrono::high_resolution_clock::now();
+				function();
+				auto end = std::chrono::high_resolution_clock::now();
+
+				double ms = std::chrono::duration<double, std::milli>(end - start).count();
+				best = i == 0 ? ms : std::min(best, ms);
+
+			} // for
+
+			return best;
+
+		} // timeBestOf
+
+		template <typename T>
+		bool sameBits(const std::vector<T>& a, const std::vector<T>& b) {
+			return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+
+		} // sameBits
+
+		bool sameObjData(const LveObjData& a, const LveObjData& b) {
+			if (!sameBits(a.attrib.vertices, b.attrib.vertices) || !sameBits(a.attrib.colors, b.attrib.colors) ||
+				!sameBits(a.attrib.normals, b.attrib.normals) || !sameBits(a.attrib.texcoords, b.attrib.texcoords))
+				return false;
+
+			if (a.indices.size() != b.indices.size())
+				return false;
+
+			for (size_t i = 0; i < a.indices.size(); i++) {
+				const auto& x = a.indices[i];
+				const auto& y = b.indices[i];
+				if (x.vertex_index != y.vertex_index || x.normal_index != y.normal_index || x.texcoord_index != y.texcoord_index)
+					return false;
+
+			} // for
+
+			return true;
+
+		} // sameObjData
+
+		// every triangle as the bytes of its three vertices, sorted, equal when two meshes draw the same triangles
+		std::vector<std::string> triangleSet(const LveModel::Builder& builder) {
+			std::vector<std::string> triangles(builder.indices.size() / 3);
+			for (size_t t = 0; t < triangles.size(); t++) {
+				for (int k = 0; k < 3; k++) {
+					const auto& vertex = builder.vertices[builder.indices[t * 3 + k]];
+					triangles[t].append(reinterpret_cast<const char*>(&vertex), sizeof(vertex));
+
+				} // for
+
+			} // for
+
+			std::sort(triangles.begin(), triangles.end());
+			return triangles;
+
+		} // triangleSet
+
+		// closest point on a triangle (Ericson, "Real-Time Collision Detection" 5.1.5), returned as the distance to it
+		float pointTriangleDistance(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+			glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+			float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+			if (d1 <= 0.f && d2 <= 0.f)
+				return glm::length(p - a);
+
+			glm::vec3 bp = p - b;
+			float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+			if (d3 >= 0.f && d4 <= d3)
+				return glm::length(p - b);
+
+			float vc = d1 * d4 - d3 * d2;
+			if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+				return glm::length(p - (a + ab * (d1 / (d1 - d3))));
+
+			glm::vec3 cp = p - c;
+			float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+			if (d6 >= 0.f && d5 <= d6)
+				return glm::length(p - c);
+
+			float vb = d5 * d2 - d1 * d6;
+			if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+				return glm::length(p - (a + ac * (d2 / (d2 - d6))));
+
+			float va = d3 * d6 - d5 * d4;
+			if (va <= 0.f && d4 - d3 >= 0.f && d5 - d6 >= 0.f)
+				return glm::length(p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)))));
+
+			float denominator = 1.f / (va + vb + vc);
+			return glm::length(p - (a + ab * (vb * denominator) + ac * (vc * denominator)));
+
+		} // pointTriangleDistance
+
+		// a width x 1 R32_UINT color attachment for the device benchmarks, cleared to 0 when its render pass begins and
+		// copied into a host visible buffer after it ends, so what the GPU wrote can be checked pixel by pixel
+		class OffscreenTarget {
+		public:
+			OffscreenTarget(LveDevice& device, uint32_t width)
+				: lveDevice{ device }, width{ width },
+				readback{ device, sizeof(uint32_t), width, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT } {
+				VkImageCreateInfo imageInfo{};
+				imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				imageInfo.imageType = VK_IMAGE_TYPE_2D;
+				imageInfo.extent = { width, 1, 1 };
+				imageInfo.mipLevels = 1;
+				imageInfo.arrayLayers = 1;
+				imageInfo.format = VK_FORMAT_R32_UINT;
+				imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+				imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+				imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+				imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				lveDevice.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
+
+				VkImageViewCreateInfo viewInfo{};
+				viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				viewInfo.image = image;
+				viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+				viewInfo.format = VK_FORMAT_R32_UINT;
+				viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+				if (vkCreateImageView(lveDevice.device(), &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+					throw std::runtime_error("failed to create offscreen image view!");
+
+				VkAttachmentDescription attachment{};
+				attachment.format = VK_FORMAT_R32_UINT;
+				attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+				attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+				attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+				attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+				attachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+				VkAttachmentReference colorAttachment{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+				VkSubpassDescription subpass{};
+				subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+				subpass.colorAttachmentCount = 1;
+				subpass.pColorAttachments = &colorAttachment;
+
+				// the copy after the render pass waits for everything written in it
+				VkSubpassDependency dependency{};
+				dependency.srcSubpass = 0;
+				dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+				dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+				dependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+				dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+				dependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+				VkRenderPassCreateInfo renderPassInfo{};
+				renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+				renderPassInfo.attachmentCount = 1;
+				renderPassInfo.pAttachments = &attachment;
+				renderPassInfo.subpassCount = 1;
+				renderPassInfo.pSubpasses = &subpass;
+				renderPassInfo.dependencyCount = 1;
+				renderPassInfo.pDependencies = &dependency;
+				if (vkCreateRenderPass(lveDevice.device(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+					throw std::runtime_error("failed to create offscreen render pass!");
+
+				VkFramebufferCreateInfo framebufferInfo{};
+				framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+				framebufferInfo.renderPass = renderPass;
+				framebufferInfo.attachmentCount = 1;
+				framebufferInfo.pAttachments = &imageView;
+				framebufferInfo.width = width;
+				framebufferInfo.height = 1;
+				framebufferInfo.layers = 1;
+				if (vkCreateFramebuffer(lveDevice.device(), &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+					throw std::runtime_error("failed to create offscreen framebuffer!");
+
+				readback.map();
+
+			} // OffscreenTarget
+
+			~OffscreenTarget() {
+				vkDestroyFramebuffer(lveDevice.device(), framebuffer, nullptr);
+				vkDestroyRenderPass(lveDevice.device(), renderPass, nullptr);
+				vkDestroyImageView(lveDevice.device(), imageView, nullptr);
+				vkDestroyImage(lveDevice.device(), image, nullptr);
+				lveDevice.memoryAllocator().free(imageMemory);
+
+			} // ~OffscreenTarget
+
+			OffscreenTarget(const OffscreenTarget&) = delete;
+			OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+			VkRenderPass getRenderPass() const { return renderPass; } // getRenderPass
+			VkFramebuffer getFramebuffer() const { return framebuffer; } // getFramebuffer
+			VkExtent2D getExtent() const { return { width, 1 }; } // getExtent
+
+			void beginRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents) {
+				VkClearValue clearValue{};
+				VkRenderPassBeginInfo beginInfo{};
+				beginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+				beginInfo.renderPass = renderPass;
+				beginInfo.framebuffer = framebuffer;
+				beginInfo.renderArea = { { 0, 0 }, getExtent() };
+				beginInfo.clearValueCount = 1;
+				beginInfo.pClearValues = &clearValue;
+				vkCmdBeginRenderPass(commandBuffer, &beginInfo, contents);
+
+			} // beginRenderPass
+
+			// after the render pass has ended, the pixels can be read once the command buffer has completed
+			void copyToReadback(VkCommandBuffer commandBuffer) {
+				VkBufferImageCopy region{};
+				region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+				region.imageExtent = { width, 1, 1 };
+				vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.getBuffer(), 1, &region);
+
+				VkMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			} // copyToReadback
+
+			std::vector<uint32_t> read() {
+				readback.invalidate();
+				std::vector<uint32_t> pixels(width);
+				std::memcpy(pixels.data(), readback.getMappedMemory(), width * sizeof(uint32_t));
+				return pixels;
+
+			} // read
+
+		private:
+			LveDevice& lveDevice;
+			uint32_t width;
+			VkImage image;
+			LveMemoryAllocation imageMemory;
+			VkImageView imageView;
+			VkRenderPass renderPass;
+			VkFramebuffer framebuffer;
+			LveBuffer readback;
+
+		}; // OffscreenTarget
+
+		// submits a recorded primary command buffer to the graphics queue and waits for it
+		void submitAndWait(LveDevice& device, VkCommandBuffer commandBuffer) {
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &commandBuffer;
+			if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+				throw std::runtime_error("failed to submit benchmark command buffer!");
+
+			vkQueueWaitIdle(device.graphicsQueue());
+
+		} // submitAndWait
+
+	} // namespace
+
+	int runBenchmarks(const std::vector<std::string>& args) {
+		if (!args.empty()) {
+			for (const auto& benchmark : benchmarks()) {
+				if (args[0] == benchmark.name)
+					return benchmark.run(std::vector<std::string>(args.begin() + 1, args.end()));
+
+			} // for
+
+			std::cerr << "unknown benchmark: " << args[0] << "\n";
+
+		} // if
+
+		std::cout << "available benchmarks:\n";
+		for (const auto& benchmark : benchmarks())
+			std::cout << "  --benchmark " << benchmark.name << " " << benchmark.usage << "\n";
+
+		return args.empty() ? 0 : 1;
+
+	} // runBenchmarks
+
+	int benchmarkObjLoaders(const std::vector<std::string>& args) {
+		std::string directory = args.size() > 0 ? args[0] : "models";
+		int iterations = args.size() > 1 ? std::max(1, std::stoi(args[1])) : 5;
+
+		std::vector<std::string> files;
+		for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".obj")
+				files.push_back(entry.path().string());
+
+		} // for
+
+		std::sort(files.begin(), files.end());
+
+		uint32_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+		std::vector<uint32_t> threadCounts = { 1, 2, 4, 8 };
+		if (std::find(threadCounts.begin(), threadCounts.end(), hardwareThreads) == threadCounts.end())
+			threadCounts.push_back(hardwareThreads);
+
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << "obj loaders, best of " << iterations << ", " << hardwareThreads << " hardware threads\n";
+
+		bool allIdentical = true;
+		for (const auto& file : files) {
+			LveObjData reference{};
+			double tinyObjMs = timeBestOf(iterations, [&]() { LveObjParser::loadWithTinyObj(file, reference); });
+
+			LveModel::Builder referenceBuilder{};
+			referenceBuilder.loadModel(file, ModelLoadConfigInfo{ 1 });
+
+			std::cout << file << " (" << std::filesystem::file_size(file) / 1024 << " KiB)\n";
+			std::cout << "  tinyobj            " << std::setw(9) << tinyObjMs << " ms\n";
+
+			for (uint32_t threadCount : threadCounts) {
+				LveObjData data{};
+				bool supported = true;
+				double parserMs = timeBestOf(iterations, [&]() { supported = LveObjParser::load(file, threadCount, data); });
+
+				if (!supported) {
+					std::cout << "  parallel           unsupported (polygons with more than 4 corners), tinyobj fallback\n";
+					break;
+
+				} // if
+
+				// the welded builder output has to match too, not just the raw attributes
+				LveModel::Builder builder{};
+				builder.loadModel(file, ModelLoadConfigInfo{ threadCount });
+				bool identical = sameObjData(reference, data) &&
+					sameBits(referenceBuilder.vertices, builder.vertices) && referenceBuilder.indices == builder.indices;
+
+				allIdentical &= identical;
+
+				std::cout << "  parallel " << std::setw(2) << threadCount << " threads" << std::setw(9) << parserMs << " ms  "
+					<< std::setw(5) << tinyObjMs / parserMs << "x  " << (identical ? "identical" : "MISMATCH") << "\n";
+
+			} // for
+
+		} // for
+
+		return allIdentical ? 0 : 1;
+
+	} // benchmarkObjLoaders
+
+	int benchmarkVertexWeld(const std::vector<std::string>& args) {
+		std::string file = args.size() > 0 ? args[0] : "models/Snorlax.obj";
+		int iterations = args.size() > 1 ? std::max(1, std::stoi(args[1])) : 10;
+
+		LveObjData obj{};
+		LveObjParser::loadWithTinyObj(file, obj);
+
+		struct Mode {
+			const char* name;
+			VertexWeldMode weldMode;
+
+		}; // Mode
+
+		const Mode modes[] = {
+			{ "hash map          ", VertexWeldMode::HashMap },
+			{ "index tuple       ", VertexWeldMode::IndexTuple },
+			{ "index tuple sorted", VertexWeldMode::IndexTupleSorted },
+
+		}; // modes
+
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << file << ", " << obj.indices.size() << " corners, best of " << iterations << "\n";
+
+		LveModel::Builder reference{};
+		reference.weldVertices(obj, VertexWeldMode::HashMap);
+
+		bool sortedIdentical = true;
+		double hashMapMs = 0.0;
+		for (const Mode& mode : modes) {
+			LveModel::Builder builder{};
+			double ms = timeBestOf(iterations, [&]() { builder.weldVertices(obj, mode.weldMode); });
+			if (mode.weldMode == VertexWeldMode::HashMap)
+				hashMapMs = ms;
+
+			bool identical = sameBits(reference.vertices, builder.vertices) && reference.indices == builder.indices;
+			if (mode.weldMode == VertexWeldMode::IndexTupleSorted)
+				sortedIdentical = identical;
+
+			std::cout << "  " << mode.name << std::setw(9) << ms << " ms  " << std::setw(6) << hashMapMs / ms << "x  "
+				<< builder.vertices.size() << " vertices  " << (identical ? "identical" : "differs") << "\n";
+
+		} // for
+
+		// IndexTuple alone is allowed to keep duplicates, the sorted weld has to match exactly
+		return sortedIdentical ? 0 : 1;
+
+	} // benchmarkVertexWeld
+
+	int benchmarkMeshOptimizer(const std::vector<std::string>& args) {
+		std::string directory = args.size() > 0 ? args[0] : "models";
+
+		std::vector<std::string> files;
+		for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".obj")
+				files.push_back(entry.path().string());
+
+		} // for
+
+		std::sort(files.begin(), files.end());
+
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << "ACMR with a " << LveMeshOptimizer::CACHE_SIZE << " entry FIFO: original -> vertex cache -> overdraw\n";
+
+		bool allEquivalent = true;
+		for (const auto& file : files) {
+			LveModel::Builder builder{};
+			builder.loadModel(file);
+			auto before = triangleSet(builder);
+			size_t vertexCount = builder.vertices.size();
+
+			float acmrOriginal = LveMeshOptimizer::computeAcmr(builder.indices, vertexCount);
+
+			auto start = std::chrono::high_resolution_clock::now();
+			LveMeshOptimizer::optimizeVertexCache(builder.indices, vertexCount);
+			float acmrCache = LveMeshOptimizer::computeAcmr(builder.indices, vertexCount);
+			LveMeshOptimizer::optimizeOverdraw(builder.indices, builder.vertices);
+			float acmrOverdraw = LveMeshOptimizer::computeAcmr(builder.indices, vertexCount);
+			LveMeshOptimizer::optimizeVertexFetch(builder.vertices, builder.indices);
+			auto end = std::chrono::high_resolution_clock::now();
+
+			bool equivalent = before == triangleSet(builder);
+			allEquivalent &= equivalent;
+
+			size_t indexSize = builder.vertices.size() < 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+			std::cout << file << ": " << acmrOriginal << " -> " << acmrCache << " -> " << acmrOverdraw
+				<< ", " << std::chrono::duration<double, std::milli>(end - start).count() << " ms"
+				<< ", index buffer " << builder.indices.size() * sizeof(uint32_t) << " -> " << builder.indices.size() * indexSize << " bytes"
+				<< (equivalent ? "" : ", TRIANGLES CHANGED") << "\n";
+
+		} // for
+
+		return allEquivalent ? 0 : 1;
+
+	} // benchmarkMeshOptimizer
+
+	int benchmarkCompactVertices(const std::vector<std::string>& args) {
+		std::string directory = args.size() > 0 ? args[0] : "models";
+
+		std::vector<std::string> files;
+		for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".obj")
+				files.push_back(entry.path().string());
+
+		} // for
+
+		std::sort(files.begin(), files.end());
+
+		std::cout << "compact vertices: " << sizeof(LveModel::Vertex) << " -> " << sizeof(LveModel::CompactVertex) << " bytes per vertex\n";
+		std::cout << std::scientific << std::setprecision(2);
+
+		bool allWithinTolerance = true;
+		for (const auto& file : files) {
+			LveModel::Builder builder{};
+			builder.loadModel(file);
+
+			glm::vec3 boundsMin = builder.vertices[0].position;
+			glm::vec3 boundsMax = builder.vertices[0].position;
+			for (const auto& vertex : builder.vertices) {
+				boundsMin = glm::min(boundsMin, vertex.position);
+				boundsMax = glm::max(boundsMax, vertex.position);
+
+			} // for
+
+			glm::vec3 boundsExtent = boundsMax - boundsMin;
+			for (int axis = 0; axis < 3; axis++) {
+				if (boundsExtent[axis] <= 0.f)
+					boundsExtent[axis] = 1.f;
+
+			} // for
+
+			// worst case error of each attribute, position relative to the mesh extent, normal as an angle
+			float positionError = 0.f, normalError = 0.f, colorError = 0.f, uvError = 0.f;
+			bool withinTolerance = true;
+
+			for (const auto& vertex : builder.vertices) {
+				auto decoded = LveModel::CompactVertex::encode(vertex, boundsMin, boundsExtent).decode(boundsMin, boundsExtent);
+
+				for (int i = 0; i < 3; i++) {
+					float error = std::fabs(decoded.position[i] - vertex.position[i]) / boundsExtent[i];
+					positionError = std::max(positionError, error);
+					withinTolerance &= error <= 0.5f / 65535.f + 1e-6f;
+
+				} // for
+
+				// models without normals have nothing to compare against
+				float normalLength = glm::length(vertex.normal);
+				if (normalLength > 0.f) {
+					float cosine = glm::dot(decoded.normal, vertex.normal / normalLength);
+					float error = std::acos(std::min(cosine, 1.f));
+					normalError = std::max(normalError, error);
+					withinTolerance &= error <= 1e-3f; // ~0.06 degrees
+
+				} // if
+
+				for (int i = 0; i < 3; i++) {
+					float error = std::fabs(decoded.color[i] - std::min(std::max(vertex.color[i], 0.f), 1.f));
+					colorError = std::max(colorError, error);
+					withinTolerance &= error <= 0.5f / 255.f + 1e-6f;
+
+				} // for
+
+				for (int i = 0; i < 2; i++) {
+					float error = std::fabs(decoded.uv[i] - vertex.uv[i]);
+					uvError = std::max(uvError, error);
+					withinTolerance &= error <= std::fabs(vertex.uv[i]) / 2048.f + 1e-7f; // half has an 11 bit significand
+
+				} // for
+
+			} // for
+
+			allWithinTolerance &= withinTolerance;
+
+			std::cout << file << ": " << builder.vertices.size() * sizeof(LveModel::Vertex) << " -> "
+				<< builder.vertices.size() * sizeof(LveModel::CompactVertex) << " bytes, max error position " << positionError
+				<< " normal " << normalError << " rad color " << colorError << " uv " << uvError
+				<< (withinTolerance ? "" : ", OUT OF TOLERANCE") << "\n";
+
+		} // for
+
+		return allWithinTolerance ? 0 : 1;
+
+	} // benchmarkCompactVertices
+
+	int benchmarkMeshlets(const std::vector<std::string>& args) {
+		std::string directory = args.size() > 0 ? args[0] : "models";
+		int views = args.size() > 1 ? std::max(1, std::stoi(args[1])) : 64;
+
+		std::vector<std::string> files;
+		for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".obj")
+				files.push_back(entry.path().string());
+
+		} // for
+
+		std::sort(files.begin(), files.end());
+		std::cout << std::fixed << std::setprecision(1);
+
+		bool allValid = true;
+		for (const auto& file : files) {
+			LveModel::Builder builder{};
+			builder.loadModel(file);
+			builder.optimize();
+			builder.buildMeshlets();
+
+			// limits, and every triangle belongs to exactly one meshlet in order
+			bool valid = true;
+			uint32_t nextIndex = 0;
+			size_t totalVertices = 0;
+			for (const auto& meshlet : builder.meshlets) {
+				std::vector<uint32_t> unique(builder.indices.begin() + meshlet.firstIndex, builder.indices.begin() + meshlet.firstIndex + meshlet.indexCount);
+				std::sort(unique.begin(), unique.end());
+				unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+				valid &= meshlet.firstIndex == nextIndex;
+				valid &= unique.size() <= LveModel::MAX_MESHLET_VERTICES && meshlet.indexCount / 3 <= LveModel::MAX_MESHLET_TRIANGLES;
+				nextIndex = meshlet.firstIndex + meshlet.indexCount;
+				totalVertices += unique.size();
+
+			} // for
+
+			valid &= nextIndex == builder.indices.size();
+
+			// cameras on a sphere around the mesh: whatever the cone culls must be entirely back facing
+			glm::vec3 boundsMin = builder.vertices[0].position, boundsMax = builder.vertices[0].position;
+			for (const auto& vertex : builder.vertices) {
+				boundsMin = glm::min(boundsMin, vertex.position);
+				boundsMax = glm::max(boundsMax, vertex.position);
+
+			} // for
+
+			glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+			float radius = glm::length(boundsMax - boundsMin);
+
+			std::mt19937 random{ 1234 };
+			std::normal_distribution<float> gaussian{ 0.f, 1.f };
+			uint64_t tested = 0, culled = 0;
+
+			for (int view = 0; view < views; view++) {
+				glm::vec3 direction{ gaussian(random), gaussian(random), gaussian(random) };
+				glm::vec3 camera = center + glm::normalize(direction) * radius * 2.f;
+
+				for (const auto& meshlet : builder.meshlets) {
+					tested++;
+					glm::vec3 toCenter = meshlet.center - camera;
+					if (glm::dot(toCenter, meshlet.coneAxis) < meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius)
+						continue;
+
+					culled++;
+					for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i += 3) {
+						const auto& v0 = builder.vertices[builder.indices[i + 0]];
+						const auto& v1 = builder.vertices[builder.indices[i + 1]];
+						const auto& v2 = builder.vertices[builder.indices[i + 2]];
+
+						glm::vec3 normal = glm::cross(v1.position - v0.position, v2.position - v0.position);
+						if (glm::dot(normal, v0.normal + v1.normal + v2.normal) < 0.f)
+							normal = -normal;
+
+						valid &= glm::dot(normal, camera - v0.position) <= 1e-5f * glm::length(normal) * radius;
+
+					} // for
+
+				} // for
+
+			} // for
+
+			allValid &= valid;
+
+			size_t meshletCount = std::max<size_t>(builder.meshlets.size(), 1);
+			std::cout << file << ": " << builder.meshlets.size() << " meshlets, " << static_cast<float>(totalVertices) / meshletCount
+				<< " vertices and " << static_cast<float>(builder.indices.size() / 3) / meshletCount << " triangles on average, cone culled "
+				<< 100.f * culled / std::max<uint64_t>(tested, 1) << "% from " << views << " views" << (valid ? "" : ", INVALID") << "\n";
+
+		} // for
+
+		return allValid ? 0 : 1;
+
+	} // benchmarkMeshlets
+
+	int benchmarkLods(const std::vector<std::string>& args) {
+		std::string directory = args.size() > 0 ? args[0] : "models";
+		size_t samples = args.size() > 1 ? static_cast<size_t>(std::max(1, std::stoi(args[1]))) : 2000;
+
+		std::vector<std::string> files;
+		for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+			if (entry.is_regular_file() && entry.path().extension() == ".obj")
+				files.push_back(entry.path().string());
+
+		} // for
+
+		std::sort(files.begin(), files.end());
+		std::cout << std::fixed << std::setprecision(2);
+
+		bool allValid = true;
+		for (const auto& file : files) {
+			LveModel::Builder builder{};
+			builder.loadModel(file);
+			std::vector<LveModel::Vertex> fullVertices = builder.vertices;
+			std::vector<uint32_t> fullIndices = builder.indices;
+
+			double ms = timeBestOf(1, [&builder]() { builder.buildLods(); });
+
+			glm::vec3 boundsMin = fullVertices[0].position, boundsMax = fullVertices[0].position;
+			for (const auto& vertex : fullVertices) {
+				boundsMin = glm::min(boundsMin, vertex.position);
+				boundsMax = glm::max(boundsMax, vertex.position);
+
+			} // for
+
+			float radius = std::max(glm::length(boundsMax - boundsMin) * 0.5f, 1e-6f);
+
+			// levels are back to back and each has fewer triangles than the one before
+			bool valid = !builder.lods.empty() && builder.lods[0].firstIndex == 0 && builder.lods[0].indexCount == fullIndices.size();
+			for (size_t level = 1; level < builder.lods.size(); level++) {
+				const auto& previous = builder.lods[level - 1];
+				const auto& lod = builder.lods[level];
+				valid &= lod.firstIndex == previous.firstIndex + previous.indexCount && lod.indexCount < previous.indexCount && lod.indexCount % 3 == 0;
+
+			} // for
+
+			for (uint32_t index : builder.indices)
+				valid &= index < builder.vertices.size();
+
+			std::cout << file << ": " << ms << " ms, triangles";
+			for (const auto& lod : builder.lods)
+				std::cout << " " << lod.indexCount / 3;
+
+			// how far the full surface is from each level, measured at (a sample of) the full mesh's vertices,
+			// both the estimate the simplifier reports and the measured one relative to the bounding radius
+			std::cout << ", error estimated / measured";
+			size_t stride = std::max<size_t>(fullVertices.size() / samples, 1);
+			for (size_t level = 1; level < builder.lods.size(); level++) {
+				const auto& lod = builder.lods[level];
+				float measured = 0.f;
+
+				for (size_t v = 0; v < fullVertices.size(); v += stride) {
+					float closest = std::numeric_limits<float>::max();
+					for (uint32_t i = lod.firstIndex; i < lod.firstIndex + lod.indexCount; i += 3) {
+						closest = std::min(closest, pointTriangleDistance(fullVertices[v].position,
+							builder.vertices[builder.indices[i + 0]].position,
+							builder.vertices[builder.indices[i + 1]].position,
+							builder.vertices[builder.indices[i + 2]].position));
+
+					} // for
+
+					measured = std::max(measured, closest);
+
+				} // for
+
+				std::cout << " " << 100.f * lod.error / radius << "% / " << 100.f * measured / radius << "%";
+
+			} // for
+
+			allValid &= valid;
+			std::cout << (valid ? "" : ", INVALID") << "\n";
+
+		} // for
+
+		return allValid ? 0 : 1;
+
+	} // benchmarkLods
+
+	int benchmarkRangeAllocator(const std::vector<std::string>& args) {
+		int operations = args.size() > 0 ? std::max(1, std::stoi(args[0])) : 100000;
+		uint64_t alignment = args.size() > 1 ? std::max(1, std::stoi(args[1])) : 1;
+
+		// a geometry pool block worth of vertices, models between a quad and a few ten thousand vertices
+		constexpr uint64_t CAPACITY = 16 * 1024 * 1024 / sizeof(LveModel::Vertex);
+		LveRangeAllocator allocator{ CAPACITY };
+
+		std::mt19937 random{ 1234 };
+		std::uniform_real_distribution<float> logSize{ std::log(4.f), std::log(40000.f) };
+		std::uniform_real_distribution<float> chance{ 0.f, 1.f };
+
+		std::map<uint64_t, uint64_t> live; // offset -> size
+		std::vector<uint64_t> liveOffsets;
+		bool valid = true;
+		uint64_t failed = 0;
+		double fragmentationSum = 0.0;
+		float worstFragmentation = 0.f;
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		for (int operation = 0; operation < operations; operation++) {
+			// keep the block between half and completely full, that is where fragmentation hurts
+			float load = static_cast<float>(allocator.getUsed()) / CAPACITY;
+			bool allocate = liveOffsets.empty() || chance(random) < (load < 0.5f ? 0.9f : 0.5f);
+
+			if (allocate) {
+				uint64_t size = static_cast<uint64_t>(std::exp(logSize(random)));
+				uint64_t offset = allocator.allocate(size, alignment);
+				if (offset == LveRangeAllocator::NO_SPACE) {
+					failed++;
+					continue;
+
+				} // if
+
+				// the new range must be aligned and overlap neither neighbour
+				auto next = live.lower_bound(offset);
+				valid &= offset % alignment == 0 && offset + size <= CAPACITY;
+				valid &= next == live.end() || offset + size <= next->first;
+				valid &= next == live.begin() || std::prev(next)->first + std::prev(next)->second <= offset;
+
+				live[offset] = size;
+				liveOffsets.push_back(offset);
+
+			} // if
+			else {
+				size_t pick = std::uniform_int_distribution<size_t>{ 0, liveOffsets.size() - 1 }(random);
+				allocator.free(liveOffsets[pick]);
+				live.erase(liveOffsets[pick]);
+				liveOffsets[pick] = liveOffsets.back();
+				liveOffsets.pop_back();
+
+			} // else
+
+			float fragmentation = allocator.getStats().fragmentation();
+			fragmentationSum += fragmentation;
+			worstFragmentation = std::max(worstFragmentation, fragmentation);
+
+		} // for
+
+		auto end = std::chrono::high_resolution_clock::now();
+		LveRangeAllocator::Stats churned = allocator.getStats();
+
+		// everything freed has to melt back into a single range
+		for (uint64_t offset : liveOffsets)
+			allocator.free(offset);
+
+		LveRangeAllocator::Stats empty = allocator.getStats();
+		valid &= empty.used == 0 && empty.freeRangeCount == 1 && empty.largestFreeRange == CAPACITY;
+
+		double ms = std::chrono::duration<double, std::milli>(end - start).count();
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << operations << " operations in " << ms << " ms, " << failed << " allocations did not fit\n";
+		std::cout << "after churn: " << churned.allocationCount << " ranges, " << 100.0 * churned.used / CAPACITY << "% used, "
+			<< churned.freeRangeCount << " free ranges, fragmentation " << 100.f * churned.fragmentation() << "% (average "
+			<< 100.0 * fragmentationSum / operations << "%, worst " << 100.f * worstFragmentation << "%)\n";
+		std::cout << "after freeing everything: " << empty.freeRangeCount << " free range of " << empty.largestFreeRange
+			<< (valid ? "" : ", INVALID") << "\n";
+
+		return valid ? 0 : 1;
+
+	} // benchmarkRangeAllocator
+
+	int benchmarkDefragmenter(const std::vector<std::string>& args) {
+		int frames = args.size() > 0 ? std::max(1, std::stoi(args[0])) : 20000;
+		uint64_t budgetBytes = args.size() > 1 ? std::max(0, std::stoi(args[1])) * 1024ull : 2048 * 1024ull;
+
+		// the geometry pool's vertex arena and the bookkeeping it runs, 16 MiB blocks and moved ranges freed two frames later
+		constexpr uint64_t ELEMENT_SIZE = sizeof(LveModel::Vertex);
+		constexpr uint64_t BLOCK_BYTES = LveGeometryPool::DEFAULT_BLOCK_SIZE;
+		constexpr uint64_t CAPACITY = BLOCK_BYTES / ELEMENT_SIZE;
+		constexpr uint32_t FRAMES_IN_FLIGHT = 2;
+		constexpr int UPLOAD_FRAMES = 3;
+		constexpr int SETTLE_FRAMES = 2000;
+
+		struct Result {
+			uint64_t peakBlocks = 0;
+			uint64_t settledBlocks = 0;
+			uint64_t neededBlocks = 0;
+			uint64_t moves = 0;
+			uint64_t movedBytes = 0;
+			double ms = 0.0;
+			bool valid = true;
+
+		}; // Result
+
+		auto run = [&](uint64_t budget) {
+			Result result{};
+			std::mt19937 random{ 1234 };
+			std::uniform_real_distribution<float> logSize{ std::log(4.f), std::log(40000.f) };
+			std::uniform_real_distribution<float> chance{ 0.f, 1.f };
+
+			uint64_t blockCount = 0;
+			LveRangePool pool{
+				BLOCK_BYTES,
+				FRAMES_IN_FLIGHT,
+				[&](uint32_t, uint32_t, uint32_t) { result.peakBlocks = std::max(result.peakBlocks, ++blockCount); },
+				[&](uint32_t, uint32_t) { blockCount--; }
+
+			}; // pool
+
+			uint32_t arena = pool.findArena(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, static_cast<uint32_t>(ELEMENT_SIZE));
+
+			// stable addresses like the handles inside LveModel, the upload ticket holds the frame the range can move from
+			std::vector<std::unique_ptr<LveRangePool::Allocation>> live;
+			std::vector<LveRangePool::Allocation*> relocated; // in the order the pool patched them
+			std::map<std::pair<uint32_t, uint64_t>, uint64_t> occupied; // live ranges, to catch overlaps
+			uint64_t liveElements = 0;
+
+			auto occupy = [&](uint32_t block, uint64_t offset, uint64_t size) {
+				auto next = occupied.lower_bound({ block, offset });
+				result.valid &= next == occupied.end() || next->first.first != block || offset + size <= next->first.second;
+				if (next != occupied.begin()) {
+					auto previous = std::prev(next);
+					result.valid &= previous->first.first != block || previous->first.second + previous->second <= offset;
+
+				} // if
+
+				occupied[{ block, offset }] = size;
+
+			}; // occupy
+
+			auto release = [&](size_t index) {
+				LveRangePool::Allocation& allocation = *live[index];
+				occupied.erase({ allocation.block, allocation.offset });
+				liveElements -= allocation.count;
+				pool.free(allocation);
+				live[index] = std::move(live.back());
+				live.pop_back();
+
+			}; // release
+
+			auto start = std::chrono::high_resolution_clock::now();
+
+			for (int frame = 0; frame < frames + SETTLE_FRAMES; frame++) {
+				// the streamed set swings between one and six blocks worth of vertices, ends with three quarters of it
+				// unloaded at once, like leaving a level, and then stops changing
+				if (frame == frames) {
+					std::shuffle(live.begin(), live.end(), random);
+					while (live.size() > 0 && liveElements > CAPACITY * 3 / 2)
+						release(live.size() - 1);
+
+				} // if
+				else if (frame < frames) {
+					float phase = static_cast<float>(frame) / 2000.f;
+					uint64_t target = static_cast<uint64_t>(CAPACITY * (3.5f + 2.5f * std::sin(phase * 6.2831853f)));
+
+					for (int operation = 0; operation < 4; operation++) {
+						bool grow = live.empty() || chance(random) < (liveElements < target ? 0.8f : 0.2f);
+						if (grow) {
+							auto allocation = std::make_unique<LveRangePool::Allocation>();
+							LveRangePool::Allocation* handle = allocation.get();
+							*allocation = pool.allocate(arena, static_cast<uint32_t>(std::exp(logSize(random))));
+							allocation->uploadTicket = frame + UPLOAD_FRAMES;
+							pool.setOwner(*allocation, [&relocated, handle]() { relocated.push_back(handle); });
+							occupy(allocation->block, allocation->offset, allocation->count);
+							liveElements += allocation->count;
+							live.push_back(std::move(allocation));
+
+						} // if
+						else {
+							release(std::uniform_int_distribution<size_t>{ 0, live.size() - 1 }(random));
+
+						} // else
+
+					} // for
+
+				} // if
+
+				// what LveGeometryPool::defragment does, minus the copies
+				relocated.clear();
+				auto moves = pool.defragment(budget, [frame](const LveRangePool::Allocation& allocation) {
+					return allocation.uploadTicket <= static_cast<uint64_t>(frame);
+				});
+
+				uint64_t frameBytes = 0;
+				for (const auto& move : moves)
+					frameBytes += move.range.size * ELEMENT_SIZE;
+
+				// only a single range may go over the budget, and every move has patched its owner's handle
+				result.valid &= budget > 0 || moves.empty();
+				result.valid &= moves.size() <= 1 || frameBytes <= budget;
+				result.valid &= relocated.size() == moves.size();
+
+				for (size_t i = 0; i < moves.size() && i < relocated.size(); i++) {
+					const LveDefragmenter::Move& move = moves[i].range;
+					const LveRangePool::Allocation& handle = *relocated[i];
+					result.valid &= handle.block == move.dstBlock && handle.offset == move.dstOffset && handle.count == move.size && move.dstBlock != move.srcBlock;
+
+					occupied.erase({ move.srcBlock, move.srcOffset });
+					occupy(move.dstBlock, move.dstOffset, move.size);
+					result.moves++;
+					result.movedBytes += move.size * ELEMENT_SIZE;
+
+				} // for
+
+				result.settledBlocks = blockCount;
+
+			} // for
+
+			auto end = std::chrono::high_resolution_clock::now();
+			result.ms = std::chrono::duration<double, std::milli>(end - start).count();
+			result.neededBlocks = std::max<uint64_t>(1, (liveElements + CAPACITY - 1) / CAPACITY);
+
+			// every handle still points at a range its block knows about, and nothing else is left allocated
+			const auto& blocks = pool.getBlocks(arena);
+			uint64_t allocationCount = 0;
+			for (const auto& block : blocks)
+				allocationCount += block != nullptr ? block->getStats().allocationCount : 0;
+
+			for (const auto& allocation : live)
+				result.valid &= blocks[allocation->block] != nullptr && occupied.count({ allocation->block, allocation->offset }) == 1;
+
+			result.valid &= pool.getRetiringCount() == 0 && occupied.size() == live.size() && allocationCount == live.size();
+			result.valid &= pool.getDefragmentStats().moveCount == result.moves;
+			return result;
+
+		}; // run
+
+		Result off = run(0);
+		Result on = run(budgetBytes);
+
+		// holes can keep the last few ranges from fitting, one block over what the live ranges need is allowed
+		bool bounded = on.settledBlocks <= on.neededBlocks + 1;
+
+		std::cout << std::fixed << std::setprecision(2);
+		std::cout << frames << " frames of streaming, an unload and " << SETTLE_FRAMES << " quiet frames, " << budgetBytes / 1024
+			<< " KiB moved per frame at most\n";
+
+		for (const auto& [name, result] : { std::pair<const char*, const Result&>{ "without defragmenter", off }, { "with defragmenter", on } }) {
+			std::cout << name << ": peak " << result.peakBlocks << " blocks, " << result.settledBlocks << " blocks at the end for "
+				<< result.neededBlocks << " blocks of live ranges, " << result.moves << " moves ("
+				<< result.movedBytes / (1024.0 * 1024.0) << " MiB, " << result.movedBytes / 1024.0 / (frames + SETTLE_FRAMES)
+				<< " KiB per frame), " << result.ms << " ms" << (result.valid ? "" : ", INVALID") << "\n";
+
+		} // for
+
+		if (!bounded)
+			std::cout << "blocks did not shrink back to the live ranges\n";
+
+		return off.valid && on.valid && bounded ? 0 : 1;
+
+	} // benchmarkDefragmenter
+
+	int benchmarkFrustumCulling(const std::vector<std::string>& args) {
+		int iterations = args.size() > 0 ? std::max(1, std::stoi(args[0])) : 10;
+		std::vector<uint32_t> objectCounts;
+		for (size_t i = 1; i < args.size(); i++)
+			objectCounts.push_back(static_cast<uint32_t>(std::max(1, std::stoi(args[i]))));
+
+		if (objectCounts.empty())
+			objectCounts = { 10000, 100000, 1000000 };
+
+		// a 60 degree camera looking down +z into a world as deep as its far plane, about half of the objects end up in view
+		constexpr float WORLD_SIZE = 1000.f;
+		LveCamera camera{};
+		camera.setPerspectiveProjection(glm::radians(60.f), 16.f / 9.f, 0.1f, WORLD_SIZE);
+		camera.setViewDirection(glm::vec3{ 0.f }, glm::vec3{ 0.f, 0.f, 1.f });
+		LveFrustum frustum = camera.getFrustum();
+
+		// a handful of model shapes, from a flat panel to a long pole, so the box test has something to do
+		const std::vector<glm::vec3> shapes = { { 1.f, 1.f, 1.f }, { 4.f, 0.1f, 4.f }, { 0.2f, 6.f, 0.2f }, { 2.f, 1.f, 0.5f } };
+
+		const LveFrustumCuller::Path paths[] = { LveFrustumCuller::Path::Scalar, LveFrustumCuller::Path::Sse, LveFrustumCuller::Path::Avx };
+		const char* pathNames[] = { "scalar", "sse", "avx" };
+
+		bool identical = true;
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << "best of " << iterations << ", fastest path: " << pathNames[static_cast<int>(LveFrustumCuller::fastestPath())] << "\n";
+
+		for (uint32_t objectCount : objectCounts) {
+			std::mt19937 random{ 1234 };
+			std::uniform_real_distribution<float> position{ -WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f };
+			std::uniform_real_distribution<float> depth{ -WORLD_SIZE * 0.1f, WORLD_SIZE };
+			std::uniform_real_distribution<float> angle{ 0.f, glm::two_pi<float>() };
+			std::uniform_real_distribution<float> size{ 0.5f, 4.f };
+
+			std::vector<LveModel::Bounds> bounds(objectCount);
+			std::vector<glm::mat4> modelMatrices(objectCount);
+			for (uint32_t i = 0; i < objectCount; i++) {
+				const glm::vec3& extent = shapes[i % shapes.size()];
+				bounds[i].min = -extent;
+				bounds[i].max = extent;
+				bounds[i].radius = glm::length(extent);
+
+				// rotated about y and uniformly scaled, written out so nothing beyond the core of glm is needed
+				float s = size(random), a = angle(random), c = std::cos(a), n = std::sin(a);
+				glm::mat4& modelMatrix = modelMatrices[i];
+				modelMatrix = glm::mat4{ 1.f };
+				modelMatrix[0] = glm::vec4{ c * s, 0.f, -n * s, 0.f };
+				modelMatrix[1] = glm::vec4{ 0.f, s, 0.f, 0.f };
+				modelMatrix[2] = glm::vec4{ n * s, 0.f, c * s, 0.f };
+				modelMatrix[3] = glm::vec4{ position(random), position(random), depth(random), 1.f };
+
+			} // for
+
+			LveFrustumCuller culler{};
+			double fillMs = timeBestOf(iterations, [&]() {
+				culler.clear();
+				culler.reserve(objectCount);
+				for (uint32_t i = 0; i < objectCount; i++)
+					culler.add(bounds[i], modelMatrices[i]);
+
+			}); // timeBestOf
+
+			// the per object sphere test the render system used before, as the baseline
+			std::vector<uint32_t> sphereVisible;
+			double sphereMs = timeBestOf(iterations, [&]() {
+				sphereVisible.clear();
+				for (uint32_t i = 0; i < objectCount; i++) {
+					if (frustum.intersectsSphere(culler.getCenter(i), culler.getRadius(i)))
+						sphereVisible.push_back(i);
+
+				} // for
+
+			}); // timeBestOf
+
+			std::cout << objectCount << " objects, add " << fillMs << " ms, sphere loop " << sphereMs << " ms (" << sphereVisible.size() << " visible)";
+
+			std::vector<uint32_t> reference;
+			double scalarMs = 0.0;
+			for (int p = 0; p < 3; p++) {
+				if (!LveFrustumCuller::isSupported(paths[p]))
+					continue;
+
+				std::vector<uint32_t> visible;
+				double ms = timeBestOf(iterations, [&]() {
+					visible.clear();
+					culler.cull(frustum, visible, paths[p]);
+
+				}); // timeBestOf
+
+				if (paths[p] == LveFrustumCuller::Path::Scalar) {
+					reference = visible;
+					scalarMs = ms;
+
+				} // if
+
+				// every path has to agree with the scalar one, and the box never lets more through than the sphere
+				bool same = visible == reference && std::includes(sphereVisible.begin(), sphereVisible.end(), visible.begin(), visible.end());
+				identical &= same;
+
+				std::cout << ", " << pathNames[p] << " " << ms << " ms";
+				if (paths[p] != LveFrustumCuller::Path::Scalar)
+					std::cout << " (" << std::setprecision(1) << scalarMs / ms << "x)" << std::setprecision(3);
+
+				if (paths[p] == LveFrustumCuller::Path::Scalar)
+					std::cout << " (" << visible.size() << " visible)";
+
+				if (!same)
+					std::cout << " MISMATCH";
+
+			} // for
+
+			std::cout << "\n";
+
+		} // for
+
+		return identical ? 0 : 1;
+
+	} // benchmarkFrustumCulling
+
+	int benchmarkRenderQueue(const std::vector<std::string>& args) {
+		uint32_t packetCount = args.size() > 0 ? static_cast<uint32_t>(std::max(1, std::stoi(args[0]))) : 100000;
+		uint32_t modelCount = args.size() > 1 ? static_cast<uint32_t>(std::max(1, std::stoi(args[1]))) : 256;
+		int iterations = args.size() > 2 ? std::max(1, std::stoi(args[2])) : 10;
+
+		// a scene like SimpleRenderSystem sees it, two pipelines and a few pool blocks shared by the models
+		constexpr uint32_t PIPELINES = 2;
+		constexpr uint32_t BINDINGS = 4;
+		std::mt19937 random{ 1234 };
+		std::uniform_int_distribution<uint32_t> pickModel{ 0, modelCount - 1 };
+		std::uniform_int_distribution<uint32_t> pickLod{ 0, LveModel::MAX_LODS - 1 };
+		std::uniform_int_distribution<uint32_t> pickDepth{ 0, (1u << LveRenderQueue::DEPTH_BITS) - 1 };
+
+		std::vector<LveRenderQueue::Packet> unsorted(packetCount);
+		for (uint32_t i = 0; i < packetCount; i++) {
+			uint32_t model = pickModel(random);
+			unsorted[i] = LveRenderQueue::Packet{ LveRenderQueue::opaqueKey(model % PIPELINES, model % BINDINGS, model, pickLod(random), pickDepth(random)), i };
+
+		} // for
+
+		LveRenderQueue queue{};
+		double radixMs = timeBestOf(iterations, [&]() {
+			queue.clear();
+			for (const auto& packet : unsorted)
+				queue.push(packet.key, packet.item);
+
+			queue.sort();
+
+		}); // timeBestOf
+
+		std::vector<LveRenderQueue::Packet> compared;
+		double stdSortMs = timeBestOf(iterations, [&]() {
+			compared = unsorted;
+			std::sort(compared.begin(), compared.end(), [](const auto& a, const auto& b) { return a.key < b.key; });
+
+		}); // timeBestOf
+
+		// the radix sort is stable, so equal keys also have to keep the order they were pushed in
+		bool sorted = queue.getPackets().size() == packetCount;
+		for (uint32_t i = 1; sorted && i < packetCount; i++) {
+			const auto& a = queue.getPackets()[i - 1];
+			const auto& b = queue.getPackets()[i];
+			sorted = a.key < b.key || (a.key == b.key && a.item < b.item);
+
+		} // for
+
+		for (uint32_t i = 0; sorted && i < packetCount; i++)
+			sorted = queue.getPackets()[i].key == compared[i].key;
+
+		// binds a draw per packet needs when the state changes from the packet before
+		auto countBinds = [](const std::vector<LveRenderQueue::Packet>& packets, int shift, uint32_t bits) {
+			uint64_t binds = 0;
+			for (size_t i = 0; i < packets.size(); i++) {
+				uint64_t state = (packets[i].key >> shift) & ((uint64_t{ 1 } << bits) - 1);
+				binds += i == 0 || state != ((packets[i - 1].key >> shift) & ((uint64_t{ 1 } << bits) - 1));
+
+			} // for
+
+			return binds;
+
+		}; // countBinds
+
+		constexpr int BINDING_SHIFT = LveRenderQueue::MODEL_BITS + LveRenderQueue::LOD_BITS + LveRenderQueue::DEPTH_BITS;
+		constexpr int PIPELINE_SHIFT = BINDING_SHIFT + LveRenderQueue::BINDING_BITS;
+
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << packetCount << " packets over " << modelCount << " models, best of " << iterations << "\n";
+		std::cout << "radix sort " << radixMs << " ms, std::sort " << stdSortMs << " ms (" << std::setprecision(1) << stdSortMs / radixMs << "x)"
+			<< (sorted ? "" : ", NOT SORTED") << "\n";
+		std::cout << "pipeline binds: " << countBinds(unsorted, PIPELINE_SHIFT, LveRenderQueue::PIPELINE_BITS) << " unsorted, "
+			<< countBinds(queue.getPackets(), PIPELINE_SHIFT, LveRenderQueue::PIPELINE_BITS) << " sorted\n";
+		std::cout << "geometry binds: " << countBinds(unsorted, BINDING_SHIFT, LveRenderQueue::PIPELINE_BITS + LveRenderQueue::BINDING_BITS) << " unsorted, "
+			<< countBinds(queue.getPackets(), BINDING_SHIFT, LveRenderQueue::PIPELINE_BITS + LveRenderQueue::BINDING_BITS) << " sorted\n";
+
+		return sorted ? 0 : 1;
+
+	} // benchmarkRenderQueue
+
+	int benchmarkTransforms(const std::vector<std::string>& args) {
+		uint32_t objectCount = args.size() > 0 ? static_cast<uint32_t>(std::max(1, std::stoi(args[0]))) : 100000;
+		int dynamicPercent = args.size() > 1 ? std::clamp(std::stoi(args[1]), 0, 100) : 10;
+		int iterations = args.size() > 2 ? std::max(1, std::stoi(args[2])) : 10;
+		uint32_t dynamicCount = static_cast<uint32_t>(static_cast<uint64_t>(objectCount) * dynamicPercent / 100);
+
+		std::mt19937 random{ 1234 };
+		std::uniform_real_distribution<float> position{ -500.f, 500.f };
+		std::uniform_real_distribution<float> angle{ -glm::two_pi<float>(), glm::two_pi<float>() };
+		std::uniform_real_distribution<float> size{ 0.5f, 4.f };
+
+		std::vector<TransformComponent> transforms(objectCount);
+		std::vector<glm::vec3> rotations(objectCount);
+		for (uint32_t i = 0; i < objectCount; i++) {
+			rotations[i] = { angle(random), angle(random), angle(random) };
+			transforms[i].setTranslation({ position(random), position(random), position(random) });
+			transforms[i].setScale({ size(random), size(random), size(random) });
+			transforms[i].setRotation(rotations[i]);
+
+		} // for
+
+		// every run first marks the transforms it rebuilds dirty again, which costs all of them the same
+		auto touch = [&](uint32_t count) {
+			for (uint32_t i = 0; i < count; i++)
+				transforms[i].setRotation(rotations[i]);
+
+		}; // touch
+
+		// every object rebuilt on its own each frame, what the render system did before the cache
+		double singleMs = timeBestOf(iterations, [&]() {
+			touch(objectCount);
+			for (TransformComponent& transform : transforms)
+				transform.mat4();
+
+		}); // timeBestOf
+
+		LveTransformBatch batch{};
+		auto batchedMs = [&](uint32_t count, LveTransformBatch::Path path) {
+			return timeBestOf(iterations, [&]() {
+				touch(count);
+				batch.clear();
+				for (TransformComponent& transform : transforms)
+					batch.add(transform);
+
+				batch.update(path);
+
+			}); // timeBestOf
+
+		}; // batchedMs
+
+		double scalarMs = batchedMs(objectCount, LveTransformBatch::Path::Scalar);
+		std::vector<glm::mat4> reference;
+		std::vector<glm::mat3> referenceNormals;
+		for (TransformComponent& transform : transforms) {
+			reference.push_back(transform.mat4());
+			referenceNormals.push_back(transform.normalMatrix());
+
+		} // for
+
+		LveTransformBatch::Path fastest = LveTransformBatch::fastestPath();
+		double fastestMs = batchedMs(objectCount, fastest);
+
+		// the polynomial against std::sin and std::cos, through every element of both matrices
+		float difference = 0.f;
+		for (uint32_t i = 0; i < objectCount; i++) {
+			for (int column = 0; column < 3; column++) {
+				for (int row = 0; row < 3; row++) {
+					difference = std::max(difference, std::abs(transforms[i].mat4()[column][row] - reference[i][column][row]));
+					difference = std::max(difference, std::abs(transforms[i].normalMatrix()[column][row] - referenceNormals[i][column][row]));
+
+				} // for
+
+			} // for
+
+		} // for
+
+		double dynamicMs = batchedMs(dynamicCount, fastest);
+
+		const char* pathNames[] = { "scalar", "sse" };
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << objectCount << " transforms, best of " << iterations << "\n";
+		std::cout << "all dirty: one at a time " << singleMs << " ms, batched scalar " << scalarMs << " ms, batched "
+			<< pathNames[static_cast<int>(fastest)] << " " << fastestMs << " ms (" << std::setprecision(1) << singleMs / fastestMs << "x)\n";
+		std::cout << std::setprecision(3) << dynamicPercent << "% dirty: batched " << pathNames[static_cast<int>(fastest)] << " " << dynamicMs
+			<< " ms (" << std::setprecision(1) << singleMs / dynamicMs << "x less than rebuilding all)\n";
+		std::cout << std::scientific << std::setprecision(2) << "largest difference to std::sin / std::cos: " << difference << "\n" << std::defaultfloat;
+
+		return difference < 1e-5f ? 0 : 1;
+
+	} // benchmarkTransforms
+
+	int benchmarkGpuCulling(const std::vector<std::string>& args) {
+		uint32_t objectCount = args.size() > 0 ? static_cast<uint32_t>(std::max(1, std::stoi(args[0]))) : 10000;
+		uint32_t batchCount = args.size() > 1 ? static_cast<uint32_t>(std::clamp(std::stoi(args[1]), 1, static_cast<int>(objectCount))) : std::min(8u, objectCount);
+		int iterations = args.size() > 2 ? std::max(1, std::stoi(args[2])) : 10;
+
+		// only the compute pass runs, so nothing beyond what LveGpuCulling's constructor needs has to be supported
+		LveDevice device{};
+
+		// an off axis camera, so none of the planes line up with the world axes
+		constexpr float WORLD_SIZE = 1000.f;
+		LveCamera camera{};
+		camera.setPerspectiveProjection(glm::radians(60.f), 16.f / 9.f, 0.1f, WORLD_SIZE);
+		camera.setViewDirection(glm::vec3{ 10.f, -5.f, -20.f }, glm::vec3{ 0.2f, 0.1f, 1.f });
+		const glm::mat4& projection = camera.getProjection();
+		LveFrustum frustum = LveFrustum::fromMatrix(projection * camera.getView());
+		const std::array<float, LveModel::MAX_LODS - 1> lodScreenSizes = { 0.5f, 0.25f, 0.125f };
+
+		// the objects share this many models, so the CPU path has instances to group
+		constexpr uint32_t MODEL_COUNT = 16;
+
+		// depth along the view direction the way SimpleRenderSystem keys its render queue
+		glm::vec3 cameraPosition = camera.getPosition();
+		glm::vec3 viewDirection = glm::vec3(camera.getInverseView()[2]);
+		const glm::vec4& farPlane = frustum.getPlanes()[5];
+		float farDepth = glm::dot(glm::vec3(farPlane), cameraPosition) + farPlane.w;
+
+		std::mt19937 random{ 1234 };
+		std::uniform_real_distribution<float> position{ -WORLD_SIZE * 0.5f, WORLD_SIZE * 0.5f };
+		std::uniform_real_distribution<float> depth{ -WORLD_SIZE * 0.1f, WORLD_SIZE };
+		std::uniform_real_distribution<float> angle{ 0.f, glm::two_pi<float>() };
+		std::uniform_real_distribution<float> size{ 0.5f, 40.f };
+		std::uniform_real_distribution<float> offset{ -1.f, 1.f };
+
+		// the level of detail cull.comp picks, NO_LOD when the sphere is outside
+		constexpr uint32_t NO_LOD = UINT32_MAX;
+		auto expectedLod = [&](const glm::vec3& center, float radius, uint32_t lodCount, bool& ambiguous) {
+			ambiguous = false;
+			bool outside = false;
+			for (int p = 0; p < 6; p++) {
+				const glm::vec4& plane = frustum.getPlanes()[p];
+				float distance = glm::dot(glm::vec3(plane), center) + plane.w + radius;
+				ambiguous |= std::abs(distance) < 1e-2f;
+				outside |= distance < 0.f;
+
+			} // for
+
+			if (outside)
+				return NO_LOD;
+
+			float cameraDistance = glm::length(center - camera.getPosition());
+			float screenSize = cameraDistance > radius ? radius * projection[1][1] / cameraDistance : std::numeric_limits<float>::max();
+			for (float lodScreenSize : lodScreenSizes)
+				ambiguous |= std::abs(screenSize - lodScreenSize) < 1e-4f * lodScreenSize;
+
+			uint32_t lod = 0;
+			while (lod + 1 < lodCount && screenSize < lodScreenSizes[lod])
+				lod++;
+
+			return lod;
+
+		}; // expectedLod
+
+		// spheres that touch a plane or sit on a lod threshold within float noise are rolled again, so the GPU and the CPU
+		// have to agree exactly on everything that is left, the batches take consecutive runs of objects
+		std::vector<LveGpuCulling::Object> objects(objectCount);
+		std::vector<LveModel::Instance> instances(objectCount);
+		std::vector<uint32_t> expectedLods(objectCount);
+		std::vector<uint32_t> depths(objectCount); // quantized
+		std::vector<uint32_t> batchFirstObjects;
+		LveFrustumCuller culler{};
+		culler.reserve(objectCount);
+
+		for (uint32_t i = 0; i < objectCount; i++) {
+			uint32_t batch = static_cast<uint32_t>(static_cast<uint64_t>(i) * batchCount / objectCount);
+			if (batchFirstObjects.size() == batch)
+				batchFirstObjects.push_back(i);
+
+			uint32_t model = i % MODEL_COUNT;
+			LveGpuCulling::Object& object = objects[i];
+			object.batch = batch;
+			object.vertexOffset = static_cast<int32_t>(model * 1000);
+			object.lodCount = 1 + model % LveModel::MAX_LODS;
+			for (uint32_t lod = 0; lod < object.lodCount; lod++) {
+				object.lodFirstIndex[lod] = model * LveModel::MAX_LODS + lod;
+				object.lodIndexCount[lod] = 3 * (LveModel::MAX_LODS - lod);
+
+			} // for
+
+			// a cube as tight around the sphere as it gets, so the culler's box test never rejects what the sphere keeps
+			LveModel::Bounds bounds{};
+			glm::mat4 modelMatrix{ 1.f };
+			bool ambiguous = true;
+			while (ambiguous) {
+				bounds.center = { offset(random), offset(random), offset(random) };
+				bounds.radius = 1.f + std::abs(offset(random));
+				bounds.min = bounds.center - bounds.radius;
+				bounds.max = bounds.center + bounds.radius;
+
+				float s = size(random), a = angle(random), c = std::cos(a), n = std::sin(a);
+				modelMatrix[0] = glm::vec4{ c * s, 0.f, -n * s, 0.f };
+				modelMatrix[1] = glm::vec4{ 0.f, s, 0.f, 0.f };
+				modelMatrix[2] = glm::vec4{ n * s, 0.f, c * s, 0.f };
+				modelMatrix[3] = glm::vec4{ position(random), position(random), depth(random), 1.f };
+
+				glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(bounds.center, 1.f));
+				expectedLods[i] = expectedLod(center, bounds.radius * s, object.lodCount, ambiguous);
+
+			} // while
+
+			object.boundingSphere = glm::vec4(bounds.center, bounds.radius);
+			depths[i] = LveRenderQueue::quantizeDepth(glm::dot(glm::vec3(modelMatrix[3]) - cameraPosition, viewDirection), farDepth);
+			instances[i] = LveModel::Instance::make(modelMatrix, glm::mat3(modelMatrix));
+			culler.add(bounds, modelMatrix);
+
+		} // for
+
+		std::vector<uint32_t> scalarVisible;
+		double scalarMs = timeBestOf(iterations, [&]() {
+			scalarVisible.clear();
+			culler.cull(frustum, scalarVisible, LveFrustumCuller::Path::Scalar);
+
+		}); // timeBestOf
+
+		LveDynamicBuffer instanceBuffer{ device, sizeof(LveModel::Instance), objectCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+		std::memcpy(instanceBuffer.getMappedMemory(), instances.data(), objectCount * sizeof(LveModel::Instance));
+		instanceBuffer.buffer().flush(objectCount * sizeof(LveModel::Instance), 0);
+
+		LveGpuCulling culling{ device, { &instanceBuffer }, lodScreenSizes };
+
+		// recorded, submitted and waited for, so this is the whole round trip rather than the time on the GPU
+		double gpuMs = timeBestOf(iterations, [&]() {
+			VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+			culling.cull(commandBuffer, 0, camera, objects, batchFirstObjects);
+			device.endSingleTimeCommands(commandBuffer);
+
+		}); // timeBestOf
+
+		std::vector<uint32_t> drawCounts;
+		std::vector<VkDrawIndexedIndirectCommand> commands;
+		culling.readBack(0, drawCounts, commands);
+
+		// the scalar path against the spheres the objects were rolled with, then the GPU against both, a batch's
+		// commands come in whatever order the atomics handed out the slots
+		uint32_t mismatches = 0;
+		uint32_t expectedVisible = 0;
+		for (uint32_t i = 0; i < objectCount; i++)
+			expectedVisible += expectedLods[i] != NO_LOD;
+
+		if (scalarVisible.size() != expectedVisible)
+			mismatches++;
+
+		for (uint32_t i : scalarVisible) {
+			if (expectedLods[i] == NO_LOD)
+				mismatches++;
+
+		} // for
+
+		uint32_t gpuVisible = 0;
+		for (uint32_t batch = 0; batch < batchCount; batch++) {
+			uint32_t first = batchFirstObjects[batch];
+			uint32_t end = batch + 1 < batchCount ? batchFirstObjects[batch + 1] : objectCount;
+
+			std::vector<uint32_t> expected;
+			for (uint32_t i = first; i < end; i++) {
+				if (expectedLods[i] != NO_LOD)
+					expected.push_back(i);
+
+			} // for
+
+			gpuVisible += drawCounts[batch];
+			if (drawCounts[batch] != expected.size()) {
+				mismatches++;
+				continue;
+
+			} // if
+
+			std::vector<VkDrawIndexedIndirectCommand> batchCommands(commands.begin() + first, commands.begin() + first + drawCounts[batch]);
+			std::sort(batchCommands.begin(), batchCommands.end(), [](const auto& a, const auto& b) { return a.firstInstance < b.firstInstance; });
+
+			for (size_t k = 0; k < expected.size(); k++) {
+				const VkDrawIndexedIndirectCommand& command = batchCommands[k];
+				const LveGpuCulling::Object& object = objects[expected[k]];
+				uint32_t lod = expectedLods[expected[k]];
+				if (command.firstInstance != expected[k] || command.instanceCount != 1 || command.vertexOffset != object.vertexOffset ||
+					command.firstIndex != object.lodFirstIndex[lod] || command.indexCount != object.lodIndexCount[lod])
+					mismatches++;
+
+			} // for
+
+		} // for
+
+		// what the CPU path draws for the same objects: its render queue sorts a batch by model and level, front to back
+		// within those, and every run of one model and level is one instanced draw, the pass draws every object on its
+		// own in the order its atomics handed out the slots
+		LveRenderQueue queue{};
+		for (uint32_t i = 0; i < objectCount; i++) {
+			if (expectedLods[i] != NO_LOD)
+				queue.push(LveRenderQueue::opaqueKey(0, objects[i].batch, i % MODEL_COUNT, expectedLods[i], depths[i]), i);
+
+		} // for
+
+		queue.sort();
+
+		std::vector<uint32_t> cpuOrder;
+		uint32_t cpuDraws = 0;
+		for (const LveRenderQueue::Packet& packet : queue.getPackets()) {
+			uint32_t i = packet.item;
+			uint32_t previous = cpuOrder.empty() ? NO_LOD : cpuOrder.back();
+			if (previous == NO_LOD || objects[previous].batch != objects[i].batch || previous % MODEL_COUNT != i % MODEL_COUNT || expectedLods[previous] != expectedLods[i])
+				cpuDraws++;
+
+			cpuOrder.push_back(i);
+
+		} // for
+
+		std::vector<uint32_t> gpuOrder;
+		for (uint32_t batch = 0; batch < batchCount; batch++) {
+			for (uint32_t c = 0; c < drawCounts[batch]; c++) {
+				uint32_t i = commands[batchFirstObjects[batch] + c].firstInstance;
+				if (i < objectCount && expectedLods[i] != NO_LOD)
+					gpuOrder.push_back(i);
+
+			} // for
+
+		} // for
+
+		// of the draws that follow another of the same model and level, the share that is not closer to the camera
+		auto frontToBackPercent = [&](const std::vector<uint32_t>& order) {
+			std::vector<uint32_t> lastDepths(static_cast<size_t>(batchCount) * MODEL_COUNT * LveModel::MAX_LODS, NO_LOD);
+			uint32_t pairs = 0, ordered = 0;
+			for (uint32_t i : order) {
+				uint32_t& lastDepth = lastDepths[(static_cast<size_t>(objects[i].batch) * MODEL_COUNT + i % MODEL_COUNT) * LveModel::MAX_LODS + expectedLods[i]];
+				if (lastDepth != NO_LOD) {
+					pairs++;
+					ordered += depths[i] >= lastDepth;
+
+				} // if
+
+				lastDepth = depths[i];
+
+			} // for
+
+			return pairs > 0 ? 100.0 * ordered / pairs : 100.0;
+
+		}; // frontToBackPercent
+
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << objectCount << " objects in " << batchCount << " batches on " << device.properties.deviceName << ", best of " << iterations << "\n";
+		std::cout << "scalar culler " << scalarMs << " ms (" << scalarVisible.size() << " visible), gpu cull submitted and waited for "
+			<< gpuMs << " ms (" << gpuVisible << " visible)\n";
+		std::cout << std::setprecision(1) << "draws: cpu path " << cpuDraws << " instanced, " << frontToBackPercent(cpuOrder)
+			<< "% front to back within a model and level, gpu cull " << gpuVisible << " with one instance each, " << frontToBackPercent(gpuOrder)
+			<< "% front to back\n";
+		if (mismatches > 0)
+			std::cout << "MISMATCH, " << mismatches << " counts or commands differ\n";
+
+		return mismatches == 0 ? 0 : 1;
+
+	} // benchmarkGpuCulling
+
+	int benchmarkParallelRecording(const std::vector<std::string>& args) {
+		uint32_t taskCount = args.size() > 0 ? static_cast<uint32_t>(std::max(1, std::stoi(args[0]))) : 256;
+		uint32_t itemsPerTask = args.size() > 1 ? static_cast<uint32_t>(std::max(1, std::stoi(args[1]))) : 256;
+		uint32_t maxThreads = args.size() > 2 ? static_cast<uint32_t>(std::max(1, std::stoi(args[2]))) : std::max(1u, std::thread::hardware_concurrency());
+		int iterations = args.size() > 3 ? std::max(1, std::stoi(args[3])) : 10;
+
+		LveDevice device{};
+		if (taskCount > device.properties.limits.maxFramebufferWidth)
+			throw std::runtime_error("more tasks than pixels in a framebuffer row!");
+
+		OffscreenTarget target{ device, taskCount };
+
+		// what recording a draw costs without a pipeline to draw with: a vertex buffer bind and a push constant per item
+		LveBuffer vertexBuffer{ device, sizeof(glm::vec4), 1, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+
+		VkPushConstantRange pushConstantRange{ VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::uvec4) };
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		VkPipelineLayout pipelineLayout;
+		if (vkCreatePipelineLayout(device.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+			throw std::runtime_error("failed to create pipeline layout!");
+
+		// task t ends by clearing the pixels from t on to t + 1, so pixel p holds whichever of tasks 0..p ran last,
+		// which is p + 1 only when no task before p ran after it and none of them went missing
+		auto recordTask = [&](VkCommandBuffer commandBuffer, uint32_t task) {
+			VkBuffer buffers[] = { vertexBuffer.getBuffer() };
+			VkDeviceSize offsets[] = { 0 };
+			for (uint32_t i = 0; i < itemsPerTask; i++) {
+				glm::uvec4 push{ task, i, 0u, 0u };
+				vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+				vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push), &push);
+
+			} // for
+
+			VkClearAttachment clear{};
+			clear.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			clear.colorAttachment = 0;
+			clear.clearValue.color.uint32[0] = task + 1;
+
+			VkClearRect rect{};
+			rect.rect = { { static_cast<int32_t>(task), 0 }, { taskCount - task, 1 } };
+			rect.layerCount = 1;
+			vkCmdClearAttachments(commandBuffer, 1, &clear, 1, &rect);
+
+		}; // recordTask
+
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool = device.getCommandPool();
+		allocInfo.commandBufferCount = 1;
+
+		VkCommandBuffer primary;
+		if (vkAllocateCommandBuffers(device.device(), &allocInfo, &primary) != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate command buffer!");
+
+		std::vector<uint32_t> threadCounts;
+		for (uint32_t threads = 1; threads < maxThreads; threads *= 2)
+			threadCounts.push_back(threads);
+
+		threadCounts.push_back(maxThreads);
+
+		bool ordered = true;
+		double singleMs = 0.0;
+		std::cout << std::fixed << std::setprecision(3);
+		std::cout << taskCount << " tasks of " << itemsPerTask << " items on " << device.properties.deviceName << ", best of " << iterations << "\n";
+
+		for (uint32_t threadCount : threadCounts) {
+			LveParallelRecorder recorder{ device, 1, threadCount };
+
+			// only the CPU side is timed, the frame is the primary around the render pass the tasks are recorded into
+			double ms = timeBestOf(iterations, [&]() {
+				VkCommandBufferBeginInfo beginInfo{};
+				beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+				if (vkBeginCommandBuffer(primary, &beginInfo) != VK_SUCCESS)
+					throw std::runtime_error("failed to begin recording command buffer!");
+
+				target.beginRenderPass(primary, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+				recorder.beginRenderPass(0, target.getRenderPass(), target.getFramebuffer(), target.getExtent());
+				recorder.record(primary, taskCount, recordTask);
+				vkCmdEndRenderPass(primary);
+				target.copyToReadback(primary);
+
+				if (vkEndCommandBuffer(primary) != VK_SUCCESS)
+					throw std::runtime_error("failed to record command buffer!");
+
+			}); // timeBestOf
+
+			// the last recording is the one submitted, its secondaries are still intact until the next beginRenderPass
+			submitAndWait(device, primary);
+			std::vector<uint32_t> pixels = target.read();
+
+			uint32_t misplaced = 0;
+			for (uint32_t p = 0; p < taskCount; p++) {
+				if (pixels[p] != p + 1)
+					misplaced++;
+
+			} // for
+
+			ordered &= misplaced == 0;
+			if (threadCount == 1)
+				singleMs = ms;
+
+			std::cout << threadCount << (threadCount == 1 ? " thread " : " threads ") << ms << " ms (" << std::setprecision(1) << singleMs / ms << "x)" << std::setprecision(3);
+			if (misplaced > 0)
+				std::cout << " OUT OF ORDER, " << misplaced << " pixels wrong";
+
+			std::cout << "\n";
+
+		} // for
+
+		vkFreeCommandBuffers(device.device(), device.getCommandPool(), 1, &primary);
+		vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+
+		return ordered ? 0 : 1;
+
+	} // benchmarkParallelRecording
+
+} // lve
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+// std
+#include <string>
+#include <vector>
+
+namespace lve {
+
+	// offline benchmarks, none of them need a window, the ones that check GPU results create a headless LveDevice
+	// run with: OpeningAWindow.exe --benchmark <name> [args...], no name lists what is available
+	int runBenchmarks(const std::vector<std::string>& args);
+
+	// times tinyobj against LveObjParser on every .obj in the directory and checks the outputs are identical
+	int benchmarkObjLoaders(const std::vector<std::string>& args);
+
+	// times every VertexWeldMode on one already parsed .obj and checks them against the hash map path
+	int benchmarkVertexWeld(const std::vector<std::string>& args);
+
+	// ACMR before and after every LveMeshOptimizer step for each .obj in the directory
+	int benchmarkMeshOptimizer(const std::vector<std::string>& args);
+
+	// encodes every model in the directory as LveModel::CompactVertex and checks the decoded error against tolerances
+	int benchmarkCompactVertices(const std::vector<std::string>& args);
+
+	// builds meshlets for every model in the directory, checks the limits and that cone culling never drops a front face
+	int benchmarkMeshlets(const std::vector<std::string>& args);
+
+	// builds the LOD chain of every model in the directory, checks the index ranges and measures how far each level drifts
+	int benchmarkLods(const std::vector<std::string>& args);
+
+	// churns random mesh sized ranges through LveRangeAllocator, checks they never overlap and reports fragmentation
+	int benchmarkRangeAllocator(const std::vector<std::string>& args);
+
+	// streams mesh sized ranges in and out of an LveRangePool, the geometry pool's bookkeeping, with and without
+	// defragmenting, checks moved ranges never overlap, their handles get patched and the blocks shrink back to what
+	// the live ranges need once the churn stops
+	int benchmarkDefragmenter(const std::vector<std::string>& args);
+
+	// culls 10k, 100k and 1M random objects with every LveFrustumCuller path, checks the paths agree with each other
+	// and with the sphere test they refine, and compares them to testing one sphere at a time
+	int benchmarkFrustumCulling(const std::vector<std::string>& args);
+
+	// sorts random opaque keys with LveRenderQueue's radix sort and std::sort, checks the orders agree and counts the
+	// pipeline and geometry binds the sorted order saves over the unsorted one
+	int benchmarkRenderQueue(const std::vector<std::string>& args);
+
+	// rebuilds the matrices of random transforms one at a time and with every LveTransformBatch path, checks the SSE
+	// sine and cosine against the standard ones and times a frame where only some of the transforms changed
+	int benchmarkTransforms(const std::vector<std::string>& args);
+
+	// culls random spheres against a fixed camera with LveGpuCulling on a headless device, reads back the draw counts
+	// and commands and checks them against LveFrustumCuller's scalar path and the level of detail cull.comp should pick
+	int benchmarkGpuCulling(const std::vector<std::string>& args);
+
+	// records the same render pass with LveParallelRecorder on 1 to maxThreads threads of a headless device, reads the
+	// image back to check the tasks were executed in task order and times the recording for every thread count
+	int benchmarkParallelRecording(const std::vector<std::string>& args);
+
+} // lve
@@ -8,6 +8,7 @@
 #include "lve_buffer.hpp"
 
  // std
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -49,7 +50,7 @@ namespace lve {
     LveBuffer::~LveBuffer() {
         unmap();
         vkDestroyBuffer(lveDevice.device(), buffer, nullptr);
-        vkFreeMemory(lveDevice.device(), memory, nullptr);
+        lveDevice.memoryAllocator().free(memory);
     }
 
     /**
@@ -59,30 +60,38 @@ namespace lve {
      * buffer range.
      * @param offset (Optional) Byte offset from beginning
      *
+     * @note The memory may be shared with other buffers, so the allocator keeps host visible memory
+     * persistently mapped and this only hands out a pointer into it, the range has to lie inside the buffer
+     *
      * @return VkResult of the buffer mapping call
      */
     VkResult LveBuffer::map(VkDeviceSize size, VkDeviceSize offset) {
-        assert(buffer && memory && "Called map on buffer before create");
-        return vkMapMemory(lveDevice.device(), memory, offset, size, 0, &mapped);
+        assert(buffer && memory.memory && "Called map on buffer before create");
+        assert(offset <= bufferSize && (size == VK_WHOLE_SIZE || size <= bufferSize - offset) && "Mapped range is outside the buffer");
+        if (memory.mapped == nullptr) {
+            return VK_ERROR_MEMORY_MAP_FAILED;
+        }
+        mapped = static_cast<char*>(memory.mapped) + offset;
+        mappedOffset = offset;
+        mappedSize = size == VK_WHOLE_SIZE ? bufferSize - offset : size;
+        return VK_SUCCESS;
     }
 
     /**
      * Unmap a mapped memory range
      *
-     * @note Does not return a result as vkUnmapMemory can't fail
+     * @note The memory itself stays mapped until the allocator releases it
      */
     void LveBuffer::unmap() {
-        if (mapped) {
-            vkUnmapMemory(lveDevice.device(), memory);
-            mapped = nullptr;
-        }
+        mapped = nullptr;
+        mappedSize = 0;
     }
 
     /**
      * Copies the specified data to the mapped buffer. Default value writes whole buffer range
      *
      * @param data Pointer to the data to copy
-     * @param size (Optional) Size of the data to copy. Pass VK_WHOLE_SIZE to flush the complete buffer
+     * @param size (Optional) Size of the data to copy. Pass VK_WHOLE_SIZE to write the complete mapped
      * range.
      * @param offset (Optional) Byte offset from beginning of mapped region
      *
@@ -91,13 +100,31 @@ namespace lve {
         assert(mapped && "Cannot copy to unmapped buffer");
 
         if (size == VK_WHOLE_SIZE) {
-            memcpy(mapped, data, bufferSize);
+            memcpy(mapped, data, mappedSize);
+            markDirty(0, mappedSize);
         }
         else {
+            assert(offset <= mappedSize && size <= mappedSize - offset && "Write is outside the mapped range");
             char* memOffset = (char*)mapped;
             memOffset += offset;
             memcpy(memOffset, data, size);
+            markDirty(offset, size);
+        }
+    }
+
+    /**
+     * Remembers a written byte range for flushDirty, offset is relative to the mapped region
+     *
+     * @note Consecutive writes usually touch neighbouring bytes, so they are merged right away
+     */
+    void LveBuffer::markDirty(VkDeviceSize offset, VkDeviceSize size) {
+        DirtyRange range{ mappedOffset + offset, mappedOffset + offset + size };
+        if (!dirtyRanges.empty() && range.begin <= dirtyRanges.back().end && range.end >= dirtyRanges.back().begin) {
+            dirtyRanges.back().begin = std::min(dirtyRanges.back().begin, range.begin);
+            dirtyRanges.back().end = std::max(dirtyRanges.back().end, range.end);
+            return;
         }
+        dirtyRanges.push_back(range);
     }
 
     /**
@@ -112,14 +139,57 @@ namespace lve {
      * @return VkResult of the flush call
      */
     VkResult LveBuffer::flush(VkDeviceSize size, VkDeviceSize offset) {
-        VkMappedMemoryRange mappedRange = {};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = memory;
-        mappedRange.offset = offset;
-        mappedRange.size = size;
+        if (size == VK_WHOLE_SIZE && offset == 0) {
+            dirtyRanges.clear();
+        }
+        VkMappedMemoryRange mappedRange = lveDevice.memoryAllocator().mappedRange(memory, offset, size);
         return vkFlushMappedMemoryRanges(lveDevice.device(), 1, &mappedRange);
     }
 
+    /**
+     * Flush only the ranges written since the last call, rounded out to nonCoherentAtomSize and merged
+     * where the rounded ranges touch, all in a single vkFlushMappedMemoryRanges call
+     *
+     * @note Nothing is flushed when the memory turned out to be coherent
+     *
+     * @return VkResult of the flush call
+     */
+    VkResult LveBuffer::flushDirty() {
+        LveMemoryAllocator& allocator = lveDevice.memoryAllocator();
+        if (dirtyRanges.empty() || !allocator.needsFlush(memory)) {
+            dirtyRanges.clear();
+            return VK_SUCCESS;
+        }
+
+        // the allocation starts on an atom, so rounding buffer offsets rounds the memory offsets too
+        VkDeviceSize atom = allocator.flushAlignment(memory);
+        for (auto& range : dirtyRanges) {
+            range.begin = range.begin & ~(atom - 1);
+            range.end = std::min((range.end + atom - 1) & ~(atom - 1), memory.size);
+        }
+        std::sort(dirtyRanges.begin(), dirtyRanges.end(), [](const DirtyRange& a, const DirtyRange& b) {
+            return a.begin < b.begin;
+        });
+
+        std::vector<VkMappedMemoryRange> mappedRanges;
+        for (const auto& range : dirtyRanges) {
+            if (!mappedRanges.empty()) {
+                VkMappedMemoryRange& last = mappedRanges.back();
+                if (memory.offset + range.begin <= last.offset + last.size) {
+                    last.size = std::max(last.offset + last.size, memory.offset + range.end) - last.offset;
+                    continue;
+                }
+            }
+            mappedRanges.push_back(allocator.mappedRange(memory, range.begin, range.end - range.begin));
+        }
+        dirtyRanges.clear();
+
+        return vkFlushMappedMemoryRanges(
+            lveDevice.device(),
+            static_cast<uint32_t>(mappedRanges.size()),
+            mappedRanges.data());
+    }
+
     /**
      * Invalidate a memory range of the buffer to make it visible to the host
      *
@@ -132,11 +202,7 @@ namespace lve {
      * @return VkResult of the invalidate call
      */
     VkResult LveBuffer::invalidate(VkDeviceSize size, VkDeviceSize offset) {
-        VkMappedMemoryRange mappedRange = {};
-        mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = memory;
-        mappedRange.offset = offset;
-        mappedRange.size = size;
+        VkMappedMemoryRange mappedRange = lveDevice.memoryAllocator().mappedRange(memory, offset, size);
         return vkInvalidateMappedMemoryRanges(lveDevice.device(), 1, &mappedRange);
     }
 
@@ -199,4 +265,50 @@ namespace lve {
         return invalidate(alignmentSize, index * alignmentSize);
     }
 
+    /**
+     * Writes the instance at index * alignmentSize, but only the 16 byte chunks that differ from the
+     * caller's shadow copy of what that slot holds, each run of changed chunks becomes one dirty range
+     *
+     * @param data Pointer to the new instance data, instanceSize bytes
+     * @param shadow Host copy of the slot's current contents, updated to match data
+     * @param index Used in offset calculation
+     *
+     * @note The shadow lives in ordinary memory, reading the mapped memory back would be slow
+     *
+     * @return Number of bytes written
+     */
+    VkDeviceSize LveBuffer::writeChangedToIndex(const void* data, void* shadow, int index) {
+        assert(mapped && "Cannot copy to unmapped buffer");
+        constexpr VkDeviceSize chunkSize = 16;
+
+        const char* src = static_cast<const char*>(data);
+        char* copy = static_cast<char*>(shadow);
+        assert(index * alignmentSize + instanceSize <= mappedSize && "Write is outside the mapped range");
+        char* dst = static_cast<char*>(mapped) + index * alignmentSize;
+
+        VkDeviceSize written = 0;
+        VkDeviceSize runBegin = instanceSize;
+        for (VkDeviceSize chunk = 0;; chunk += chunkSize) {
+            bool end = chunk >= instanceSize;
+            bool changed = !end && memcmp(src + chunk, copy + chunk, std::min(chunkSize, instanceSize - chunk)) != 0;
+
+            if (changed && runBegin == instanceSize) {
+                runBegin = chunk;
+            }
+            else if (!changed && runBegin != instanceSize) {
+                // chunk is the end of the run, clamped for a partial last chunk
+                VkDeviceSize runEnd = std::min(chunk, instanceSize);
+                memcpy(dst + runBegin, src + runBegin, runEnd - runBegin);
+                memcpy(copy + runBegin, src + runBegin, runEnd - runBegin);
+                markDirty(index * alignmentSize + runBegin, runEnd - runBegin);
+                written += runEnd - runBegin;
+                runBegin = instanceSize;
+            }
+            if (end) {
+                break;
+            }
+        }
+        return written;
+    }
+
 }  // namespace lve
\ No newline at end of file
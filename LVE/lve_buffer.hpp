@@ -2,6 +2,9 @@
 
 #include "lve_device.hpp"
 
+// std
+#include <vector>
+
 namespace lve {
 
     class LveBuffer {
@@ -25,6 +28,7 @@ namespace lve {
 
         void writeToBuffer(void* data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
         VkResult flush(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
+        VkResult flushDirty();
         VkDescriptorBufferInfo descriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
         VkResult invalidate(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0);
 
@@ -32,23 +36,34 @@ namespace lve {
         VkResult flushIndex(int index);
         VkDescriptorBufferInfo descriptorInfoForIndex(int index);
         VkResult invalidateIndex(int index);
+        VkDeviceSize writeChangedToIndex(const void* data, void* shadow, int index);
 
         VkBuffer getBuffer() const { return buffer; }
         void* getMappedMemory() const { return mapped; }
         uint32_t getInstanceCount() const { return instanceCount; }
         VkDeviceSize getInstanceSize() const { return instanceSize; }
-        VkDeviceSize getAlignmentSize() const { return instanceSize; }
+        VkDeviceSize getAlignmentSize() const { return alignmentSize; }
         VkBufferUsageFlags getUsageFlags() const { return usageFlags; }
         VkMemoryPropertyFlags getMemoryPropertyFlags() const { return memoryPropertyFlags; }
         VkDeviceSize getBufferSize() const { return bufferSize; }
 
     private:
         static VkDeviceSize getAlignment(VkDeviceSize instanceSize, VkDeviceSize minOffsetAlignment);
+        void markDirty(VkDeviceSize offset, VkDeviceSize size);
+
+        // byte ranges written since the last flushDirty, end exclusive
+        struct DirtyRange {
+            VkDeviceSize begin;
+            VkDeviceSize end;
+        };
 
         LveDevice& lveDevice;
         void* mapped = nullptr;
+        VkDeviceSize mappedOffset = 0;
+        VkDeviceSize mappedSize = 0;
+        std::vector<DirtyRange> dirtyRanges;
         VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        LveMemoryAllocation memory{}; // sub-allocated, may share its VkDeviceMemory with other buffers
 
         VkDeviceSize bufferSize;
         uint32_t instanceCount;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "lve_frustum.hpp"
+
 // libs
 #define GLM_FORCE_RADIANS // forces in radians and not degrees
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE // Vulkan uses 0 to 1, openGL uses 1 to 1
@@ -25,6 +27,9 @@ namespace lve {
 		const glm::mat4& getInverseView() const { return inverseViewMatrix; } // getInverseView
 		const glm::vec3 getPosition() const { return glm::vec3(inverseViewMatrix[3]); }
 
+		// the clip planes in world space
+		LveFrustum getFrustum() const { return LveFrustum::fromMatrix(projectionMatrix * viewMatrix); } // getFrustum
+
 	}; // lveCamera
 
 } // lve
\ No newline at end of file
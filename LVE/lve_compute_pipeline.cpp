@@ -0,0 +1,55 @@
+#include "lve_compute_pipeline.hpp"
+#include "lve_pipline.hpp"
+
+// std
+#include <stdexcept>
+#include <cassert>
+
+namespace lve {
+
+	LveComputePipeline::LveComputePipeline(LveDevice& device,
+		const std::string& compFilePath,
+		VkPipelineLayout pipelineLayout,
+		const VkSpecializationInfo* specializationInfo) : lveDevice{ device } {
+		assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline: no pipeline layout provided");
+
+		auto compCode = LvePipeline::readFile(compFilePath);
+
+		VkShaderModuleCreateInfo moduleInfo{};
+		moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		moduleInfo.codeSize = compCode.size();
+		moduleInfo.pCode = reinterpret_cast<const uint32_t*>(compCode.data());
+
+		if (vkCreateShaderModule(lveDevice.device(), &moduleInfo, nullptr, &compShaderModule) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create shader module");
+
+		} // if
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = compShaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.stage.pSpecializationInfo = specializationInfo;
+		pipelineInfo.layout = pipelineLayout;
+
+		if (vkCreateComputePipelines(lveDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute pipeline");
+
+		} // if
+
+	} // LveComputePipeline
+
+	LveComputePipeline::~LveComputePipeline() {
+		vkDestroyShaderModule(lveDevice.device(), compShaderModule, nullptr);
+		vkDestroyPipeline(lveDevice.device(), computePipeline, nullptr);
+
+	} // ~LveComputePipeline
+
+	void LveComputePipeline::bind(VkCommandBuffer commandBuffer) {
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+
+	} // bind
+
+} // lve
@@ -0,0 +1,31 @@
+#pragma once
+#include "lve_device.hpp"
+
+#include <string>
+
+namespace lve {
+
+	// a compute shader and its pipeline, the layout stays with the caller like PipelineConfigInfo::pipelineLayout does
+	class LveComputePipeline {
+
+	public:
+		LveComputePipeline(LveDevice& device,
+			const std::string& compFilePath,
+			VkPipelineLayout pipelineLayout,
+			const VkSpecializationInfo* specializationInfo = nullptr);
+
+		~LveComputePipeline();
+
+		LveComputePipeline(const LveComputePipeline&) = delete;
+		LveComputePipeline& operator=(const LveComputePipeline&) = delete;
+
+		void bind(VkCommandBuffer commandBuffer);
+
+	private:
+		LveDevice& lveDevice;
+		VkPipeline computePipeline;
+		VkShaderModule compShaderModule;
+
+	}; // LveComputePipeline
+
+} // lve
@@ -0,0 +1,87 @@
+#include "lve_defragmenter.hpp"
+
+namespace lve {
+
+	std::vector<LveDefragmenter::Move> LveDefragmenter::step(
+		const std::vector<LveRangeAllocator*>& blocks,
+		uint64_t budget,
+		const std::function<bool(uint32_t block, uint64_t offset)>& canMove) {
+		std::vector<Move> moves;
+		if (settled)
+			return moves;
+
+		// the last victim was emptied and released, or emptied by frees
+		if (victim != NO_BLOCK && (victim >= blocks.size() || blocks[victim] == nullptr || blocks[victim]->isEmpty()))
+			victim = NO_BLOCK;
+
+		if (victim == NO_BLOCK) {
+			victim = pickVictim(blocks);
+			if (victim == NO_BLOCK) {
+				settled = true;
+				return moves;
+
+			} // if
+
+		} // if
+
+		uint64_t moved = 0;
+		for (const auto& [offset, size] : blocks[victim]->getAllocations()) {
+			if (moved > 0 && moved + size > budget)
+				break;
+
+			if (!canMove(victim, offset))
+				continue;
+
+			Move move{ victim, offset, NO_BLOCK, LveRangeAllocator::NO_SPACE, size };
+			for (uint32_t b = 0; b < blocks.size() && move.dstOffset == LveRangeAllocator::NO_SPACE; b++) {
+				if (b == victim || blocks[b] == nullptr)
+					continue;
+
+				move.dstOffset = blocks[b]->allocate(size);
+				move.dstBlock = b;
+
+			} // for
+
+			// there is enough free space in total but the holes are too small, wait for frees before trying again
+			if (move.dstOffset == LveRangeAllocator::NO_SPACE) {
+				victim = NO_BLOCK;
+				settled = true;
+				break;
+
+			} // if
+
+			moves.push_back(move);
+			moved += size;
+
+		} // for
+
+		return moves;
+
+	} // step
+
+	uint32_t LveDefragmenter::pickVictim(const std::vector<LveRangeAllocator*>& blocks) const {
+		uint64_t totalFree = 0;
+		for (const auto* block : blocks) {
+			if (block != nullptr)
+				totalFree += block->getCapacity() - block->getUsed();
+
+		} // for
+
+		// the emptiest block whose ranges fit into the free space of the others, emptying it saves a whole block
+		uint32_t best = NO_BLOCK;
+		for (uint32_t b = 1; b < blocks.size(); b++) {
+			if (blocks[b] == nullptr || blocks[b]->isEmpty())
+				continue;
+
+			uint64_t used = blocks[b]->getUsed();
+			uint64_t freeElsewhere = totalFree - (blocks[b]->getCapacity() - used);
+			if (used <= freeElsewhere && (best == NO_BLOCK || used < blocks[best]->getUsed()))
+				best = b;
+
+		} // for
+
+		return best;
+
+	} // pickVictim
+
+} // lve
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "lve_range_allocator.hpp"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace lve {
+
+	// plans the compaction of a set of blocks sub-allocated with LveRangeAllocator, a few ranges per step: it picks the
+	// emptiest block the others have room for and moves its ranges into their holes until the block is empty and can be
+	// released, it only does the bookkeeping, copying the data and patching the handles is up to the owner
+	class LveDefragmenter {
+	public:
+		static constexpr uint32_t NO_BLOCK = UINT32_MAX;
+
+		// the destination range is already allocated, the source range stays allocated until the owner frees it
+		struct Move {
+			uint32_t srcBlock = 0;
+			uint64_t srcOffset = 0;
+			uint32_t dstBlock = 0;
+			uint64_t dstOffset = 0;
+			uint64_t size = 0;
+
+		}; // Move
+
+		// blocks are indexed like the owner's, null for released slots, block 0 is never emptied since owners keep their
+		// first block around anyway, canMove is false for ranges that cannot move yet (data still uploading, already moved)
+		// budget is in the allocators' units, one move is always allowed so ranges larger than the budget move too
+		std::vector<Move> step(
+			const std::vector<LveRangeAllocator*>& blocks,
+			uint64_t budget,
+			const std::function<bool(uint32_t block, uint64_t offset)>& canMove);
+
+		// a range was freed or a block added, a block that could not be emptied before may be now
+		void invalidate() { settled = false; } // invalidate
+
+		// the owner released the block, its slot may hold a new block by the next step
+		void blockReleased(uint32_t block) {
+			if (victim == block)
+				victim = NO_BLOCK;
+
+			settled = false;
+
+		} // blockReleased
+
+		// the block being emptied, new ranges should only go there when no other block has room
+		uint32_t getVictim() const { return victim; } // getVictim
+
+	private:
+		uint32_t pickVictim(const std::vector<LveRangeAllocator*>& blocks) const;
+
+		uint32_t victim = NO_BLOCK;
+		bool settled = false; // nothing to do until invalidate
+
+	}; // LveDefragmenter
+
+} // lve
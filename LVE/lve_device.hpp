@@ -1,8 +1,10 @@
 #pragma once
 
 #include "lve_window.hpp"
+#include "lve_memory_allocator.hpp"
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -17,8 +19,10 @@ namespace lve {
     struct QueueFamilyIndices {
         uint32_t graphicsFamily;
         uint32_t presentFamily;
+        uint32_t transferFamily; // a family that can copy but not draw, uploads run there next to rendering
         bool graphicsFamilyHasValue = false;
         bool presentFamilyHasValue = false;
+        bool transferFamilyHasValue = false;
         bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
     };
 
@@ -31,6 +35,8 @@ namespace lve {
 #endif
 
         LveDevice(LveWindow& window);
+        // headless, no surface and no swapchain, only a graphics queue for offscreen work like the benchmarks
+        LveDevice();
         ~LveDevice();
 
         // Not copyable or movable
@@ -44,6 +50,17 @@ namespace lve {
         VkSurfaceKHR surface() { return surface_; }
         VkQueue graphicsQueue() { return graphicsQueue_; }
         VkQueue presentQueue() { return presentQueue_; }
+        bool isHeadless() { return window == nullptr; }
+        // the graphics queue when the device has no transfer only family
+        VkQueue transferQueue() { return transferQueue_; }
+        bool hasDedicatedTransferQueue() { return transferQueue_ != graphicsQueue_; }
+        LveMemoryAllocator& memoryAllocator() { return *memoryAllocator_; }
+        // VK_EXT_memory_budget was enabled, heap budgets come from the driver instead of an estimate
+        bool hasMemoryBudget() { return memoryBudgetSupported; }
+        // multiDrawIndirect and drawIndirectFirstInstance were enabled, one indirect call can draw many objects
+        bool hasMultiDrawIndirect() { return multiDrawIndirectSupported; }
+        // vkCmdDrawIndexedIndirectCountKHR when VK_KHR_draw_indirect_count was enabled, nullptr otherwise
+        PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount() { return drawIndexedIndirectCount_; }
 
         SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
         uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -52,15 +69,16 @@ namespace lve {
             const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
         // Buffer Helper Functions
+        // the memory is sub-allocated, give it back with memoryAllocator().free after destroying the resource
         void createBuffer(
             VkDeviceSize size,
             VkBufferUsageFlags usage,
             VkMemoryPropertyFlags properties,
             VkBuffer& buffer,
-            VkDeviceMemory& bufferMemory);
+            LveMemoryAllocation& bufferMemory);
         VkCommandBuffer beginSingleTimeCommands();
         void endSingleTimeCommands(VkCommandBuffer commandBuffer);
-        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+        void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0);
         void copyBufferToImage(
             VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
 
@@ -68,7 +86,7 @@ namespace lve {
             const VkImageCreateInfo& imageInfo,
             VkMemoryPropertyFlags properties,
             VkImage& image,
-            VkDeviceMemory& imageMemory);
+            LveMemoryAllocation& imageMemory);
 
         VkPhysicalDeviceProperties properties;
 
@@ -88,18 +106,24 @@ namespace lve {
         void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
         void hasGflwRequiredInstanceExtensions();
         bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+        bool isDeviceExtensionAvailable(VkPhysicalDevice device, const char* extensionName);
         SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
         VkInstance instance;
         VkDebugUtilsMessengerEXT debugMessenger;
         VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-        LveWindow& window;
+        LveWindow* window = nullptr;
         VkCommandPool commandPool;
 
         VkDevice device_;
-        VkSurfaceKHR surface_;
+        VkSurfaceKHR surface_ = VK_NULL_HANDLE;
         VkQueue graphicsQueue_;
         VkQueue presentQueue_;
+        VkQueue transferQueue_;
+        std::unique_ptr<LveMemoryAllocator> memoryAllocator_;
+        bool memoryBudgetSupported = false;
+        bool multiDrawIndirectSupported = false;
+        PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount_ = nullptr;
 
         const std::vector<const char*> validationLayers = { "VK_LAYER_KHRONOS_validation" };
         const std::vector<const char*> deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
@@ -0,0 +1,155 @@
+#include "lve_dynamic_buffer.hpp"
+#include "lve_swap_chain.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace lve {
+
+	LveDynamicBuffer::LveDynamicBuffer(
+		LveDevice& device,
+		VkDeviceSize instanceSize,
+		uint32_t initialCount,
+		VkBufferUsageFlags usageFlags,
+		VkMemoryPropertyFlags memoryPropertyFlags,
+		VkDeviceSize minOffsetAlignment)
+		: lveDevice{ device },
+		instanceSize{ instanceSize },
+		memoryPropertyFlags{ memoryPropertyFlags },
+		minOffsetAlignment{ minOffsetAlignment } {
+		// device local contents can only be carried over by a copy on the GPU
+		bool mapped = (memoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+		this->usageFlags = mapped ? usageFlags : usageFlags | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+		current = createBuffer(std::max(initialCount, 1u));
+
+	} // LveDynamicBuffer
+
+	void LveDynamicBuffer::beginFrame(int frameIndex) {
+		this->frameIndex = frameIndex;
+		frame++;
+
+		// the swap chain waits for a frame's fence before its index comes around again, after that many calls no
+		// submitted frame can still be reading a buffer that was replaced
+		retired.erase(std::remove_if(retired.begin(), retired.end(), [&](const RetiredBuffer& buffer) {
+			return buffer.frame + LveSwapChain::MAX_FRAMES_IN_FLIGHT <= frame;
+		}), retired.end());
+
+		for (auto& descriptor : descriptors) {
+			if (descriptor.stale && descriptor.frameIndex == frameIndex)
+				writeDescriptor(descriptor);
+
+		} // for
+
+	} // beginFrame
+
+	bool LveDynamicBuffer::reserve(uint32_t count, VkCommandBuffer commandBuffer) {
+		uint32_t capacity = current->getInstanceCount();
+		if (count <= capacity)
+			return false;
+
+		// doubling keeps the copying amortized constant per instance
+		uint32_t newCapacity = std::max(count, capacity * 2);
+		std::unique_ptr<LveBuffer> grown = createBuffer(newCapacity);
+		VkDeviceSize oldSize = current->getBufferSize();
+
+		if (current->getMappedMemory() != nullptr) {
+			std::memcpy(grown->getMappedMemory(), current->getMappedMemory(), oldSize);
+			grown->flush();
+
+		} // if
+		else {
+			assert(commandBuffer != VK_NULL_HANDLE && "growing a device local buffer needs a command buffer for the copy");
+
+			// whatever wrote the old buffer before, in this command buffer or an earlier submission, lands before the copy
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0,
+				1,
+				&barrier,
+				0,
+				nullptr,
+				0,
+				nullptr);
+
+			VkBufferCopy region{ 0, 0, oldSize };
+			vkCmdCopyBuffer(commandBuffer, current->getBuffer(), grown->getBuffer(), 1, &region);
+
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+				0,
+				1,
+				&barrier,
+				0,
+				nullptr,
+				0,
+				nullptr);
+
+		} // else
+
+		retired.push_back(RetiredBuffer{ std::move(current), frame });
+		current = std::move(grown);
+		growCount++;
+
+		// sets of other frames may be bound by a frame in flight, they are rewritten once that frame is done
+		for (auto& descriptor : descriptors) {
+			descriptor.stale = true;
+			if (descriptor.frameIndex == frameIndex)
+				writeDescriptor(descriptor);
+
+		} // for
+
+		return true;
+
+	} // reserve
+
+	void LveDynamicBuffer::addDescriptor(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, int frameIndex, VkDeviceSize range) {
+		descriptors.push_back(Descriptor{ set, binding, type, frameIndex, range, false });
+
+	} // addDescriptor
+
+	void LveDynamicBuffer::removeDescriptor(VkDescriptorSet set, uint32_t binding) {
+		descriptors.erase(std::remove_if(descriptors.begin(), descriptors.end(), [&](const Descriptor& descriptor) {
+			return descriptor.set == set && descriptor.binding == binding;
+		}), descriptors.end());
+
+	} // removeDescriptor
+
+	std::unique_ptr<LveBuffer> LveDynamicBuffer::createBuffer(uint32_t count) const {
+		auto buffer = std::make_unique<LveBuffer>(lveDevice, instanceSize, count, usageFlags, memoryPropertyFlags, minOffsetAlignment);
+		if (memoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+			buffer->map();
+
+		return buffer;
+
+	} // createBuffer
+
+	void LveDynamicBuffer::writeDescriptor(Descriptor& descriptor) {
+		VkDescriptorBufferInfo bufferInfo = current->descriptorInfo(descriptor.range, 0);
+
+		VkWriteDescriptorSet write{};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = descriptor.set;
+		write.dstBinding = descriptor.binding;
+		write.descriptorType = descriptor.type;
+		write.descriptorCount = 1;
+		write.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(lveDevice.device(), 1, &write, 0, nullptr);
+
+		descriptor.stale = false;
+
+	} // writeDescriptor
+
+} // lve
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+	// an LveBuffer whose instance count can grow while frames using it are in flight: growing doubles the capacity,
+	// carries the old contents over and keeps the old buffer alive until no frame in flight can still read it, the
+	// LveDynamicBuffer itself is the handle to hold on to, descriptor sets registered with it are rewritten for you
+	class LveDynamicBuffer {
+	public:
+		LveDynamicBuffer(
+			LveDevice& device,
+			VkDeviceSize instanceSize,
+			uint32_t initialCount,
+			VkBufferUsageFlags usageFlags,
+			VkMemoryPropertyFlags memoryPropertyFlags,
+			VkDeviceSize minOffsetAlignment = 1);
+
+		LveDynamicBuffer(const LveDynamicBuffer&) = delete;
+		LveDynamicBuffer& operator=(const LveDynamicBuffer&) = delete;
+
+		// call right after LveRenderer::beginFrame, destroys the buffers no frame in flight uses anymore and points the
+		// descriptor sets of this frame index at the current buffer
+		void beginFrame(int frameIndex);
+
+		// grows to at least count instances, returns true when the buffer was replaced, device local contents are copied
+		// on the GPU in commandBuffer (outside of a render pass, before anything reads the new buffer), mapped ones on the
+		// CPU since a GPU copy would land on top of whatever the host writes after this call
+		bool reserve(uint32_t count, VkCommandBuffer commandBuffer = VK_NULL_HANDLE);
+
+		// set is rewritten when the buffer grows: right away when frameIndex is the current frame, otherwise in the
+		// beginFrame of frameIndex, once the frame that last bound it has finished, range is per bind for dynamic types
+		void addDescriptor(VkDescriptorSet set, uint32_t binding, VkDescriptorType type, int frameIndex, VkDeviceSize range = VK_WHOLE_SIZE);
+		void removeDescriptor(VkDescriptorSet set, uint32_t binding);
+
+		LveBuffer& buffer() { return *current; } // buffer
+		VkBuffer getBuffer() const { return current->getBuffer(); } // getBuffer
+		void* getMappedMemory() const { return current->getMappedMemory(); } // getMappedMemory
+		uint32_t getCapacity() const { return current->getInstanceCount(); } // getCapacity
+		VkDeviceSize getAlignmentSize() const { return current->getAlignmentSize(); } // getAlignmentSize
+		uint32_t getGrowCount() const { return growCount; } // getGrowCount
+
+	private:
+		struct Descriptor {
+			VkDescriptorSet set;
+			uint32_t binding;
+			VkDescriptorType type;
+			int frameIndex;
+			VkDeviceSize range;
+			bool stale; // still points at an older buffer
+
+		}; // Descriptor
+
+		struct RetiredBuffer {
+			std::unique_ptr<LveBuffer> buffer;
+			uint64_t frame;
+
+		}; // RetiredBuffer
+
+		std::unique_ptr<LveBuffer> createBuffer(uint32_t count) const;
+		void writeDescriptor(Descriptor& descriptor);
+
+		LveDevice& lveDevice;
+		VkDeviceSize instanceSize;
+		VkBufferUsageFlags usageFlags;
+		VkMemoryPropertyFlags memoryPropertyFlags;
+		VkDeviceSize minOffsetAlignment;
+
+		std::unique_ptr<LveBuffer> current;
+		std::vector<RetiredBuffer> retired;
+		std::vector<Descriptor> descriptors;
+		uint64_t frame = 0; // beginFrame calls so far
+		int frameIndex = -1; // of the frame being recorded
+		uint32_t growCount = 0;
+
+	}; // LveDynamicBuffer
+
+} // lve
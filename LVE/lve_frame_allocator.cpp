@@ -0,0 +1,87 @@
+#include "lve_frame_allocator.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+namespace lve {
+
+	LveFrameAllocator::LveFrameAllocator(LveDevice& device, uint32_t frameCount, VkDeviceSize frameSize) : frameSize{ frameSize } {
+		const VkPhysicalDeviceLimits& limits = device.properties.limits;
+		uniformAlignment = std::max<VkDeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+		storageAlignment = std::max<VkDeviceSize>(limits.minStorageBufferOffsetAlignment, 1);
+
+		// every region starts on an alignment any kind of binding accepts
+		VkDeviceSize regionAlignment = std::max({ uniformAlignment, storageAlignment, VkDeviceSize{ 256 } });
+
+		buffer = std::make_unique<LveBuffer>(
+			device,
+			frameSize,
+			frameCount,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
+				| VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			regionAlignment);
+
+		buffer->map();
+		mapped = static_cast<char*>(buffer->getMappedMemory());
+		stats.frameSize = frameSize;
+
+	} // LveFrameAllocator
+
+	void LveFrameAllocator::beginFrame(int frameIndex) {
+		assert(frameIndex >= 0 && static_cast<uint32_t>(frameIndex) < buffer->getInstanceCount() && "frame index out of range");
+
+		frameStart = buffer->getAlignmentSize() * frameIndex;
+		head = 0;
+		overflowReported = false;
+
+	} // beginFrame
+
+	LveFrameAllocator::Allocation LveFrameAllocator::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment has to be a power of two");
+
+		// regions start aligned, so aligning the offset within the region aligns it within the buffer
+		VkDeviceSize offset = (head + alignment - 1) & ~(alignment - 1);
+		if (offset + size > frameSize) {
+			stats.overflowCount++;
+			stats.overflowBytes += size;
+
+			if (!overflowReported) {
+				std::cerr << "LveFrameAllocator: frame region of " << frameSize / 1024 << " KiB is full, "
+					<< size << " bytes refused\n";
+				overflowReported = true;
+
+			} // if
+
+			return Allocation{};
+
+		} // if
+
+		head = offset + size;
+		stats.lastFrameUsed = head;
+		stats.highWaterMark = std::max(stats.highWaterMark, head);
+
+		Allocation allocation{};
+		allocation.buffer = buffer->getBuffer();
+		allocation.offset = frameStart + offset;
+		allocation.size = size;
+		allocation.data = mapped + allocation.offset;
+		return allocation;
+
+	} // allocate
+
+	void LveFrameAllocator::flush() {
+		if (head > 0)
+			buffer->flush(head, frameStart);
+
+	} // flush
+
+	void LveFrameAllocator::printStats(std::ostream& out) const {
+		out << "Frame allocator: " << stats.highWaterMark / 1024 << " / " << stats.frameSize / 1024 << " KiB high water mark, "
+			<< stats.overflowCount << " overflows (" << stats.overflowBytes / 1024 << " KiB refused)\n";
+
+	} // printStats
+
+} // lve
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+namespace lve {
+
+	// bump allocator for data that only lives for one frame (instance data, per draw uniforms, debug geometry):
+	// one mapped buffer split into a region per frame in flight, a region is reset in beginFrame, after the swap
+	// chain has waited for the fence of the frame that used it last, so allocating is only an add
+	class LveFrameAllocator {
+	public:
+		static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 4 * 1024 * 1024;
+
+		struct Allocation {
+			void* data = nullptr; // write here, nullptr when the frame's region is full
+			VkBuffer buffer = VK_NULL_HANDLE;
+			VkDeviceSize offset = 0; // from the start of the buffer, usable as a dynamic or bind offset
+			VkDeviceSize size = 0;
+
+			bool isValid() const { return data != nullptr; } // isValid
+
+		}; // Allocation
+
+		struct Stats {
+			VkDeviceSize frameSize = 0;
+			VkDeviceSize lastFrameUsed = 0;
+			VkDeviceSize highWaterMark = 0; // most bytes any single frame has used
+			uint64_t overflowCount = 0; // allocations refused because the region was full
+			VkDeviceSize overflowBytes = 0;
+
+		}; // Stats
+
+		LveFrameAllocator(LveDevice& device, uint32_t frameCount, VkDeviceSize frameSize = DEFAULT_FRAME_SIZE);
+
+		LveFrameAllocator(const LveFrameAllocator&) = delete;
+		LveFrameAllocator& operator=(const LveFrameAllocator&) = delete;
+
+		// call right after LveRenderer::beginFrame, everything handed out the last time this frame index was used is gone
+		void beginFrame(int frameIndex);
+
+		// alignment has to be a power of two, the uniform and storage alignments below cover binding the range
+		Allocation allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+		Allocation allocateUniform(VkDeviceSize size) { return allocate(size, uniformAlignment); } // allocateUniform
+		Allocation allocateStorage(VkDeviceSize size) { return allocate(size, storageAlignment); } // allocateStorage
+
+		// makes this frame's writes visible to the device, call before the frame's command buffer is submitted
+		void flush();
+
+		VkBuffer getBuffer() const { return buffer->getBuffer(); } // getBuffer
+		const Stats& getStats() const { return stats; } // getStats
+		void printStats(std::ostream& out) const;
+
+	private:
+		std::unique_ptr<LveBuffer> buffer;
+		char* mapped = nullptr;
+		VkDeviceSize frameSize;
+		VkDeviceSize uniformAlignment;
+		VkDeviceSize storageAlignment;
+
+		VkDeviceSize frameStart = 0; // offset of the current frame's region
+		VkDeviceSize head = 0; // bytes used in the current frame's region
+		bool overflowReported = false;
+		Stats stats{};
+
+	}; // LveFrameAllocator
+
+} // lve
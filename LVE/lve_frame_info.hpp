@@ -2,6 +2,8 @@
 
 #include "lve_camera.hpp"
 #include "lve_game_object.hpp"
+#include "lve_frame_allocator.hpp"
+#include "lve_parallel_recorder.hpp"
 
 // lib
 #include <vulkan/vulkan.h>
@@ -34,7 +36,10 @@ namespace lve {
 		VkCommandBuffer commandBuffer;
 		LveCamera& camera;
 		VkDescriptorSet globalDescriptorSet;
+		uint32_t globalUboOffset; // dynamic offset of this frame's slot in the global ubo buffer
 		LveGameObject::Map& gameObject;
+		LveFrameAllocator& frameAllocator; // scratch memory that is valid until this frame index comes around again
+		LveParallelRecorder* parallelRecorder; // null = the render pass is recorded inline into commandBuffer
 
 	}; // FrameInfo
 
@@ -0,0 +1,42 @@
+#include "lve_frustum.hpp"
+
+namespace lve {
+
+	LveFrustum LveFrustum::fromMatrix(const glm::mat4& clipFromSpace) {
+		// Gribb and Hartmann, a point is inside when -w <= x <= w, -w <= y <= w and 0 <= z <= w (Vulkan depth range)
+		auto row = [&clipFromSpace](int i) {
+			return glm::vec4{ clipFromSpace[0][i], clipFromSpace[1][i], clipFromSpace[2][i], clipFromSpace[3][i] };
+
+		}; // row
+
+		LveFrustum frustum{};
+		frustum.planes[0] = row(3) + row(0);
+		frustum.planes[1] = row(3) - row(0);
+		frustum.planes[2] = row(3) + row(1);
+		frustum.planes[3] = row(3) - row(1);
+		frustum.planes[4] = row(2);
+		frustum.planes[5] = row(3) - row(2);
+
+		for (auto& plane : frustum.planes) {
+			float length = glm::length(glm::vec3(plane));
+			if (length > 0.f)
+				plane /= length;
+
+		} // for
+
+		return frustum;
+
+	} // fromMatrix
+
+	bool LveFrustum::intersectsSphere(const glm::vec3& center, float radius) const {
+		for (const auto& plane : planes) {
+			if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+				return false;
+
+		} // for
+
+		return true;
+
+	} // intersectsSphere
+
+} // lve
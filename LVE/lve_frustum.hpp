@@ -0,0 +1,25 @@
+#pragma once
+
+// libs
+#define GLM_FORCE_RADIANS // forces in radians and not degrees
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE // Vulkan uses 0 to 1, openGL uses 1 to 1
+#include <glm/glm.hpp>
+
+namespace lve {
+
+	// the six clip planes of a projection, normals point inwards and are normalized so dot(plane, point) is a distance
+	// built from projection * view the planes are in world space, from projection * view * model they are in that model's space
+	class LveFrustum {
+	public:
+		static LveFrustum fromMatrix(const glm::mat4& clipFromSpace);
+
+		bool intersectsSphere(const glm::vec3& center, float radius) const;
+
+		const glm::vec4* getPlanes() const { return planes; } // getPlanes
+
+	private:
+		glm::vec4 planes[6]{}; // left, right, top, bottom, near, far
+
+	}; // LveFrustum
+
+} // lve
@@ -0,0 +1,247 @@
+#include "lve_frustum_culler.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+
+// the vector paths are x64 only, where SSE2 is always there and AVX is checked at runtime, so the build needs no
+// /arch flag and a CPU without AVX still runs the SSE path
+#if defined(_M_X64) || defined(__x86_64__)
+#define LVE_CULLER_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define LVE_TARGET_AVX
+#else
+#define LVE_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+namespace lve {
+
+	namespace {
+
+#ifdef LVE_CULLER_X64
+		bool cpuHasAvx() {
+#ifdef _MSC_VER
+			// the CPU has to support it and the OS has to save the ymm registers on a context switch
+			int info[4];
+			__cpuid(info, 1);
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx = (info[2] & (1 << 28)) != 0;
+			return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+#else
+			return __builtin_cpu_supports("avx");
+#endif
+
+		} // cpuHasAvx
+#endif
+
+	} // namespace
+
+	bool LveFrustumCuller::isSupported(Path path) {
+		switch (path) {
+#ifdef LVE_CULLER_X64
+		case Path::Sse:
+			return true;
+
+		case Path::Avx: {
+			static const bool avx = cpuHasAvx();
+			return avx;
+
+		} // Avx
+#endif
+		case Path::Scalar:
+			return true;
+
+		default:
+			return false;
+
+		} // switch
+
+	} // isSupported
+
+	LveFrustumCuller::Path LveFrustumCuller::fastestPath() {
+		if (isSupported(Path::Avx))
+			return Path::Avx;
+
+		return isSupported(Path::Sse) ? Path::Sse : Path::Scalar;
+
+	} // fastestPath
+
+	void LveFrustumCuller::clear() {
+		count = 0;
+		for (auto* values : { &centerX, &centerY, &centerZ, &radius, &extentX, &extentY, &extentZ })
+			values->clear();
+
+	} // clear
+
+	void LveFrustumCuller::reserve(uint32_t objectCount) {
+		for (auto* values : { &centerX, &centerY, &centerZ, &radius, &extentX, &extentY, &extentZ })
+			values->reserve(objectCount);
+
+	} // reserve
+
+	uint32_t LveFrustumCuller::add(const LveModel::Bounds& bounds, const glm::mat4& modelMatrix) {
+		glm::vec3 center = glm::vec3(modelMatrix * glm::vec4(bounds.center, 1.f));
+		glm::vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+
+		// the box around the moved box (Arvo), each world axis gathers the local half extents through the absolute matrix
+		glm::vec3 extent{ 0.f };
+		for (int column = 0; column < 3; column++) {
+			for (int row = 0; row < 3; row++)
+				extent[row] += std::abs(modelMatrix[column][row]) * halfExtent[column];
+
+		} // for
+
+		// the sphere scales with the largest axis of the transform
+		float scale = std::max({ glm::length(glm::vec3(modelMatrix[0])), glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2])) });
+
+		centerX.push_back(center.x);
+		centerY.push_back(center.y);
+		centerZ.push_back(center.z);
+		radius.push_back(bounds.radius * scale);
+		extentX.push_back(extent.x);
+		extentY.push_back(extent.y);
+		extentZ.push_back(extent.z);
+
+		return count++;
+
+	} // add
+
+	void LveFrustumCuller::cull(const LveFrustum& frustum, std::vector<uint32_t>& visible, Path path) const {
+		Plane planes[6];
+		for (int p = 0; p < 6; p++) {
+			const glm::vec4& plane = frustum.getPlanes()[p];
+			planes[p] = Plane{ plane.x, plane.y, plane.z, plane.w, std::abs(plane.x), std::abs(plane.y), std::abs(plane.z) };
+
+		} // for
+
+		visible.reserve(visible.size() + count);
+
+		uint32_t first = 0;
+		if (path == Path::Avx && isSupported(Path::Avx))
+			first = cullAvx(planes, visible);
+		else if (path != Path::Scalar && isSupported(Path::Sse))
+			first = cullSse(planes, visible);
+
+		cullScalar(planes, first, visible);
+
+	} // cull
+
+	// the vector paths below do the same operations in the same order, so every path returns exactly the same objects
+	void LveFrustumCuller::cullScalar(const Plane* planes, uint32_t first, std::vector<uint32_t>& visible) const {
+		for (uint32_t i = first; i < count; i++) {
+			bool outside = false;
+			for (int p = 0; p < 6; p++) {
+				const Plane& plane = planes[p];
+				float distance = plane.x * centerX[i] + plane.y * centerY[i] + plane.z * centerZ[i] + plane.w;
+				float boxRadius = plane.absX * extentX[i] + plane.absY * extentY[i] + plane.absZ * extentZ[i];
+				outside |= distance < -std::min(radius[i], boxRadius);
+
+			} // for
+
+			if (!outside)
+				visible.push_back(i);
+
+		} // for
+
+	} // cullScalar
+
+#ifdef LVE_CULLER_X64
+	uint32_t LveFrustumCuller::cullSse(const Plane* planes, std::vector<uint32_t>& visible) const {
+		const __m128 zero = _mm_setzero_ps();
+
+		uint32_t first = 0;
+		for (; first + 4 <= count; first += 4) {
+			__m128 x = _mm_loadu_ps(&centerX[first]);
+			__m128 y = _mm_loadu_ps(&centerY[first]);
+			__m128 z = _mm_loadu_ps(&centerZ[first]);
+			__m128 r = _mm_loadu_ps(&radius[first]);
+			__m128 ex = _mm_loadu_ps(&extentX[first]);
+			__m128 ey = _mm_loadu_ps(&extentY[first]);
+			__m128 ez = _mm_loadu_ps(&extentZ[first]);
+
+			__m128 outside = zero;
+			for (int p = 0; p < 6; p++) {
+				const Plane& plane = planes[p];
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(_mm_set1_ps(plane.x), x),
+					_mm_mul_ps(_mm_set1_ps(plane.y), y)),
+					_mm_mul_ps(_mm_set1_ps(plane.z), z)),
+					_mm_set1_ps(plane.w));
+				__m128 boxRadius = _mm_add_ps(_mm_add_ps(
+					_mm_mul_ps(_mm_set1_ps(plane.absX), ex),
+					_mm_mul_ps(_mm_set1_ps(plane.absY), ey)),
+					_mm_mul_ps(_mm_set1_ps(plane.absZ), ez));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_sub_ps(zero, _mm_min_ps(r, boxRadius))));
+
+			} // for
+
+			int inside = ~_mm_movemask_ps(outside) & 0xF;
+			for (uint32_t lane = 0; inside != 0; lane++, inside >>= 1) {
+				if (inside & 1)
+					visible.push_back(first + lane);
+
+			} // for
+
+		} // for
+
+		return first;
+
+	} // cullSse
+
+	LVE_TARGET_AVX uint32_t LveFrustumCuller::cullAvx(const Plane* planes, std::vector<uint32_t>& visible) const {
+		const __m256 zero = _mm256_setzero_ps();
+
+		uint32_t first = 0;
+		for (; first + 8 <= count; first += 8) {
+			__m256 x = _mm256_loadu_ps(&centerX[first]);
+			__m256 y = _mm256_loadu_ps(&centerY[first]);
+			__m256 z = _mm256_loadu_ps(&centerZ[first]);
+			__m256 r = _mm256_loadu_ps(&radius[first]);
+			__m256 ex = _mm256_loadu_ps(&extentX[first]);
+			__m256 ey = _mm256_loadu_ps(&extentY[first]);
+			__m256 ez = _mm256_loadu_ps(&extentZ[first]);
+
+			__m256 outside = zero;
+			for (int p = 0; p < 6; p++) {
+				const Plane& plane = planes[p];
+				__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(_mm256_set1_ps(plane.x), x),
+					_mm256_mul_ps(_mm256_set1_ps(plane.y), y)),
+					_mm256_mul_ps(_mm256_set1_ps(plane.z), z)),
+					_mm256_set1_ps(plane.w));
+				__m256 boxRadius = _mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(_mm256_set1_ps(plane.absX), ex),
+					_mm256_mul_ps(_mm256_set1_ps(plane.absY), ey)),
+					_mm256_mul_ps(_mm256_set1_ps(plane.absZ), ez));
+				outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_sub_ps(zero, _mm256_min_ps(r, boxRadius)), _CMP_LT_OQ));
+
+			} // for
+
+			int inside = ~_mm256_movemask_ps(outside) & 0xFF;
+			for (uint32_t lane = 0; inside != 0; lane++, inside >>= 1) {
+				if (inside & 1)
+					visible.push_back(first + lane);
+
+			} // for
+
+		} // for
+
+		return first;
+
+	} // cullAvx
+#else
+	uint32_t LveFrustumCuller::cullSse(const Plane* planes, std::vector<uint32_t>& visible) const {
+		return 0;
+
+	} // cullSse
+
+	uint32_t LveFrustumCuller::cullAvx(const Plane* planes, std::vector<uint32_t>& visible) const {
+		return 0;
+
+	} // cullAvx
+#endif
+
+} // lve
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "lve_frustum.hpp"
+#include "lve_model.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS // forces in radians and not degrees
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE // Vulkan uses 0 to 1, openGL uses 1 to 1
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+	// world space bounds of many objects packed as a structure of arrays, tested against a frustum 8 (AVX) or 4 (SSE)
+	// objects at a time, an object is culled once its sphere or its box is completely behind one of the planes
+	// the box is kept as a center and half extents, the sphere shares that center, so both tests share one dot product
+	class LveFrustumCuller {
+	public:
+		// the implementations of cull, all of them return the same objects
+		enum class Path { Scalar, Sse, Avx };
+
+		// compiled in and supported by this CPU, Scalar always is
+		static bool isSupported(Path path);
+		static Path fastestPath();
+
+		void clear();
+		void reserve(uint32_t objectCount);
+
+		// moves the model space bounds by modelMatrix and returns the index cull reports the object with
+		uint32_t add(const LveModel::Bounds& bounds, const glm::mat4& modelMatrix);
+
+		uint32_t size() const { return count; } // size
+		glm::vec3 getCenter(uint32_t object) const { return { centerX[object], centerY[object], centerZ[object] }; } // getCenter
+		float getRadius(uint32_t object) const { return radius[object]; } // getRadius
+
+		// appends the objects that intersect the frustum to visible, in the order they were added
+		void cull(const LveFrustum& frustum, std::vector<uint32_t>& visible) const { cull(frustum, visible, fastestPath()); } // cull
+		void cull(const LveFrustum& frustum, std::vector<uint32_t>& visible, Path path) const;
+
+	private:
+		// every plane with its normal's absolute value, which projects the half extents onto the normal
+		struct Plane {
+			float x, y, z, w;
+			float absX, absY, absZ;
+
+		}; // Plane
+
+		// the vector paths stop at the last whole register and return where the scalar path has to carry on
+		void cullScalar(const Plane* planes, uint32_t first, std::vector<uint32_t>& visible) const;
+		uint32_t cullSse(const Plane* planes, std::vector<uint32_t>& visible) const;
+		uint32_t cullAvx(const Plane* planes, std::vector<uint32_t>& visible) const;
+
+		uint32_t count = 0;
+		std::vector<float> centerX, centerY, centerZ;
+		std::vector<float> radius;
+		std::vector<float> extentX, extentY, extentZ;
+
+	}; // LveFrustumCuller
+
+} // lve
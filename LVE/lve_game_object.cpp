@@ -1,44 +1,51 @@
 #include "lve_game_object.hpp"
 
 namespace lve {
-	glm::mat4 TransformComponent::mat4() {
-		const float c3 = glm::cos(rotation.z);
-		const float s3 = glm::sin(rotation.z);
-		const float c2 = glm::cos(rotation.x);
-		const float s2 = glm::sin(rotation.x);
-		const float c1 = glm::cos(rotation.y);
-		const float s1 = glm::sin(rotation.y);
-		return glm::mat4{
-			{
-				scale.x * (c1 * c3 + s1 * s2 * s3),
-				scale.x * (c2 * s3),
-				scale.x * (c1 * s2 * s3 - c3 * s1),
-				0.0f,
-			},
+	void TransformComponent::setTranslation(const glm::vec3& translation) {
+		this->translation = translation;
+		cachedMatrix[3] = glm::vec4(translation, 1.f);
 
-			{
-				scale.y * (c3 * s1 * s2 - c1 * s3),
-				scale.y * (c2 * c3),
-				scale.y * (c1 * c3 * s2 + s1 * s3),
-				0.0f,
-			},
+	} // setTranslation
 
-			{
-				scale.z * (c2 * s1),
-				scale.z * (-s2),
-				scale.z * (c1 * c2),
-				0.0f,
-			},
+	void TransformComponent::setScale(const glm::vec3& scale) {
+		this->scale = scale;
+		dirty = true;
+
+	} // setScale
+
+	void TransformComponent::setRotation(const glm::vec3& rotation) {
+		this->rotation = rotation;
+		useOrientation = false;
+		dirty = true;
+
+	} // setRotation
 
-			{translation.x, translation.y, translation.z, 1.0f} 
-		
-		}; // mat4
+	void TransformComponent::setOrientation(const glm::quat& orientation) {
+		this->orientation = orientation;
+		useOrientation = true;
+		dirty = true;
+
+	} // setOrientation
+
+	const glm::mat4& TransformComponent::mat4() {
+		if (dirty)
+			build(rotationMatrix());
+
+		return cachedMatrix;
 
 	} // mat4
 
-	glm::mat3 TransformComponent::normalMatrix() {
-		
-		const glm::vec3 inverseScale = 1.0f / scale;
+	const glm::mat3& TransformComponent::normalMatrix() {
+		if (dirty)
+			build(rotationMatrix());
+
+		return cachedNormalMatrix;
+
+	} // normalMatrix
+
+	glm::mat3 TransformComponent::rotationMatrix() const {
+		if (useOrientation)
+			return glm::mat3_cast(orientation);
 
 		const float c3 = glm::cos(rotation.z);
 		const float s3 = glm::sin(rotation.z);
@@ -48,31 +55,45 @@ namespace lve {
 		const float s1 = glm::sin(rotation.y);
 		return glm::mat3{
 			{
-				inverseScale.x * (c1 * c3 + s1 * s2 * s3),
-				inverseScale.x * (c2 * s3),
-				inverseScale.x * (c1 * s2 * s3 - c3 * s1),
+				c1 * c3 + s1 * s2 * s3,
+				c2 * s3,
+				c1 * s2 * s3 - c3 * s1,
 			},
 
 			{
-				inverseScale.y * (c3 * s1 * s2 - c1 * s3),
-				inverseScale.y * (c2 * c3),
-				inverseScale.y * (c1 * c3 * s2 + s1 * s3),
+				c3 * s1 * s2 - c1 * s3,
+				c2 * c3,
+				c1 * c3 * s2 + s1 * s3,
 			},
 
 			{
-				inverseScale.z * (c2 * s1),
-				inverseScale.z * (-s2),
-				inverseScale.z * (c1 * c2),
+				c2 * s1,
+				-s2,
+				c1 * c2,
 			},
 
 		}; // mat3
 
-	} // normalMatrix
+	} // rotationMatrix
+
+	void TransformComponent::build(const glm::mat3& rotationMatrix) {
+		// the columns scale with the axes, the normal matrix is the inverse transpose, so they divide by them instead
+		const glm::vec3 inverseScale = 1.0f / scale;
+		for (int column = 0; column < 3; column++) {
+			cachedMatrix[column] = glm::vec4(rotationMatrix[column] * scale[column], 0.f);
+			cachedNormalMatrix[column] = rotationMatrix[column] * inverseScale[column];
+
+		} // for
+
+		cachedMatrix[3] = glm::vec4(translation, 1.f);
+		dirty = false;
+
+	} // build
 
 	LveGameObject LveGameObject::makePointLight(float intensity, float radius, glm::vec3 color) {
 		LveGameObject gameObj = LveGameObject::createGameObject();
 		gameObj.color = color;
-		gameObj.transform.scale.x = radius;
+		gameObj.transform.setScale({ radius, 1.f, 1.f });
 		gameObj.pointLight = std::make_unique<PointLightComponent>();
 		gameObj.pointLight->lightIntensity = intensity;
 		return gameObj;
@@ -4,6 +4,7 @@
 
 // libs
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 // std
 #include <memory>
@@ -12,16 +13,48 @@
 
 namespace lve {
 
-	struct TransformComponent {
-		glm::vec3 translation;
-		glm::vec3 scale{ 1.f, 1.f, 1.f };
-		glm::vec3 rotation;
+	// the matrices are cached behind a dirty flag, so the setters are the only way in: a static object builds them once
+	// and mat4() / normalMatrix() hand out the cached ones every frame after, LveTransformBatch rebuilds the dirty
+	// transforms of many objects in one pass
+	class TransformComponent {
+	public:
+		const glm::vec3& getTranslation() const { return translation; } // getTranslation
+		const glm::vec3& getScale() const { return scale; } // getScale
+		const glm::vec3& getRotation() const { return rotation; } // getRotation
+		const glm::quat& getOrientation() const { return orientation; } // getOrientation
+		bool hasOrientation() const { return useOrientation; } // hasOrientation
+		bool isDirty() const { return dirty; } // isDirty
+
+		// only moves the cached matrix, a translation needs no rebuild
+		void setTranslation(const glm::vec3& translation);
+		void setScale(const glm::vec3& scale);
 
-		// Matrix corrsponds to Translate * Ry * Rx * Rz * Scale
 		// Rotations correspond to Tait-bryan angles of Y(1), X(2), Z(3)
 		// https://en.wikipedia.org/wiki/Euler_angles#Rotation_matrix
-		glm::mat4 mat4();
-		glm::mat3 normalMatrix();
+		void setRotation(const glm::vec3& rotation);
+
+		// replaces the angles until the next setRotation, a unit quaternion builds the matrix without any sin or cos
+		void setOrientation(const glm::quat& orientation);
+
+		// Matrix corrsponds to Translate * Ry * Rx * Rz * Scale, or Translate * R(orientation) * Scale
+		const glm::mat4& mat4();
+		const glm::mat3& normalMatrix();
+
+	private:
+		friend class LveTransformBatch;
+
+		glm::mat3 rotationMatrix() const;
+		void build(const glm::mat3& rotationMatrix); // both caches from the unscaled rotation, clears the dirty flag
+
+		glm::vec3 translation{ 0.f };
+		glm::vec3 scale{ 1.f, 1.f, 1.f };
+		glm::vec3 rotation{ 0.f };
+		glm::quat orientation{ 1.f, 0.f, 0.f, 0.f };
+		bool useOrientation = false;
+
+		bool dirty = true;
+		glm::mat4 cachedMatrix{ 1.f };
+		glm::mat3 cachedNormalMatrix{ 1.f };
 
 	}; // TransformComponent
 
@@ -58,6 +91,7 @@ namespace lve {
 		
 		std::shared_ptr<LveModel> model{};
 		glm::vec3 color{};
+		uint32_t lod = 0; // level of detail the object was drawn with last, SimpleRenderSystem keeps it for the hysteresis
 
 		TransformComponent transform{};
 
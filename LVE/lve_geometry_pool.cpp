@@ -0,0 +1,176 @@
+#include "lve_geometry_pool.hpp"
+#include "lve_swap_chain.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace lve {
+
+	LveGeometryPool::LveGeometryPool(LveDevice& device, LveUploadQueue& uploadQueue, VkDeviceSize blockSize)
+		: lveDevice{ device }, uploadQueue{ uploadQueue },
+		ranges{
+			blockSize,
+			LveSwapChain::MAX_FRAMES_IN_FLIGHT,
+			[this](uint32_t arena, uint32_t block, uint32_t capacity) {
+				if (buffers.size() <= arena)
+					buffers.resize(arena + 1);
+
+				if (buffers[arena].size() <= block)
+					buffers[arena].resize(block + 1);
+
+				buffers[arena][block] = std::make_unique<LveBuffer>(
+					lveDevice,
+					ranges.getElementSize(arena),
+					capacity,
+					ranges.getKey(arena) | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+			},
+			[this](uint32_t arena, uint32_t block) { buffers[arena][block].reset(); }
+
+		} {} // LveGeometryPool
+
+	LveGeometryPool::~LveGeometryPool() {} // ~LveGeometryPool
+
+	LveGeometryPool::Allocation LveGeometryPool::uploadVertices(const void* vertices, uint32_t vertexSize, uint32_t vertexCount) {
+		return upload(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertices, vertexSize, vertexCount);
+
+	} // uploadVertices
+
+	LveGeometryPool::Allocation LveGeometryPool::uploadIndices(const void* indices, uint32_t indexSize, uint32_t indexCount) {
+		assert((indexSize == sizeof(uint16_t) || indexSize == sizeof(uint32_t)) && "indices are either 16 or 32 bit");
+		return upload(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indices, indexSize, indexCount);
+
+	} // uploadIndices
+
+	LveGeometryPool::Allocation LveGeometryPool::upload(VkBufferUsageFlags usage, const void* data, uint32_t elementSize, uint32_t count) {
+		// a new block gets its buffer through the callback before allocate returns
+		Allocation allocation = ranges.allocate(ranges.findArena(usage, elementSize), count);
+
+		VkDeviceSize size = static_cast<VkDeviceSize>(elementSize) * count;
+		allocation.uploadTicket = uploadQueue.uploadBuffer(getBuffer(allocation), static_cast<VkDeviceSize>(elementSize) * allocation.offset, data, size);
+
+		return allocation;
+
+	} // upload
+
+	void LveGeometryPool::free(Allocation& allocation) {
+		ranges.free(allocation);
+
+	} // free
+
+	void LveGeometryPool::retire(Allocation& allocation) {
+		ranges.retire(allocation);
+
+	} // retire
+
+	void LveGeometryPool::setOwner(Allocation& allocation, std::function<void()> relocated) {
+		ranges.setOwner(allocation, std::move(relocated));
+
+	} // setOwner
+
+	VkDeviceSize LveGeometryPool::defragment(VkCommandBuffer commandBuffer, VkDeviceSize byteBudget) {
+		// a range can only move once its upload has reached the graphics queue
+		auto moves = ranges.defragment(byteBudget, [this](const Allocation& allocation) {
+			return uploadQueue.isComplete(allocation.uploadTicket);
+		});
+
+		if (moves.empty())
+			return 0;
+
+		// every region between the same two buffers goes into one copy command
+		std::map<std::pair<VkBuffer, VkBuffer>, std::vector<VkBufferCopy>> copies;
+		VkDeviceSize moved = 0;
+
+		for (const auto& [arena, move] : moves) {
+			VkDeviceSize elementSize = ranges.getElementSize(arena);
+			VkBuffer src = buffers[arena][move.srcBlock]->getBuffer();
+			VkBuffer dst = buffers[arena][move.dstBlock]->getBuffer();
+			copies[{ src, dst }].push_back(VkBufferCopy{
+				move.srcOffset * elementSize,
+				move.dstOffset * elementSize,
+				move.size * elementSize });
+
+			moved += move.size * elementSize;
+
+		} // for
+
+		for (const auto& [endpoints, regions] : copies)
+			vkCmdCopyBuffer(commandBuffer, endpoints.first, endpoints.second, static_cast<uint32_t>(regions.size()), regions.data());
+
+		// the frame's draws read the new ranges only after the copies have landed
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			0,
+			1,
+			&barrier,
+			0,
+			nullptr,
+			0,
+			nullptr);
+
+		return moved;
+
+	} // defragment
+
+	VkBuffer LveGeometryPool::getBuffer(const Allocation& allocation) const {
+		assert(allocation.isValid() && "allocation is not from this pool");
+		return buffers[allocation.arena][allocation.block]->getBuffer();
+
+	} // getBuffer
+
+	std::vector<LveGeometryPool::ArenaStats> LveGeometryPool::getStats() const {
+		std::vector<ArenaStats> stats;
+		for (uint32_t a = 0; a < ranges.getArenaCount(); a++) {
+			ArenaStats arenaStats{};
+			arenaStats.usage = ranges.getKey(a);
+			arenaStats.elementSize = ranges.getElementSize(a);
+
+			for (const auto& block : ranges.getBlocks(a)) {
+				if (block == nullptr)
+					continue;
+
+				LveRangeAllocator::Stats blockStats = block->getStats();
+				arenaStats.blockCount++;
+				arenaStats.allocationCount += blockStats.allocationCount;
+				arenaStats.reservedBytes += blockStats.capacity * arenaStats.elementSize;
+				arenaStats.usedBytes += blockStats.used * arenaStats.elementSize;
+				arenaStats.freeRangeCount += blockStats.freeRangeCount;
+				arenaStats.largestFreeRange = std::max<VkDeviceSize>(arenaStats.largestFreeRange, blockStats.largestFreeRange * arenaStats.elementSize);
+
+			} // for
+
+			stats.push_back(arenaStats);
+
+		} // for
+
+		return stats;
+
+	} // getStats
+
+	void LveGeometryPool::printReport(std::ostream& out) const {
+		for (const auto& arena : getStats()) {
+			out << "Geometry pool " << (arena.usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT ? "index" : "vertex") << " x" << arena.elementSize
+				<< ": " << arena.allocationCount << " ranges in " << arena.blockCount << " blocks, "
+				<< arena.usedBytes / 1024 << " / " << arena.reservedBytes / 1024 << " KiB used, "
+				<< arena.freeRangeCount << " free ranges, largest " << arena.largestFreeRange / 1024 << " KiB, fragmentation "
+				<< arena.fragmentation() * 100.f << "%\n";
+
+		} // for
+
+		out << "Geometry pool defragmentation: " << getDefragmentStats().moveCount << " ranges moved, " << getDefragmentStats().movedBytes / 1024
+			<< " KiB copied, " << getDefragmentStats().releasedBlocks << " blocks released\n";
+
+	} // printReport
+
+} // lve
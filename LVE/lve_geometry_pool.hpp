@@ -0,0 +1,105 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+#include "lve_range_pool.hpp"
+#include "lve_upload_queue.hpp"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace lve {
+
+	// every model's vertices and indices sub-allocated out of a few large device local buffers, one set of buffers
+	// per vertex stride and index type, so consecutive draws of different models need no rebinding
+	class LveGeometryPool {
+	public:
+		static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 16 * 1024 * 1024;
+		static constexpr VkDeviceSize DEFAULT_DEFRAGMENT_BUDGET = 2 * 1024 * 1024;
+
+		// a range of one of the pool's buffers, offset and count are in elements so they go straight into vkCmdDrawIndexed,
+		// uploadTicket is the upload batch carrying the data
+		using Allocation = LveRangePool::Allocation;
+
+		// what has to be bound to draw an allocation, equal bindings can be drawn back to back
+		struct Binding {
+			VkBuffer vertexBuffer = VK_NULL_HANDLE;
+			VkBuffer indexBuffer = VK_NULL_HANDLE;
+			VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
+			bool operator==(const Binding& other) const = default;
+
+		}; // Binding
+
+		// one line of the fragmentation report, sizes in bytes
+		struct ArenaStats {
+			VkBufferUsageFlags usage = 0;
+			uint32_t elementSize = 0;
+			uint32_t blockCount = 0;
+			uint64_t allocationCount = 0;
+			VkDeviceSize reservedBytes = 0;
+			VkDeviceSize usedBytes = 0;
+			uint64_t freeRangeCount = 0;
+			VkDeviceSize largestFreeRange = 0;
+
+			float fragmentation() const {
+				VkDeviceSize free = reservedBytes - usedBytes;
+				return free == 0 ? 0.f : 1.f - static_cast<float>(largestFreeRange) / static_cast<float>(free);
+
+			} // fragmentation
+
+		}; // ArenaStats
+
+		using DefragmentStats = LveRangePool::DefragmentStats;
+
+		LveGeometryPool(LveDevice& device, LveUploadQueue& uploadQueue, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+		~LveGeometryPool();
+
+		LveGeometryPool(const LveGeometryPool&) = delete;
+		LveGeometryPool& operator=(const LveGeometryPool&) = delete;
+
+		// queues a copy of the elements into a free range, adding a block when none has room, the range can be
+		// drawn from once isResident says so
+		Allocation uploadVertices(const void* vertices, uint32_t vertexSize, uint32_t vertexCount);
+		Allocation uploadIndices(const void* indices, uint32_t indexSize, uint32_t indexCount);
+
+		// the upload has finished and belongs to the graphics queue, uploads can take a few frames on a transfer queue
+		bool isResident(const Allocation& allocation) { return !allocation.isValid() || uploadQueue.isComplete(allocation.uploadTicket); } // isResident
+
+		// the range can be reused right away, the caller makes sure no submitted frame still reads from it
+		void free(Allocation& allocation);
+
+		// the range is reused once the frames in flight that may still draw from it are done, counted in defragment calls
+		void retire(Allocation& allocation);
+
+		// lets defragment move the range: the handle is patched in place and relocated is called after it, so the handle
+		// has to stay at the same address until it is freed, ranges without an owner are never moved
+		void setOwner(Allocation& allocation, std::function<void()> relocated = {});
+
+		// moves up to byteBudget of live ranges out of the emptiest blocks so they can be released, call once per frame
+		// with the frame's command buffer before any render pass, the copies are ordered before the frame's vertex
+		// input, so the owners draw from the new ranges right away and the old ones are freed once the frames in
+		// flight that may still read them are done, returns the bytes moved
+		VkDeviceSize defragment(VkCommandBuffer commandBuffer, VkDeviceSize byteBudget = DEFAULT_DEFRAGMENT_BUDGET);
+
+		VkBuffer getBuffer(const Allocation& allocation) const;
+
+		std::vector<ArenaStats> getStats() const;
+		const DefragmentStats& getDefragmentStats() const { return ranges.getDefragmentStats(); } // getDefragmentStats
+		void printReport(std::ostream& out) const;
+
+	private:
+		Allocation upload(VkBufferUsageFlags usage, const void* data, uint32_t elementSize, uint32_t count);
+
+		LveDevice& lveDevice;
+		LveUploadQueue& uploadQueue;
+		LveRangePool ranges; // which ranges are in use, the blocks are indexed the same as buffers
+		std::vector<std::vector<std::unique_ptr<LveBuffer>>> buffers; // per arena, per block, null for released blocks
+
+	}; // LveGeometryPool
+
+} // lve
@@ -0,0 +1,312 @@
+#include "lve_gpu_culling.hpp"
+#include "lve_frustum.hpp"
+#include "lve_swap_chain.hpp"
+
+// std
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+	namespace {
+
+		// std430 layout of the push constants in cull.comp, exactly the 128 bytes every device supports
+		struct CullPushConstants {
+			glm::vec4 planes[6]{}; // world space, normalized
+			glm::vec4 camera{}; // xyz position, w projection[1][1]
+			uint32_t objectCount = 0;
+			uint32_t perspective = 0;
+			uint32_t padding[2]{};
+
+		}; // CullPushConstants
+
+		static_assert(sizeof(CullPushConstants) == 128, "push constants have to fit the guaranteed minimum");
+
+		constexpr uint32_t INITIAL_OBJECT_CAPACITY = 256;
+		constexpr uint32_t INITIAL_BATCH_CAPACITY = 16;
+
+		enum Binding : uint32_t { OBJECTS, INSTANCES, BATCHES, COMMANDS, COUNTS, BINDING_COUNT };
+
+	} // namespace
+
+	LveGpuCulling::LveGpuCulling(
+		LveDevice& device,
+		const std::vector<LveDynamicBuffer*>& instanceBuffers,
+		const std::array<float, LveModel::MAX_LODS - 1>& lodScreenSizes) : lveDevice{ device } {
+		uint32_t frameCount = static_cast<uint32_t>(instanceBuffers.size());
+
+		descriptorPool = LveDescriptorPool::Builder(lveDevice)
+			.setMaxSets(frameCount)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, frameCount * BINDING_COUNT)
+			.build();
+
+		auto builder = LveDescriptorSetLayout::Builder(lveDevice);
+		for (uint32_t binding = 0; binding < BINDING_COUNT; binding++)
+			builder.addBinding(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+
+		setLayout = builder.build();
+
+		createPipelineLayout();
+		createPipeline(lodScreenSizes);
+
+		VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+		for (uint32_t i = 0; i < frameCount; i++) {
+			Frame frame{};
+			frame.objects = std::make_unique<LveDynamicBuffer>(lveDevice, sizeof(Object), INITIAL_OBJECT_CAPACITY, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible);
+			frame.batches = std::make_unique<LveDynamicBuffer>(lveDevice, sizeof(uint32_t), INITIAL_BATCH_CAPACITY, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostVisible);
+
+			// only the GPU touches the commands, the counts are read back for readVisibleCount
+			frame.commands = std::make_unique<LveDynamicBuffer>(
+				lveDevice,
+				sizeof(VkDrawIndexedIndirectCommand),
+				INITIAL_OBJECT_CAPACITY,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			frame.counts = std::make_unique<LveDynamicBuffer>(
+				lveDevice,
+				sizeof(uint32_t),
+				INITIAL_BATCH_CAPACITY,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				hostVisible);
+			frame.instances = instanceBuffers[i];
+
+			LveDynamicBuffer* buffers[BINDING_COUNT] = { frame.objects.get(), frame.instances, frame.batches.get(), frame.commands.get(), frame.counts.get() };
+			VkDescriptorBufferInfo bufferInfos[BINDING_COUNT];
+			LveDescriptorWriter writer{ *setLayout, *descriptorPool };
+			for (uint32_t binding = 0; binding < BINDING_COUNT; binding++) {
+				bufferInfos[binding] = buffers[binding]->buffer().descriptorInfo();
+				writer.writeBuffer(binding, &bufferInfos[binding]);
+
+			} // for
+
+			if (!writer.build(frame.descriptorSet))
+				throw std::runtime_error("failed to allocate culling descriptor set!");
+
+			// growing any of them points this frame's set at the new buffer
+			for (uint32_t binding = 0; binding < BINDING_COUNT; binding++)
+				buffers[binding]->addDescriptor(frame.descriptorSet, binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, static_cast<int>(i));
+
+			frames.push_back(std::move(frame));
+
+		} // for
+
+	} // LveGpuCulling
+
+	LveGpuCulling::~LveGpuCulling() {
+		for (auto& frame : frames)
+			frame.instances->removeDescriptor(frame.descriptorSet, INSTANCES);
+
+		vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, nullptr);
+
+	} // ~LveGpuCulling
+
+	void LveGpuCulling::createPipelineLayout() {
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(CullPushConstants);
+
+		VkDescriptorSetLayout descriptorSetLayout = setLayout->getDescriptorSetLayout();
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline layout!");
+
+		} // if
+
+	} // createPipelineLayout
+
+	void LveGpuCulling::createPipeline(const std::array<float, LveModel::MAX_LODS - 1>& lodScreenSizes) {
+		// constant_id k = LOD_SCREEN_SIZE_k
+		VkSpecializationMapEntry specializationEntries[LveModel::MAX_LODS - 1];
+		for (uint32_t k = 0; k < LveModel::MAX_LODS - 1; k++)
+			specializationEntries[k] = { k, static_cast<uint32_t>(k * sizeof(float)), sizeof(float) };
+
+		VkSpecializationInfo specializationInfo{ LveModel::MAX_LODS - 1, specializationEntries, sizeof(lodScreenSizes), lodScreenSizes.data() };
+
+		cullPipeline = std::make_unique<LveComputePipeline>(
+			lveDevice,
+			"C:\\Users\\suraj\\OneDrive\\Documents\\Visual Studio Projects\\Little Vulkan Game Engine\\cull.comp.spv",
+			pipelineLayout,
+			&specializationInfo);
+
+	} // createPipeline
+
+	LveGpuCulling::Object LveGpuCulling::makeObject(const LveModel& model, uint32_t batch) {
+		// the instance's model matrix already contains the dequantization, so the sphere is moved into vertex buffer
+		// space and the columns' lengths are scaled back to model space for the radius
+		const glm::mat4& dequantization = model.getDequantizationMatrix();
+
+		Object object{};
+		object.boundingSphere = glm::vec4(glm::vec3(glm::inverse(dequantization) * glm::vec4(model.getBoundingCenter(), 1.f)), model.getBoundingRadius());
+		for (int axis = 0; axis < 3; axis++)
+			object.axisScale[axis] = 1.f / glm::length(glm::vec3(dequantization[axis]));
+
+		object.batch = batch;
+		object.lodCount = model.hasIndices() ? model.getLodCount() : 0;
+		for (uint32_t lod = 0; lod < object.lodCount; lod++) {
+			VkDrawIndexedIndirectCommand command = model.getDrawCommand(lod);
+			object.lodFirstIndex[lod] = command.firstIndex;
+			object.lodIndexCount[lod] = command.indexCount;
+			object.vertexOffset = command.vertexOffset;
+
+		} // for
+
+		return object;
+
+	} // makeObject
+
+	void LveGpuCulling::cull(
+		VkCommandBuffer commandBuffer,
+		int frameIndex,
+		const LveCamera& camera,
+		const std::vector<Object>& objects,
+		const std::vector<uint32_t>& batchFirstObjects) {
+		Frame& frame = frames[frameIndex];
+		frame.objects->beginFrame(frameIndex);
+		frame.batches->beginFrame(frameIndex);
+		frame.commands->beginFrame(frameIndex);
+		frame.counts->beginFrame(frameIndex);
+
+		frame.batchFirstObjects = batchFirstObjects;
+		frame.objectCount = static_cast<uint32_t>(objects.size());
+		uint32_t objectCount = frame.objectCount;
+		uint32_t batchCount = static_cast<uint32_t>(batchFirstObjects.size());
+		if (objectCount == 0 || batchCount == 0)
+			return;
+
+		// a batch's commands start at the index of its first object, so its region holds every object of the batch
+		frame.objects->reserve(objectCount);
+		std::memcpy(frame.objects->getMappedMemory(), objects.data(), objectCount * sizeof(Object));
+		frame.objects->buffer().flush(objectCount * sizeof(Object), 0);
+
+		frame.batches->reserve(batchCount);
+		std::memcpy(frame.batches->getMappedMemory(), batchFirstObjects.data(), batchCount * sizeof(uint32_t));
+		frame.batches->buffer().flush(batchCount * sizeof(uint32_t), 0);
+
+		frame.commands->reserve(objectCount, commandBuffer);
+		frame.counts->reserve(batchCount);
+
+		// the counters start at zero, the atomics of the pass count up from there
+		vkCmdFillBuffer(commandBuffer, frame.counts->getBuffer(), 0, batchCount * sizeof(uint32_t), 0);
+
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0,
+			1,
+			&barrier,
+			0,
+			nullptr,
+			0,
+			nullptr);
+
+		const glm::mat4& projection = camera.getProjection();
+		LveFrustum frustum = LveFrustum::fromMatrix(projection * camera.getView());
+
+		CullPushConstants push{};
+		for (int p = 0; p < 6; p++)
+			push.planes[p] = frustum.getPlanes()[p];
+
+		push.camera = glm::vec4(camera.getPosition(), projection[1][1]);
+		push.objectCount = objectCount;
+		push.perspective = projection[2][3] != 0.f;
+
+		cullPipeline->bind(commandBuffer);
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+		vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &push);
+		vkCmdDispatch(commandBuffer, (objectCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+		// the draws read the records and counts, the host reads the counts after the fence
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+			0,
+			1,
+			&barrier,
+			0,
+			nullptr,
+			0,
+			nullptr);
+
+	} // cull
+
+	void LveGpuCulling::drawBatch(VkCommandBuffer commandBuffer, int frameIndex, uint32_t batch, uint32_t maxDrawCount) {
+		Frame& frame = frames[frameIndex];
+		constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+
+		lveDevice.drawIndexedIndirectCount()(
+			commandBuffer,
+			frame.commands->getBuffer(),
+			static_cast<VkDeviceSize>(frame.batchFirstObjects[batch]) * stride,
+			frame.counts->getBuffer(),
+			batch * sizeof(uint32_t),
+			maxDrawCount,
+			stride);
+
+	} // drawBatch
+
+	uint32_t LveGpuCulling::readVisibleCount(int frameIndex) {
+		Frame& frame = frames[frameIndex];
+		if (frame.batchFirstObjects.empty())
+			return 0;
+
+		frame.counts->buffer().invalidate();
+		const auto* counts = static_cast<const uint32_t*>(frame.counts->getMappedMemory());
+
+		uint32_t visible = 0;
+		for (size_t b = 0; b < frame.batchFirstObjects.size(); b++)
+			visible += counts[b];
+
+		return visible;
+
+	} // readVisibleCount
+
+	void LveGpuCulling::readBack(int frameIndex, std::vector<uint32_t>& drawCounts, std::vector<VkDrawIndexedIndirectCommand>& commands) {
+		Frame& frame = frames[frameIndex];
+		uint32_t batchCount = static_cast<uint32_t>(frame.batchFirstObjects.size());
+		drawCounts.assign(batchCount, 0);
+		commands.assign(frame.objectCount, VkDrawIndexedIndirectCommand{});
+		if (batchCount == 0 || frame.objectCount == 0)
+			return;
+
+		frame.counts->buffer().invalidate();
+		std::memcpy(drawCounts.data(), frame.counts->getMappedMemory(), batchCount * sizeof(uint32_t));
+
+		VkDeviceSize size = frame.objectCount * sizeof(VkDrawIndexedIndirectCommand);
+		LveBuffer staging{ lveDevice, sizeof(VkDrawIndexedIndirectCommand), frame.objectCount, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+
+		VkCommandBuffer commandBuffer = lveDevice.beginSingleTimeCommands();
+
+		VkBufferCopy region{ 0, 0, size };
+		vkCmdCopyBuffer(commandBuffer, frame.commands->getBuffer(), staging.getBuffer(), 1, &region);
+
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+		lveDevice.endSingleTimeCommands(commandBuffer);
+
+		staging.map();
+		staging.invalidate();
+		std::memcpy(commands.data(), staging.getMappedMemory(), size);
+
+	} // readBack
+
+} // lve
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_dynamic_buffer.hpp"
+#include "lve_compute_pipeline.hpp"
+#include "lve_descriptors.hpp"
+#include "lve_camera.hpp"
+#include "lve_model.hpp"
+
+// libs
+#define GLM_FORCE_RADIANS // forces in radians and not degrees
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE // Vulkan uses 0 to 1, openGL uses 1 to 1
+#include <glm/glm.hpp>
+
+// std
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lve {
+
+	// frustum culling and level of detail selection in a compute pass (cull.comp): every object's bounding sphere is
+	// moved by the model matrix of its LveModel::Instance, tested against the camera's frustum and the survivors append
+	// a VkDrawIndexedIndirectCommand to the region of their batch with an atomic counter, a batch is then drawn with
+	// vkCmdDrawIndexedIndirectCount, the CPU never looks at the objects' positions
+	// needs multiDrawIndirect, drawIndirectFirstInstance and VK_KHR_draw_indirect_count, all of which software
+	// implementations like lavapipe expose, nothing else beyond Vulkan 1.1 compute
+	// known gaps against the CPU path of SimpleRenderSystem, the gpu-culling benchmark reports the first two:
+	// - every survivor is a command with instanceCount 1, objects of one model and level are not compacted into one
+	//   instanced draw, so a batch costs as many draws as it has visible objects
+	// - the commands come in the order the atomic counter hands out the slots, the front to back order LveRenderQueue
+	//   gave the instances is lost within a batch
+	// - the level is picked from this frame's size alone, without the 10% hysteresis of SimpleRenderSystem::selectLod,
+	//   so an object sitting on a threshold can switch levels every frame
+	class LveGpuCulling {
+	public:
+		static constexpr uint32_t WORKGROUP_SIZE = 64; // local_size_x of cull.comp
+
+		// per object at the index of its LveModel::Instance, std430 layout of CullObject in cull.comp
+		struct Object {
+			glm::vec4 boundingSphere{}; // center in vertex buffer space, radius in model space
+			glm::vec4 axisScale{ 1.f }; // undoes the dequantization of compact vertices when scaling the radius, xyz
+			uint32_t batch = 0;
+			int32_t vertexOffset = 0;
+			uint32_t lodCount = 0; // 0 = never drawn by the culling pass
+			uint32_t padding = 0;
+			glm::uvec4 lodFirstIndex{}; // absolute in the index buffer
+			glm::uvec4 lodIndexCount{};
+
+		}; // Object
+
+		static_assert(LveModel::MAX_LODS == 4, "Object holds the lods in uvec4s");
+
+		static bool isSupported(LveDevice& device) { return device.hasMultiDrawIndirect() && device.drawIndexedIndirectCount() != nullptr; } // isSupported
+
+		// instanceBuffers are the per frame in flight buffers of LveModel::Instance the objects index into, they need
+		// storage buffer usage and have to outlive this, level k + 1 replaces level k below lodScreenSizes[k] of the
+		// screen height like SimpleRenderSystem::selectLod, without its hysteresis since nothing is kept between frames
+		LveGpuCulling(
+			LveDevice& device,
+			const std::vector<LveDynamicBuffer*>& instanceBuffers,
+			const std::array<float, LveModel::MAX_LODS - 1>& lodScreenSizes);
+		~LveGpuCulling();
+
+		LveGpuCulling(const LveGpuCulling&) = delete;
+		LveGpuCulling& operator=(const LveGpuCulling&) = delete;
+
+		// fills an Object from a model, the lods and draw ranges never change for a resident model
+		static Object makeObject(const LveModel& model, uint32_t batch);
+
+		// records the culling pass, outside of a render pass and after the instances of this frame are written,
+		// batchFirstObjects[b] is the first object of batch b, the objects have to be sorted by batch so the region of
+		// a batch in the command buffer can hold all of its objects
+		void cull(
+			VkCommandBuffer commandBuffer,
+			int frameIndex,
+			const LveCamera& camera,
+			const std::vector<Object>& objects,
+			const std::vector<uint32_t>& batchFirstObjects);
+
+		// draws the survivors of batch in the render pass, maxDrawCount is the number of objects in the batch
+		void drawBatch(VkCommandBuffer commandBuffer, int frameIndex, uint32_t batch, uint32_t maxDrawCount);
+
+		// the draw counts the last cull of frameIndex wrote, valid once that frame's fence has signalled, so right after
+		// the renderer's beginFrame for the same index
+		uint32_t readVisibleCount(int frameIndex);
+
+		// the draw count of every batch and all the command slots the last cull of frameIndex filled, a batch's commands
+		// start at its first object in the order the pass appended them, copies the commands out of device local memory
+		// and waits for that, so it is for checking the pass rather than for every frame
+		void readBack(int frameIndex, std::vector<uint32_t>& drawCounts, std::vector<VkDrawIndexedIndirectCommand>& commands);
+
+	private:
+		struct Frame {
+			std::unique_ptr<LveDynamicBuffer> objects;
+			std::unique_ptr<LveDynamicBuffer> batches; // first command of each batch
+			std::unique_ptr<LveDynamicBuffer> commands;
+			std::unique_ptr<LveDynamicBuffer> counts;
+			LveDynamicBuffer* instances;
+			VkDescriptorSet descriptorSet;
+			std::vector<uint32_t> batchFirstObjects; // of the last cull
+			uint32_t objectCount = 0; // of the last cull
+
+		}; // Frame
+
+		void createPipelineLayout();
+		void createPipeline(const std::array<float, LveModel::MAX_LODS - 1>& lodScreenSizes);
+
+		LveDevice& lveDevice;
+		std::unique_ptr<LveDescriptorPool> descriptorPool;
+		std::unique_ptr<LveDescriptorSetLayout> setLayout;
+		VkPipelineLayout pipelineLayout;
+		std::unique_ptr<LveComputePipeline> cullPipeline;
+		std::vector<Frame> frames;
+
+	}; // LveGpuCulling
+
+} // lve
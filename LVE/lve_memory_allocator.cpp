@@ -0,0 +1,432 @@
+#include "lve_memory_allocator.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+
+	namespace {
+
+		VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+			return (value + alignment - 1) & ~(alignment - 1);
+
+		} // alignUp
+
+		// small heaps (integrated GPUs, the 256 MiB BAR heap) get smaller blocks so one block cannot take most of the heap
+		constexpr VkDeviceSize SMALL_HEAP_SIZE = 1024ull * 1024 * 1024;
+
+		constexpr VkDeviceSize MiB = 1024 * 1024;
+
+	} // namespace
+
+	const char* memoryCategoryName(LveMemoryCategory category) {
+		switch (category) {
+		case LveMemoryCategory::Vertex: return "vertex";
+		case LveMemoryCategory::Index: return "index";
+		case LveMemoryCategory::Uniform: return "uniform";
+		case LveMemoryCategory::Staging: return "staging";
+		case LveMemoryCategory::Depth: return "depth";
+		case LveMemoryCategory::Texture: return "texture";
+		default: return "other";
+
+		} // switch
+
+	} // memoryCategoryName
+
+	LveMemoryCategory bufferMemoryCategory(VkBufferUsageFlags usage) {
+		// the transfer bits only say how the buffer is filled, the rest says what it is for
+		VkBufferUsageFlags purpose = usage & ~(VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		if (purpose == 0)
+			return usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT ? LveMemoryCategory::Staging : LveMemoryCategory::Other;
+		if (purpose == VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+			return LveMemoryCategory::Vertex;
+		if (purpose == VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+			return LveMemoryCategory::Index;
+		if (purpose == VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+			return LveMemoryCategory::Uniform;
+
+		return LveMemoryCategory::Other;
+
+	} // bufferMemoryCategory
+
+	LveMemoryCategory imageMemoryCategory(VkImageUsageFlags usage) {
+		if (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+			return LveMemoryCategory::Depth;
+		if (usage & VK_IMAGE_USAGE_SAMPLED_BIT)
+			return LveMemoryCategory::Texture;
+
+		return LveMemoryCategory::Other;
+
+	} // imageMemoryCategory
+
+	LveMemoryAllocator::LveMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, bool memoryBudget, VkDeviceSize blockSize)
+		: device{ device }, physicalDevice{ physicalDevice }, memoryBudget{ memoryBudget }, blockSize{ blockSize } {
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+		VkPhysicalDeviceProperties properties{};
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		nonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+
+	} // LveMemoryAllocator
+
+	LveMemoryAllocator::~LveMemoryAllocator() {
+		Stats stats = getStats();
+		if (stats.allocationCount > 0)
+			std::cerr << "LveMemoryAllocator destroyed with " << stats.allocationCount << " live allocations\n";
+
+		for (auto& pool : pools) {
+			for (auto& block : pool.blocks) {
+				if (block != nullptr)
+					freeDeviceMemory(block->memory, pool.memoryType, pool.blockSize, block->mapped);
+
+			} // for
+
+		} // for
+
+	} // ~LveMemoryAllocator
+
+	LveMemoryAllocation LveMemoryAllocator::allocate(
+		const VkMemoryRequirements& requirements,
+		VkMemoryPropertyFlags properties,
+		bool linear,
+		LveMemoryCategory category) {
+		std::lock_guard<std::mutex> lock{ mutex };
+
+		LveMemoryAllocation allocation{};
+		allocation.memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+		allocation.category = category;
+
+		// flushes of non-coherent memory work in whole atoms, so allocations start and end on one
+		VkDeviceSize atom = atomAlignment(allocation.memoryType);
+		VkDeviceSize alignment = std::max(requirements.alignment, atom);
+		allocation.size = alignUp(requirements.size, atom);
+
+		uint32_t poolIndex = findPool(allocation.memoryType, linear);
+		Pool& pool = pools[poolIndex];
+
+		// counted only once the memory exists, allocateDeviceMemory throws when the driver runs out and the stats and
+		// the budget check must not keep an allocation that never happened
+		auto countAllocation = [&]() {
+			CategoryStats& categoryStats = categories[static_cast<size_t>(category)];
+			categoryStats.allocationCount++;
+			categoryStats.bytes += allocation.size;
+			heapUsed[memoryProperties.memoryTypes[allocation.memoryType].heapIndex] += allocation.size;
+
+		}; // countAllocation
+
+		// big resources get their own VkDeviceMemory, inside a block they would mostly waste space
+		if (allocation.size > pool.blockSize / 2) {
+			allocation.memory = allocateDeviceMemory(allocation.size, allocation.memoryType, &allocation.mapped);
+			dedicatedCount++;
+			dedicatedBytes += allocation.size;
+			countAllocation();
+			return allocation;
+
+		} // if
+
+		uint64_t offset = LveRangeAllocator::NO_SPACE;
+		for (uint32_t b = 0; b < pool.blocks.size() && offset == LveRangeAllocator::NO_SPACE; b++) {
+			if (pool.blocks[b] == nullptr)
+				continue;
+
+			offset = pool.blocks[b]->allocator.allocate(allocation.size, alignment);
+			allocation.block = b;
+
+		} // for
+
+		if (offset == LveRangeAllocator::NO_SPACE) {
+			auto block = std::make_unique<Block>(Block{ VK_NULL_HANDLE, nullptr, LveRangeAllocator{ pool.blockSize } });
+			block->memory = allocateDeviceMemory(pool.blockSize, allocation.memoryType, &block->mapped);
+
+			auto slot = std::find(pool.blocks.begin(), pool.blocks.end(), nullptr);
+			allocation.block = static_cast<uint32_t>(slot - pool.blocks.begin());
+			if (slot == pool.blocks.end())
+				pool.blocks.push_back(std::move(block));
+			else
+				*slot = std::move(block);
+
+			offset = pool.blocks[allocation.block]->allocator.allocate(allocation.size, alignment);
+
+		} // if
+
+		const Block& block = *pool.blocks[allocation.block];
+		allocation.pool = poolIndex;
+		allocation.memory = block.memory;
+		allocation.offset = offset;
+		allocation.mapped = block.mapped != nullptr ? static_cast<char*>(block.mapped) + offset : nullptr;
+		countAllocation();
+		return allocation;
+
+	} // allocate
+
+	void LveMemoryAllocator::free(LveMemoryAllocation& allocation) {
+		if (allocation.memory == VK_NULL_HANDLE)
+			return;
+
+		std::lock_guard<std::mutex> lock{ mutex };
+
+		CategoryStats& categoryStats = categories[static_cast<size_t>(allocation.category)];
+		categoryStats.allocationCount--;
+		categoryStats.bytes -= allocation.size;
+		heapUsed[memoryProperties.memoryTypes[allocation.memoryType].heapIndex] -= allocation.size;
+
+		if (allocation.isDedicated()) {
+			freeDeviceMemory(allocation.memory, allocation.memoryType, allocation.size, allocation.mapped);
+			dedicatedCount--;
+			dedicatedBytes -= allocation.size;
+
+		} // if
+		else {
+			Pool& pool = pools[allocation.pool];
+			auto& block = pool.blocks[allocation.block];
+			block->allocator.free(allocation.offset);
+
+			// an empty block is given back to the driver unless it is the last one of its pool
+			auto live = std::count_if(pool.blocks.begin(), pool.blocks.end(), [](const auto& b) { return b != nullptr; });
+			if (block->allocator.isEmpty() && live > 1) {
+				freeDeviceMemory(block->memory, pool.memoryType, pool.blockSize, block->mapped);
+				block.reset();
+
+			} // if
+
+		} // else
+
+		allocation = LveMemoryAllocation{};
+
+	} // free
+
+	VkMappedMemoryRange LveMemoryAllocator::mappedRange(const LveMemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const {
+		VkDeviceSize atom = atomAlignment(allocation.memoryType);
+		VkDeviceSize end = size == VK_WHOLE_SIZE ? allocation.size : std::min(offset + size, allocation.size);
+		VkDeviceSize start = offset & ~(atom - 1);
+		end = std::min(alignUp(end, atom), allocation.size);
+
+		VkMappedMemoryRange range{};
+		range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.memory = allocation.memory;
+		range.offset = allocation.offset + start;
+		range.size = end - start;
+		return range;
+
+	} // mappedRange
+
+	uint32_t LveMemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+			if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+				return i;
+
+		} // for
+
+		throw std::runtime_error("failed to find suitable memory type!");
+
+	} // findMemoryType
+
+	LveMemoryAllocator::Stats LveMemoryAllocator::getStats() const {
+		std::lock_guard<std::mutex> lock{ mutex };
+
+		Stats stats{};
+		for (const auto& pool : pools) {
+			for (const auto& block : pool.blocks) {
+				if (block == nullptr)
+					continue;
+
+				LveRangeAllocator::Stats blockStats = block->allocator.getStats();
+				stats.blockCount++;
+				stats.allocationCount += blockStats.allocationCount;
+				stats.usedBytes += blockStats.used;
+				stats.reservedBytes += blockStats.capacity;
+
+			} // for
+
+		} // for
+
+		stats.dedicatedCount = dedicatedCount;
+		stats.allocationCount += dedicatedCount;
+		stats.deviceMemoryCount = stats.blockCount + dedicatedCount;
+		stats.usedBytes += dedicatedBytes;
+		stats.reservedBytes += dedicatedBytes;
+		return stats;
+
+	} // getStats
+
+	void LveMemoryAllocator::printStats(std::ostream& out) const {
+		Stats stats = getStats();
+		out << "Device memory: " << stats.allocationCount << " allocations in " << stats.blockCount << " blocks and "
+			<< stats.dedicatedCount << " dedicated (" << stats.deviceMemoryCount << " VkDeviceMemory), "
+			<< stats.usedBytes / 1024 << " / " << stats.reservedBytes / 1024 << " KiB used\n";
+
+	} // printStats
+
+	std::vector<LveMemoryAllocator::HeapBudget> LveMemoryAllocator::getHeapBudgets() const {
+		std::lock_guard<std::mutex> lock{ mutex };
+
+		std::vector<HeapBudget> budgets;
+		queryHeapBudgets(budgets);
+		return budgets;
+
+	} // getHeapBudgets
+
+	std::array<LveMemoryAllocator::CategoryStats, static_cast<size_t>(LveMemoryCategory::Count)> LveMemoryAllocator::getCategoryStats() const {
+		std::lock_guard<std::mutex> lock{ mutex };
+		return categories;
+
+	} // getCategoryStats
+
+	void LveMemoryAllocator::printBudget(std::ostream& out) const {
+		std::vector<HeapBudget> budgets = getHeapBudgets();
+		auto categoryStats = getCategoryStats();
+
+		out << "Memory budget" << (memoryBudget ? "" : " (estimated)") << ":";
+		const char* separator = " ";
+		for (uint32_t h = 0; h < budgets.size(); h++) {
+			const HeapBudget& heap = budgets[h];
+			if (heap.reservedBytes == 0 && heap.usage == 0)
+				continue;
+
+			const char* warning = heap.usage > heap.budget ? ", OVER BUDGET" : heap.usage > heap.budget * BUDGET_WARNING_RATIO ? ", NEAR BUDGET" : "";
+			out << separator << "heap " << h << (heap.deviceLocal ? " (device local) " : " ") << heap.usage / MiB << " / "
+				<< heap.budget / MiB << " MiB (" << (heap.budget > 0 ? heap.usage * 100 / heap.budget : 0) << "%" << warning << ")";
+			separator = ", ";
+
+		} // for
+
+		out << " | in use:";
+		for (size_t c = 0; c < categoryStats.size(); c++) {
+			if (categoryStats[c].allocationCount == 0)
+				continue;
+
+			out << " " << memoryCategoryName(static_cast<LveMemoryCategory>(c)) << " " << categoryStats[c].bytes / 1024
+				<< " KiB (" << categoryStats[c].allocationCount << ")";
+
+		} // for
+
+		out << "\n";
+
+	} // printBudget
+
+	void LveMemoryAllocator::queryHeapBudgets(std::vector<HeapBudget>& budgets) const {
+		VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+		budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+		if (memoryBudget) {
+			VkPhysicalDeviceMemoryProperties2 properties{};
+			properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+			properties.pNext = &budgetProperties;
+			vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties);
+
+		} // if
+
+		budgets.assign(memoryProperties.memoryHeapCount, HeapBudget{});
+		for (uint32_t h = 0; h < memoryProperties.memoryHeapCount; h++) {
+			HeapBudget& heap = budgets[h];
+			heap.heapSize = memoryProperties.memoryHeaps[h].size;
+			heap.deviceLocal = (memoryProperties.memoryHeaps[h].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+			heap.reservedBytes = heapReserved[h];
+			heap.usedBytes = heapUsed[h];
+
+			// a driver may leave the budget of a heap at zero, then it is as good as not having the extension
+			if (memoryBudget && budgetProperties.heapBudget[h] > 0) {
+				heap.budget = budgetProperties.heapBudget[h];
+				heap.usage = budgetProperties.heapUsage[h];
+
+			} // if
+			else {
+				heap.budget = static_cast<VkDeviceSize>(heap.heapSize * FALLBACK_BUDGET_RATIO);
+				heap.usage = heapReserved[h];
+
+			} // else
+
+		} // for
+
+	} // queryHeapBudgets
+
+	void LveMemoryAllocator::warnIfOverBudget(uint32_t heap, VkDeviceSize size) {
+		std::vector<HeapBudget> budgets;
+		queryHeapBudgets(budgets);
+
+		const HeapBudget& budget = budgets[heap];
+		VkDeviceSize after = budget.usage + size;
+		uint8_t level = after > budget.budget ? 2 : after > budget.budget * BUDGET_WARNING_RATIO ? 1 : 0;
+
+		// once per crossing, a heap sitting near its budget would otherwise warn on every new block
+		if (level > heapWarningLevel[heap]) {
+			std::cerr << "LveMemoryAllocator: heap " << heap << (level == 2 ? " goes over" : " is close to") << " its budget, "
+				<< after / MiB << " / " << budget.budget / MiB << " MiB after allocating " << size / MiB << " MiB"
+				<< (level == 2 ? ", expect the driver to page memory out" : "") << "\n";
+
+		} // if
+
+		heapWarningLevel[heap] = level;
+
+	} // warnIfOverBudget
+
+	VkDeviceMemory LveMemoryAllocator::allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, void** mapped) {
+		uint32_t heap = memoryProperties.memoryTypes[memoryType].heapIndex;
+		warnIfOverBudget(heap, size);
+
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = size;
+		allocInfo.memoryTypeIndex = memoryType;
+
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+			throw std::runtime_error("failed to allocate device memory!");
+
+		// a VkDeviceMemory can only be mapped once, so blocks shared by many buffers are mapped up front
+		*mapped = nullptr;
+		if (isHostVisible(memoryType) && vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS) {
+			vkFreeMemory(device, memory, nullptr);
+			throw std::runtime_error("failed to map device memory!");
+
+		} // if
+
+		heapReserved[heap] += size;
+		return memory;
+
+	} // allocateDeviceMemory
+
+	void LveMemoryAllocator::freeDeviceMemory(VkDeviceMemory memory, uint32_t memoryType, VkDeviceSize size, void* mapped) {
+		if (mapped != nullptr)
+			vkUnmapMemory(device, memory);
+
+		vkFreeMemory(device, memory, nullptr);
+		heapReserved[memoryProperties.memoryTypes[memoryType].heapIndex] -= size;
+
+	} // freeDeviceMemory
+
+	uint32_t LveMemoryAllocator::findPool(uint32_t memoryType, bool linear) {
+		for (uint32_t p = 0; p < pools.size(); p++) {
+			if (pools[p].memoryType == memoryType && pools[p].linear == linear)
+				return p;
+
+		} // for
+
+		VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryType].heapIndex].size;
+		VkDeviceSize poolBlockSize = heapSize <= SMALL_HEAP_SIZE ? std::min(blockSize, heapSize / 8) : blockSize;
+
+		pools.push_back(Pool{ memoryType, linear, poolBlockSize, {} });
+		return static_cast<uint32_t>(pools.size() - 1);
+
+	} // findPool
+
+	bool LveMemoryAllocator::isHostVisible(uint32_t memoryType) const {
+		return (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0;
+
+	} // isHostVisible
+
+	bool LveMemoryAllocator::isNonCoherent(uint32_t memoryType) const {
+		VkMemoryPropertyFlags flags = memoryProperties.memoryTypes[memoryType].propertyFlags;
+		return (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	} // isNonCoherent
+
+	VkDeviceSize LveMemoryAllocator::atomAlignment(uint32_t memoryType) const {
+		return isNonCoherent(memoryType) ? nonCoherentAtomSize : 1;
+
+	} // atomAlignment
+
+} // lve
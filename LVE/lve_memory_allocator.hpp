@@ -0,0 +1,171 @@
+#pragma once
+
+#include "lve_range_allocator.hpp"
+
+// libs
+#include <vulkan/vulkan.h>
+
+// std
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace lve {
+
+	// what an allocation holds, only used for statistics
+	enum class LveMemoryCategory : uint32_t {
+		Vertex,
+		Index,
+		Uniform,
+		Staging,
+		Depth,
+		Texture,
+		Other,
+		Count
+
+	}; // LveMemoryCategory
+
+	const char* memoryCategoryName(LveMemoryCategory category);
+	LveMemoryCategory bufferMemoryCategory(VkBufferUsageFlags usage);
+	LveMemoryCategory imageMemoryCategory(VkImageUsageFlags usage);
+
+	// a piece of device memory handed out by LveMemoryAllocator, bind the resource at memory + offset
+	struct LveMemoryAllocation {
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0; // rounded up to nonCoherentAtomSize for host visible memory
+		uint32_t memoryType = 0;
+		uint32_t pool = UINT32_MAX; // UINT32_MAX = dedicated VkDeviceMemory
+		uint32_t block = 0;
+		LveMemoryCategory category = LveMemoryCategory::Other;
+		void* mapped = nullptr; // host visible memory stays mapped for its whole life, this points at offset
+
+		bool isDedicated() const { return pool == UINT32_MAX; } // isDedicated
+
+	}; // LveMemoryAllocation
+
+	// sub-allocates buffers and images out of a few large VkDeviceMemory blocks per memory type instead of calling
+	// vkAllocateMemory for every resource, drivers cap the number of live allocations (often at 4096) and each call is slow
+	class LveMemoryAllocator {
+	public:
+		static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64 * 1024 * 1024;
+
+		// new device memory is reported once a heap would go past this share of its budget
+		static constexpr double BUDGET_WARNING_RATIO = 0.9;
+
+		// without VK_EXT_memory_budget the budget is guessed as this share of the heap, the rest is left to the
+		// system and other processes
+		static constexpr double FALLBACK_BUDGET_RATIO = 0.8;
+
+		struct Stats {
+			uint32_t blockCount = 0;
+			uint32_t dedicatedCount = 0;
+			uint64_t allocationCount = 0; // live sub-allocations and dedicated allocations
+			uint64_t deviceMemoryCount = 0; // live VkDeviceMemory objects, what the driver limit counts
+			VkDeviceSize usedBytes = 0;
+			VkDeviceSize reservedBytes = 0;
+
+		}; // Stats
+
+		struct HeapBudget {
+			VkDeviceSize heapSize = 0;
+			VkDeviceSize budget = 0; // what the driver says this process can use before it starts paging
+			VkDeviceSize usage = 0; // whole process as the driver sees it, only our reserved bytes without the extension
+			VkDeviceSize reservedBytes = 0; // VkDeviceMemory this allocator holds on the heap
+			VkDeviceSize usedBytes = 0; // of that, handed out to resources
+			bool deviceLocal = false;
+
+		}; // HeapBudget
+
+		struct CategoryStats {
+			uint64_t allocationCount = 0;
+			VkDeviceSize bytes = 0;
+
+		}; // CategoryStats
+
+		// memoryBudget is whether the device was created with VK_EXT_memory_budget, which needs a 1.1 instance
+		LveMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, bool memoryBudget, VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+		~LveMemoryAllocator();
+
+		LveMemoryAllocator(const LveMemoryAllocator&) = delete;
+		LveMemoryAllocator& operator=(const LveMemoryAllocator&) = delete;
+
+		// linear is true for buffers and linear tiled images, they never share a block with optimal tiled images,
+		// which keeps every block clear of bufferImageGranularity conflicts
+		LveMemoryAllocation allocate(
+			const VkMemoryRequirements& requirements,
+			VkMemoryPropertyFlags properties,
+			bool linear,
+			LveMemoryCategory category = LveMemoryCategory::Other);
+		void free(LveMemoryAllocation& allocation);
+
+		// range of the allocation to flush or invalidate, widened to nonCoherentAtomSize, VK_WHOLE_SIZE is the rest of it
+		VkMappedMemoryRange mappedRange(const LveMemoryAllocation& allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+		// host writes to non-coherent memory only reach the device through a flush, in whole atoms of this size
+		bool needsFlush(const LveMemoryAllocation& allocation) const { return isNonCoherent(allocation.memoryType); } // needsFlush
+		VkDeviceSize flushAlignment(const LveMemoryAllocation& allocation) const { return atomAlignment(allocation.memoryType); } // flushAlignment
+
+		uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+		Stats getStats() const;
+		void printStats(std::ostream& out) const;
+
+		bool hasMemoryBudget() const { return memoryBudget; } // hasMemoryBudget
+
+		// queries the driver, cheap enough for once a second but not for every allocation
+		std::vector<HeapBudget> getHeapBudgets() const;
+		std::array<CategoryStats, static_cast<size_t>(LveMemoryCategory::Count)> getCategoryStats() const;
+
+		// one line with every heap against its budget and the bytes per category, warns about heaps near their budget
+		void printBudget(std::ostream& out) const;
+
+	private:
+		struct Block {
+			VkDeviceMemory memory = VK_NULL_HANDLE;
+			void* mapped = nullptr;
+			LveRangeAllocator allocator;
+
+		}; // Block
+
+		// blocks of one memory type holding either linear or optimal resources
+		struct Pool {
+			uint32_t memoryType;
+			bool linear;
+			VkDeviceSize blockSize;
+			std::vector<std::unique_ptr<Block>> blocks; // released blocks leave a null slot so block indices stay valid
+
+		}; // Pool
+
+		VkDeviceMemory allocateDeviceMemory(VkDeviceSize size, uint32_t memoryType, void** mapped);
+		void freeDeviceMemory(VkDeviceMemory memory, uint32_t memoryType, VkDeviceSize size, void* mapped);
+		void queryHeapBudgets(std::vector<HeapBudget>& budgets) const;
+		void warnIfOverBudget(uint32_t heap, VkDeviceSize size);
+		uint32_t findPool(uint32_t memoryType, bool linear);
+		bool isHostVisible(uint32_t memoryType) const;
+		bool isNonCoherent(uint32_t memoryType) const;
+		VkDeviceSize atomAlignment(uint32_t memoryType) const;
+
+		VkDevice device;
+		VkPhysicalDevice physicalDevice;
+		bool memoryBudget;
+		VkPhysicalDeviceMemoryProperties memoryProperties{};
+		VkDeviceSize nonCoherentAtomSize = 1;
+		VkDeviceSize blockSize;
+
+		mutable std::mutex mutex;
+		std::vector<Pool> pools;
+		uint32_t dedicatedCount = 0;
+		VkDeviceSize dedicatedBytes = 0;
+
+		std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapReserved{};
+		std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heapUsed{};
+		std::array<uint8_t, VK_MAX_MEMORY_HEAPS> heapWarningLevel{}; // 1 near the budget, 2 over it
+		std::array<CategoryStats, static_cast<size_t>(LveMemoryCategory::Count)> categories{};
+
+	}; // LveMemoryAllocator
+
+} // lve
@@ -0,0 +1,302 @@
+#include "lve_mesh_cache.hpp"
+
+// std
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lve {
+
+	namespace {
+
+		struct SourceStamp {
+			uint64_t size = 0;
+			int64_t mtime = 0;
+
+		}; // SourceStamp
+
+		bool getSourceStamp(const std::string& sourcePath, SourceStamp& stamp) {
+			std::error_code ec;
+			auto size = std::filesystem::file_size(sourcePath, ec);
+			if (ec)
+				return false;
+
+			auto mtime = std::filesystem::last_write_time(sourcePath, ec);
+			if (ec)
+				return false;
+
+			stamp.size = static_cast<uint64_t>(size);
+			stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+			return true;
+
+		} // getSourceStamp
+
+		// 64 bit FNV-1a, only used to tell whether a touched source file actually changed
+		uint64_t hashSource(const std::string& sourcePath) {
+			auto source = LveMappedFile::open(sourcePath);
+			if (!source)
+				return 0;
+
+			uint64_t hash = 0xcbf29ce484222325ull;
+			const uint8_t* bytes = source->data();
+			for (size_t i = 0; i < source->size(); i++) {
+				hash ^= bytes[i];
+				hash *= 0x100000001b3ull;
+
+			} // for
+
+			return hash;
+
+		} // hashSource
+
+		// patches only the stored mtime in place, the rest of the cache is left untouched
+		bool storeSourceMtime(const std::string& cachePath, int64_t mtime) {
+			std::fstream out{ cachePath, std::ios::binary | std::ios::in | std::ios::out };
+			if (!out.is_open())
+				return false;
+
+			out.seekp(offsetof(LveMeshCache::Header, sourceMtime));
+			out.write(reinterpret_cast<const char*>(&mtime), sizeof(mtime));
+			return out.good();
+
+		} // storeSourceMtime
+
+	} // namespace
+
+	// *************** Mapped File *********************
+
+	std::unique_ptr<LveMappedFile> LveMappedFile::open(const std::string& filepath) {
+		std::unique_ptr<LveMappedFile> file{ new LveMappedFile() };
+
+#ifdef _WIN32
+		HANDLE handle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle == INVALID_HANDLE_VALUE)
+			return nullptr;
+
+		file->fileHandle = handle;
+
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0)
+			return nullptr;
+
+		HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+			return nullptr;
+
+		file->mappingHandle = mapping;
+		file->bytes = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		if (file->bytes == nullptr)
+			return nullptr;
+
+		file->byteCount = static_cast<size_t>(size.QuadPart);
+#else
+		file->fileDescriptor = ::open(filepath.c_str(), O_RDONLY);
+		if (file->fileDescriptor < 0)
+			return nullptr;
+
+		struct stat info{};
+		if (fstat(file->fileDescriptor, &info) != 0 || info.st_size == 0)
+			return nullptr;
+
+		void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file->fileDescriptor, 0);
+		if (view == MAP_FAILED)
+			return nullptr;
+
+		file->bytes = static_cast<const uint8_t*>(view);
+		file->byteCount = static_cast<size_t>(info.st_size);
+#endif
+
+		return file;
+
+	} // open
+
+	LveMappedFile::~LveMappedFile() {
+#ifdef _WIN32
+		if (bytes != nullptr)
+			UnmapViewOfFile(bytes);
+
+		if (mappingHandle != nullptr)
+			CloseHandle(mappingHandle);
+
+		if (fileHandle != nullptr)
+			CloseHandle(fileHandle);
+#else
+		if (bytes != nullptr)
+			munmap(const_cast<uint8_t*>(bytes), byteCount);
+
+		if (fileDescriptor >= 0)
+			::close(fileDescriptor);
+#endif
+
+	} // ~LveMappedFile
+
+	// *************** Mesh Cache *********************
+
+	LveMeshCache::LveMeshCache(std::unique_ptr<LveMappedFile> file)
+		: file{ std::move(file) } {
+		header = reinterpret_cast<const Header*>(this->file->data());
+
+	} // LveMeshCache
+
+	std::string LveMeshCache::cachePathFor(const std::string& sourcePath) {
+		return std::filesystem::path(sourcePath).replace_extension(".lvemesh").string();
+
+	} // cachePathFor
+
+	std::unique_ptr<LveMeshCache> LveMeshCache::load(const std::string& sourcePath, uint32_t loadFlags) {
+		SourceStamp stamp{};
+		if (!getSourceStamp(sourcePath, stamp))
+			return nullptr;
+
+		std::string cachePath = cachePathFor(sourcePath);
+		auto file = LveMappedFile::open(cachePath);
+		if (!file || file->size() < sizeof(Header))
+			return nullptr;
+
+		const auto* header = reinterpret_cast<const Header*>(file->data());
+		if (header->magic != MAGIC || header->version != VERSION || header->vertexStride != sizeof(LveModel::Vertex) || header->meshletStride != sizeof(LveModel::Meshlet) || header->lodStride != sizeof(LveModel::Lod))
+			return nullptr;
+
+		if (header->loadFlags != loadFlags)
+			return nullptr;
+
+		// never trust the offsets of a truncated or foreign file
+		uint64_t vertexBytes = static_cast<uint64_t>(header->vertexCount) * sizeof(LveModel::Vertex);
+		uint64_t indexBytes = static_cast<uint64_t>(header->indexCount) * sizeof(uint32_t);
+		uint64_t meshletBytes = static_cast<uint64_t>(header->meshletCount) * sizeof(LveModel::Meshlet);
+		uint64_t lodBytes = static_cast<uint64_t>(header->lodCount) * sizeof(LveModel::Lod);
+		if (header->vertexOffset + vertexBytes > file->size() || header->indexOffset + indexBytes > file->size() ||
+			header->meshletOffset + meshletBytes > file->size() || header->lodOffset + lodBytes > file->size())
+			return nullptr;
+
+		if (header->sourceSize != stamp.size)
+			return nullptr;
+
+		// a touched but unchanged source (fresh checkout, copy) keeps its cache, only the hash decides then
+		if (header->sourceMtime != stamp.mtime) {
+			if (header->sourceHash != hashSource(sourcePath))
+				return nullptr;
+
+			// store the new mtime so the next load skips hashing the source again, the mapping is closed first
+			// because Windows refuses to write a file that is still mapped, a read only cache just stays stale
+			size_t size = file->size();
+			file.reset();
+			storeSourceMtime(cachePath, stamp.mtime);
+
+			file = LveMappedFile::open(cachePath);
+			if (!file || file->size() != size)
+				return nullptr;
+
+		} // if
+
+		return std::unique_ptr<LveMeshCache>(new LveMeshCache(std::move(file)));
+
+	} // load
+
+	bool LveMeshCache::write(const std::string& sourcePath, const LveModel::Builder& builder, uint32_t loadFlags) {
+		SourceStamp stamp{};
+		if (!getSourceStamp(sourcePath, stamp))
+			return false;
+
+		Header header{};
+		header.magic = MAGIC;
+		header.version = VERSION;
+		header.vertexStride = sizeof(LveModel::Vertex);
+		header.loadFlags = loadFlags;
+		header.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+		header.indexCount = static_cast<uint32_t>(builder.indices.size());
+		header.meshletStride = sizeof(LveModel::Meshlet);
+		header.meshletCount = static_cast<uint32_t>(builder.meshlets.size());
+		header.lodStride = sizeof(LveModel::Lod);
+		header.lodCount = static_cast<uint32_t>(builder.lods.size());
+		header.bounds = builder.bounds;
+		header.sourceSize = stamp.size;
+		header.sourceMtime = stamp.mtime;
+		header.sourceHash = hashSource(sourcePath);
+		header.vertexOffset = sizeof(Header);
+		header.indexOffset = header.vertexOffset + builder.vertices.size() * sizeof(LveModel::Vertex);
+		header.meshletOffset = header.indexOffset + builder.indices.size() * sizeof(uint32_t);
+		header.lodOffset = header.meshletOffset + builder.meshlets.size() * sizeof(LveModel::Meshlet);
+
+		// write to a temporary file first so a crash never leaves a half written cache behind
+		std::string cachePath = cachePathFor(sourcePath);
+		std::string tempPath = cachePath + ".tmp";
+		{
+			std::ofstream out{ tempPath, std::ios::binary | std::ios::trunc };
+			if (!out.is_open())
+				return false;
+
+			out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+			out.write(reinterpret_cast<const char*>(builder.vertices.data()), builder.vertices.size() * sizeof(LveModel::Vertex));
+			out.write(reinterpret_cast<const char*>(builder.indices.data()), builder.indices.size() * sizeof(uint32_t));
+			out.write(reinterpret_cast<const char*>(builder.meshlets.data()), builder.meshlets.size() * sizeof(LveModel::Meshlet));
+			out.write(reinterpret_cast<const char*>(builder.lods.data()), builder.lods.size() * sizeof(LveModel::Lod));
+
+			if (!out.good())
+				return false;
+
+		} // out
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, cachePath, ec);
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+			return false;
+
+		} // if
+
+		return true;
+
+	} // write
+
+	const LveModel::Vertex* LveMeshCache::vertices() const {
+		return reinterpret_cast<const LveModel::Vertex*>(file->data() + header->vertexOffset);
+
+	} // vertices
+
+	const uint32_t* LveMeshCache::indices() const {
+		return reinterpret_cast<const uint32_t*>(file->data() + header->indexOffset);
+
+	} // indices
+
+	const LveModel::Meshlet* LveMeshCache::meshlets() const {
+		return reinterpret_cast<const LveModel::Meshlet*>(file->data() + header->meshletOffset);
+
+	} // meshlets
+
+	const LveModel::Lod* LveMeshCache::lods() const {
+		return reinterpret_cast<const LveModel::Lod*>(file->data() + header->lodOffset);
+
+	} // lods
+
+	LveModel::MeshView LveMeshCache::view() const {
+		LveModel::MeshView mesh{};
+		mesh.vertices = vertices();
+		mesh.vertexCount = vertexCount();
+		mesh.indices = indices();
+		mesh.indexCount = indexCount();
+		mesh.meshlets = meshlets();
+		mesh.meshletCount = meshletCount();
+		mesh.lods = lods();
+		mesh.lodCount = lodCount();
+		mesh.bounds = &header->bounds;
+		return mesh;
+
+	} // view
+
+} // lve
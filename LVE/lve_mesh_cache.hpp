@@ -0,0 +1,95 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace lve {
+
+	// read only memory mapping of a whole file, the view stays valid for the lifetime of the object
+	class LveMappedFile {
+	public:
+		static std::unique_ptr<LveMappedFile> open(const std::string& filepath);
+		~LveMappedFile();
+
+		LveMappedFile(const LveMappedFile&) = delete;
+		LveMappedFile& operator=(const LveMappedFile&) = delete;
+
+		const uint8_t* data() const { return bytes; } // data
+		size_t size() const { return byteCount; } // size
+
+	private:
+		LveMappedFile() = default;
+
+		const uint8_t* bytes = nullptr;
+		size_t byteCount = 0;
+
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#else
+		int fileDescriptor = -1;
+#endif
+
+	}; // LveMappedFile
+
+	// binary copy of a loaded LveModel::Builder stored next to the source .obj
+	// the vertex and index blobs are laid out exactly like LveModel::Vertex and uint32_t so they can be
+	// copied straight from the mapping into a staging buffer without parsing anything
+	class LveMeshCache {
+	public:
+		static constexpr uint32_t MAGIC = 0x4D45564C; // "LVEM"
+		static constexpr uint32_t VERSION = 4;
+
+		struct Header {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t vertexStride; // sizeof(LveModel::Vertex) when the file was written
+			uint32_t vertexCount;
+			uint32_t indexCount;
+			uint32_t loadFlags; // output affecting load options, see meshCacheFlags in lve_model.cpp
+			uint64_t sourceSize;
+			int64_t sourceMtime;
+			uint64_t sourceHash;
+			uint32_t meshletStride; // sizeof(LveModel::Meshlet) when the file was written
+			uint32_t meshletCount;
+			uint32_t lodStride; // sizeof(LveModel::Lod) when the file was written
+			uint32_t lodCount;
+			LveModel::Bounds bounds; // from LveModel::Builder::computeBounds, so loading never walks the vertices
+			uint64_t vertexOffset; // byte offsets from the start of the file
+			uint64_t indexOffset;
+			uint64_t meshletOffset;
+			uint64_t lodOffset;
+
+		}; // Header
+
+		// returns nullptr when there is no cache, it no longer matches the source file or was built with other loadFlags
+		static std::unique_ptr<LveMeshCache> load(const std::string& sourcePath, uint32_t loadFlags);
+		static bool write(const std::string& sourcePath, const LveModel::Builder& builder, uint32_t loadFlags);
+
+		static std::string cachePathFor(const std::string& sourcePath);
+
+		const LveModel::Vertex* vertices() const;
+		const uint32_t* indices() const;
+		const LveModel::Meshlet* meshlets() const;
+		const LveModel::Lod* lods() const;
+		uint32_t vertexCount() const { return header->vertexCount; } // vertexCount
+		uint32_t indexCount() const { return header->indexCount; } // indexCount
+		uint32_t meshletCount() const { return header->meshletCount; } // meshletCount
+		uint32_t lodCount() const { return header->lodCount; } // lodCount
+
+		// everything LveModel needs, pointing straight into the mapping
+		LveModel::MeshView view() const;
+
+	private:
+		LveMeshCache(std::unique_ptr<LveMappedFile> file);
+
+		std::unique_ptr<LveMappedFile> file;
+		const Header* header;
+
+	}; // LveMeshCache
+
+} // lve
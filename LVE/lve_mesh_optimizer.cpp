@@ -0,0 +1,337 @@
+#include "lve_mesh_optimizer.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lve {
+
+	namespace {
+
+		// Forsyth's scoring, the cache modelled here is only a heuristic and is larger than the measured FIFO
+		constexpr uint32_t SCORE_CACHE_SIZE = 32;
+		constexpr float CACHE_DECAY_POWER = 1.5f;
+		constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+		constexpr float VALENCE_BOOST_SCALE = 2.f;
+		constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+		float vertexScore(int cachePosition, uint32_t remainingTriangles) {
+			// nothing left to draw with this vertex
+			if (remainingTriangles == 0)
+				return -1.f;
+
+			float score = 0.f;
+			if (cachePosition >= 0) {
+				// the vertices of the last triangle get a fixed score so the next one does not just reuse the same edge
+				if (cachePosition < 3) {
+					score = LAST_TRIANGLE_SCORE;
+
+				} // if
+				else {
+					float scaler = 1.f / (SCORE_CACHE_SIZE - 3);
+					score = std::pow(1.f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+
+				} // else
+
+			} // if
+
+			// vertices with few triangles left are finished first so they do not stay around as lone triangles
+			score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+			return score;
+
+		} // vertexScore
+
+		// timestamp trick: a vertex is in the FIFO when fewer than cacheSize misses happened since it was loaded
+		class FifoCache {
+		public:
+			FifoCache(size_t vertexCount, uint32_t cacheSize) : timestamps(vertexCount, 0), cacheSize{ cacheSize }, time{ cacheSize + 1 } {}
+
+			// returns 1 on a miss
+			uint32_t access(uint32_t vertex) {
+				if (time - timestamps[vertex] <= cacheSize)
+					return 0;
+
+				timestamps[vertex] = time++;
+				return 1;
+
+			} // access
+
+			void clear() { time += cacheSize + 1; } // clear
+
+		private:
+			std::vector<uint32_t> timestamps;
+			uint32_t cacheSize;
+			uint32_t time;
+
+		}; // FifoCache
+
+		uint32_t triangleMisses(FifoCache& cache, const uint32_t* triangle) {
+			return cache.access(triangle[0]) + cache.access(triangle[1]) + cache.access(triangle[2]);
+
+		} // triangleMisses
+
+	} // namespace
+
+	float LveMeshOptimizer::computeAcmr(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+		size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return 0.f;
+
+		FifoCache cache{ vertexCount, cacheSize };
+		uint64_t misses = 0;
+		for (size_t t = 0; t < triangleCount; t++)
+			misses += triangleMisses(cache, &indices[t * 3]);
+
+		return static_cast<float>(misses) / static_cast<float>(triangleCount);
+
+	} // computeAcmr
+
+	void LveMeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+		size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return;
+
+		// triangles using each vertex, the first remaining[v] entries of a vertex are the ones not emitted yet
+		std::vector<uint32_t> remaining(vertexCount, 0);
+		for (uint32_t index : indices)
+			remaining[index]++;
+
+		std::vector<uint32_t> offsets(vertexCount + 1, 0);
+		for (size_t v = 0; v < vertexCount; v++)
+			offsets[v + 1] = offsets[v] + remaining[v];
+
+		std::vector<uint32_t> adjacency(indices.size());
+		{
+			std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i++)
+				adjacency[cursor[indices[i]]++] = static_cast<uint32_t>(i / 3);
+
+		} // cursor
+
+		std::vector<int> cachePosition(vertexCount, -1);
+		std::vector<float> scores(vertexCount);
+		for (size_t v = 0; v < vertexCount; v++)
+			scores[v] = vertexScore(-1, remaining[v]);
+
+		std::vector<float> triangleScores(triangleCount);
+		for (size_t t = 0; t < triangleCount; t++)
+			triangleScores[t] = scores[indices[t * 3 + 0]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+
+		std::vector<uint8_t> emitted(triangleCount, 0);
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+
+		uint32_t cache[SCORE_CACHE_SIZE + 3];
+		uint32_t nextCache[SCORE_CACHE_SIZE + 3];
+		uint32_t cacheCount = 0;
+
+		int64_t best = static_cast<int64_t>(std::max_element(triangleScores.begin(), triangleScores.end()) - triangleScores.begin());
+		size_t cursor = 0;
+
+		while (result.size() < indices.size()) {
+			// no triangle touches the cache any more, continue with the next one in the original order
+			if (best < 0) {
+				while (emitted[cursor])
+					cursor++;
+
+				best = static_cast<int64_t>(cursor);
+
+			} // if
+
+			const uint32_t* triangle = &indices[static_cast<size_t>(best) * 3];
+			emitted[best] = 1;
+			result.insert(result.end(), triangle, triangle + 3);
+
+			for (int k = 0; k < 3; k++) {
+				uint32_t v = triangle[k];
+				uint32_t* begin = &adjacency[offsets[v]];
+				uint32_t* end = begin + remaining[v];
+				uint32_t* it = std::find(begin, end, static_cast<uint32_t>(best));
+				std::swap(*it, *(end - 1));
+				remaining[v]--;
+
+			} // for
+
+			// the triangle's vertices move to the front of the LRU cache, everything else shifts back
+			uint32_t nextCount = 0;
+			for (int k = 0; k < 3; k++) {
+				if (std::find(nextCache, nextCache + nextCount, triangle[k]) == nextCache + nextCount)
+					nextCache[nextCount++] = triangle[k];
+
+			} // for
+
+			for (uint32_t i = 0; i < cacheCount; i++) {
+				uint32_t v = cache[i];
+				if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+					nextCache[nextCount++] = v;
+
+			} // for
+
+			for (uint32_t i = 0; i < nextCount; i++) {
+				uint32_t v = nextCache[i];
+				cachePosition[v] = i < SCORE_CACHE_SIZE ? static_cast<int>(i) : -1;
+				scores[v] = vertexScore(cachePosition[v], remaining[v]);
+
+			} // for
+
+			// only triangles around the cached vertices changed score, the best of them is drawn next
+			best = -1;
+			float bestScore = -std::numeric_limits<float>::max();
+			for (uint32_t i = 0; i < nextCount; i++) {
+				uint32_t v = nextCache[i];
+				for (uint32_t j = 0; j < remaining[v]; j++) {
+					uint32_t t = adjacency[offsets[v] + j];
+					const uint32_t* other = &indices[static_cast<size_t>(t) * 3];
+					float score = scores[other[0]] + scores[other[1]] + scores[other[2]];
+					triangleScores[t] = score;
+
+					if (score > bestScore) {
+						bestScore = score;
+						best = t;
+
+					} // if
+
+				} // for
+
+			} // for
+
+			cacheCount = std::min(nextCount, SCORE_CACHE_SIZE);
+			std::copy(nextCache, nextCache + cacheCount, cache);
+
+		} // while
+
+		indices.swap(result);
+
+	} // optimizeVertexCache
+
+	void LveMeshOptimizer::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<LveModel::Vertex>& vertices, float threshold) {
+		size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return;
+
+		FifoCache cache{ vertices.size(), CACHE_SIZE };
+
+		// hard boundaries, a triangle missing all three vertices starts a new strip like run anyway
+		std::vector<uint32_t> hardBoundaries;
+		for (size_t t = 0; t < triangleCount; t++) {
+			if (triangleMisses(cache, &indices[t * 3]) == 3 || t == 0)
+				hardBoundaries.push_back(static_cast<uint32_t>(t));
+
+		} // for
+
+		hardBoundaries.push_back(static_cast<uint32_t>(triangleCount));
+
+		// soft boundaries, a run is split again wherever its prefix is within threshold of the run's own ACMR,
+		// so reordering the pieces costs at most a cold cache per piece
+		std::vector<uint32_t> clusters;
+		for (size_t c = 0; c + 1 < hardBoundaries.size(); c++) {
+			uint32_t start = hardBoundaries[c];
+			uint32_t end = hardBoundaries[c + 1];
+
+			cache.clear();
+			uint32_t runMisses = 0;
+			for (uint32_t t = start; t < end; t++)
+				runMisses += triangleMisses(cache, &indices[t * 3]);
+
+			float target = threshold * static_cast<float>(runMisses) / static_cast<float>(end - start);
+
+			cache.clear();
+			uint32_t clusterStart = start;
+			uint32_t clusterMisses = 0;
+			clusters.push_back(start);
+
+			for (uint32_t t = start; t < end; t++) {
+				clusterMisses += triangleMisses(cache, &indices[t * 3]);
+
+				if (t + 1 < end && static_cast<float>(clusterMisses) / static_cast<float>(t + 1 - clusterStart) <= target) {
+					cache.clear();
+					clusterStart = t + 1;
+					clusterMisses = 0;
+					clusters.push_back(clusterStart);
+
+				} // if
+
+			} // for
+
+		} // for
+
+		clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+		// area weighted centroid and normal of every cluster and of the whole mesh
+		size_t clusterCount = clusters.size() - 1;
+		std::vector<glm::vec3> centroids(clusterCount, glm::vec3{ 0.f });
+		std::vector<glm::vec3> normals(clusterCount, glm::vec3{ 0.f });
+		glm::vec3 meshCentroid{ 0.f };
+		float meshArea = 0.f;
+
+		for (size_t c = 0; c < clusterCount; c++) {
+			float clusterArea = 0.f;
+			for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++) {
+				const glm::vec3& p0 = vertices[indices[t * 3 + 0]].position;
+				const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+				const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+
+				glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				float area = glm::length(normal);
+				glm::vec3 center = (p0 + p1 + p2) / 3.f;
+
+				centroids[c] += center * area;
+				normals[c] += normal;
+				clusterArea += area;
+
+			} // for
+
+			meshCentroid += centroids[c];
+			meshArea += clusterArea;
+			centroids[c] = clusterArea > 0.f ? centroids[c] / clusterArea : centroids[c];
+
+		} // for
+
+		meshCentroid = meshArea > 0.f ? meshCentroid / meshArea : meshCentroid;
+
+		// clusters far out along their own normal are likely to occlude the rest, draw those first
+		std::vector<float> sortKeys(clusterCount);
+		for (size_t c = 0; c < clusterCount; c++) {
+			float length = glm::length(normals[c]);
+			glm::vec3 normal = length > 0.f ? normals[c] / length : glm::vec3{ 0.f };
+			sortKeys[c] = glm::dot(centroids[c] - meshCentroid, normal);
+
+		} // for
+
+		std::vector<uint32_t> order(clusterCount);
+		for (uint32_t c = 0; c < clusterCount; c++)
+			order[c] = c;
+
+		std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+		std::vector<uint32_t> result;
+		result.reserve(indices.size());
+		for (uint32_t c : order)
+			result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+
+		indices.swap(result);
+
+	} // optimizeOverdraw
+
+	void LveMeshOptimizer::optimizeVertexFetch(std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices) {
+		std::vector<uint32_t> remap(vertices.size(), std::numeric_limits<uint32_t>::max());
+		std::vector<LveModel::Vertex> result;
+		result.reserve(vertices.size());
+
+		for (uint32_t& index : indices) {
+			if (remap[index] == std::numeric_limits<uint32_t>::max()) {
+				remap[index] = static_cast<uint32_t>(result.size());
+				result.push_back(vertices[index]);
+
+			} // if
+
+			index = remap[index];
+
+		} // for
+
+		vertices.swap(result);
+
+	} // optimizeVertexFetch
+
+} // lve
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+	// post load reordering of a triangle list, every step keeps the mesh exactly the same and only changes the order
+	// of triangles and vertices, so it can run on any Builder before the buffers are created
+	class LveMeshOptimizer {
+	public:
+		// size of the FIFO post transform cache used to measure ACMR
+		static constexpr uint32_t CACHE_SIZE = 16;
+
+		// average cache miss ratio, transformed vertices per triangle (0.5 is ideal for a regular grid, 3 is the worst)
+		static float computeAcmr(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = CACHE_SIZE);
+
+		// reorders triangles for the post transform vertex cache (Forsyth, "Linear-Speed Vertex Cache Optimisation")
+		static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+		// reorders clusters of the cache optimized order so outward facing ones are drawn first (Sander et al.,
+		// "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"), threshold is the ACMR it may cost
+		static void optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<LveModel::Vertex>& vertices, float threshold = 1.05f);
+
+		// renumbers vertices in the order the indices first use them and drops unreferenced ones
+		static void optimizeVertexFetch(std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	}; // LveMeshOptimizer
+
+} // lve
@@ -0,0 +1,411 @@
+#include "lve_mesh_simplifier.hpp"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lve {
+
+	namespace {
+
+		constexpr uint32_t NO_POSITION = UINT32_MAX;
+
+		// an open edge keeps its plane quadric but also gets one perpendicular to the surface, weighted so holes and
+		// the rims of open meshes like the vases do not shrink away
+		constexpr double BORDER_WEIGHT = 10.0;
+
+		// symmetric 4x4 matrix of the summed squared distances to a set of planes, only the upper triangle is stored
+		struct Quadric {
+			double xx = 0.0, xy = 0.0, xz = 0.0, yy = 0.0, yz = 0.0, zz = 0.0;
+			double x = 0.0, y = 0.0, z = 0.0, c = 0.0;
+
+			// plane dot(normal, p) + d = 0 with a unit normal
+			void addPlane(const glm::vec3& normal, float d, double weight) {
+				double a = normal.x, b = normal.y, e = normal.z;
+				xx += weight * a * a; xy += weight * a * b; xz += weight * a * e;
+				yy += weight * b * b; yz += weight * b * e; zz += weight * e * e;
+				x += weight * a * d; y += weight * b * d; z += weight * e * d;
+				c += weight * static_cast<double>(d) * d;
+
+			} // addPlane
+
+			void add(const Quadric& other) {
+				xx += other.xx; xy += other.xy; xz += other.xz; yy += other.yy; yz += other.yz; zz += other.zz;
+				x += other.x; y += other.y; z += other.z; c += other.c;
+
+			} // add
+
+			double evaluate(const glm::vec3& p) const {
+				double px = p.x, py = p.y, pz = p.z;
+				double result = xx * px * px + yy * py * py + zz * pz * pz
+					+ 2.0 * (xy * px * py + xz * px * pz + yz * py * pz)
+					+ 2.0 * (x * px + y * py + z * pz) + c;
+
+				// rounding can push a perfect fit slightly below zero
+				return std::max(result, 0.0);
+
+			} // evaluate
+
+		}; // Quadric
+
+		struct Edge {
+			uint32_t a; // a < b
+			uint32_t b;
+			uint32_t triangle;
+
+		}; // Edge
+
+		struct Collapse {
+			double cost;
+			uint32_t from;
+			uint32_t to;
+
+		}; // Collapse
+
+		// every edge of the triangles, sorted so equal edges are neighbours, degenerate triangles are skipped
+		std::vector<Edge> collectEdges(const std::vector<uint32_t>& triangles) {
+			std::vector<Edge> edges;
+			edges.reserve(triangles.size());
+			for (uint32_t t = 0; t < triangles.size() / 3; t++) {
+				const uint32_t* triangle = &triangles[t * 3];
+				if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+					continue;
+
+				for (int k = 0; k < 3; k++) {
+					uint32_t a = triangle[k];
+					uint32_t b = triangle[(k + 1) % 3];
+					edges.push_back({ std::min(a, b), std::max(a, b), t });
+
+				} // for
+
+			} // for
+
+			std::sort(edges.begin(), edges.end(), [](const Edge& l, const Edge& r) {
+				return l.a != r.a ? l.a < r.a : l.b < r.b;
+
+			}); // sort
+
+			return edges;
+
+		} // collectEdges
+
+		glm::vec3 triangleNormal(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2) {
+			return glm::cross(p1 - p0, p2 - p0);
+
+		} // triangleNormal
+
+		// the corner at the collapse target that best keeps the attributes of the corner being replaced
+		uint32_t closestCorner(const std::vector<LveModel::Vertex>& vertices, uint32_t vertex, const uint32_t* candidates, uint32_t candidateCount) {
+			const LveModel::Vertex& source = vertices[vertex];
+			uint32_t best = candidates[0];
+			float bestScore = -std::numeric_limits<float>::max();
+
+			for (uint32_t i = 0; i < candidateCount; i++) {
+				const LveModel::Vertex& candidate = vertices[candidates[i]];
+				glm::vec2 uv = candidate.uv - source.uv;
+				glm::vec3 color = candidate.color - source.color;
+				float score = glm::dot(candidate.normal, source.normal) - glm::dot(uv, uv) - glm::dot(color, color);
+
+				if (score > bestScore) {
+					bestScore = score;
+					best = candidates[i];
+
+				} // if
+
+			} // for
+
+			return best;
+
+		} // closestCorner
+
+	} // namespace
+
+	std::vector<uint32_t> LveMeshSimplifier::simplify(
+		const std::vector<LveModel::Vertex>& vertices,
+		const std::vector<uint32_t>& indices,
+		size_t targetIndexCount,
+		float maxError,
+		float* error) {
+
+		std::vector<uint32_t> result = indices;
+		if (error != nullptr)
+			*error = 0.f;
+
+		if (result.size() <= targetIndexCount || vertices.empty())
+			return result;
+
+		// corners sharing a position collapse together, so normal and uv seams cannot tear open
+		std::vector<uint32_t> positionOf(vertices.size());
+		std::vector<glm::vec3> positions;
+		{
+			std::vector<uint32_t> order(vertices.size());
+			for (uint32_t i = 0; i < order.size(); i++)
+				order[i] = i;
+
+			auto less = [](const glm::vec3& a, const glm::vec3& b) {
+				return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+
+			}; // less
+
+			std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+				return less(vertices[a].position, vertices[b].position);
+
+			}); // sort
+
+			for (size_t i = 0; i < order.size(); i++) {
+				const glm::vec3& position = vertices[order[i]].position;
+				if (positions.empty() || position != positions.back())
+					positions.push_back(position);
+
+				positionOf[order[i]] = static_cast<uint32_t>(positions.size() - 1);
+
+			} // for
+
+		} // order
+
+		uint32_t positionCount = static_cast<uint32_t>(positions.size());
+
+		// the vertices stored at every position, candidates for the corner that replaces a collapsed one
+		std::vector<uint32_t> cornerOffsets(positionCount + 1, 0);
+		std::vector<uint32_t> corners(vertices.size());
+		{
+			for (uint32_t v = 0; v < vertices.size(); v++)
+				cornerOffsets[positionOf[v] + 1]++;
+
+			for (uint32_t p = 0; p < positionCount; p++)
+				cornerOffsets[p + 1] += cornerOffsets[p];
+
+			std::vector<uint32_t> cursor(cornerOffsets.begin(), cornerOffsets.end() - 1);
+			for (uint32_t v = 0; v < vertices.size(); v++)
+				corners[cursor[positionOf[v]]++] = v;
+
+		} // cursor
+
+		std::vector<uint32_t> triangles(result.size());
+		for (size_t i = 0; i < result.size(); i++)
+			triangles[i] = positionOf[result[i]];
+
+		// error quadrics of the input surface, merged into the survivor of every collapse
+		std::vector<Quadric> quadrics(positionCount);
+		{
+			for (size_t t = 0; t < triangles.size() / 3; t++) {
+				const uint32_t* triangle = &triangles[t * 3];
+				glm::vec3 normal = triangleNormal(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]);
+				float length = glm::length(normal);
+				if (length <= 0.f)
+					continue;
+
+				normal /= length;
+				float d = -glm::dot(normal, positions[triangle[0]]);
+				for (int k = 0; k < 3; k++)
+					quadrics[triangle[k]].addPlane(normal, d, 1.0);
+
+			} // for
+
+			std::vector<Edge> edges = collectEdges(triangles);
+			for (size_t i = 0; i < edges.size();) {
+				size_t j = i + 1;
+				while (j < edges.size() && edges[j].a == edges[i].a && edges[j].b == edges[i].b)
+					j++;
+
+				if (j - i == 1) {
+					const uint32_t* triangle = &triangles[edges[i].triangle * 3];
+					glm::vec3 faceNormal = triangleNormal(positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]);
+					glm::vec3 normal = glm::cross(positions[edges[i].b] - positions[edges[i].a], faceNormal);
+					float length = glm::length(normal);
+
+					if (length > 0.f) {
+						normal /= length;
+						float d = -glm::dot(normal, positions[edges[i].a]);
+						quadrics[edges[i].a].addPlane(normal, d, BORDER_WEIGHT);
+						quadrics[edges[i].b].addPlane(normal, d, BORDER_WEIGHT);
+
+					} // if
+
+				} // if
+
+				i = j;
+
+			} // for
+
+		} // quadrics
+
+		double maxCost = static_cast<double>(maxError) * maxError;
+		double largestCost = 0.0;
+		std::vector<uint32_t> collapseTo(positionCount, NO_POSITION);
+		std::vector<uint8_t> locked(positionCount);
+		std::vector<uint8_t> border(positionCount);
+
+		// every pass collapses an independent set of the cheapest edges, then the triangles are rebuilt
+		while (triangles.size() > targetIndexCount) {
+			uint32_t triangleCount = static_cast<uint32_t>(triangles.size() / 3);
+
+			std::vector<uint32_t> adjacencyOffsets(positionCount + 1, 0);
+			std::vector<uint32_t> adjacency(triangles.size());
+			{
+				for (uint32_t p : triangles)
+					adjacencyOffsets[p + 1]++;
+
+				for (uint32_t p = 0; p < positionCount; p++)
+					adjacencyOffsets[p + 1] += adjacencyOffsets[p];
+
+				std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (uint32_t i = 0; i < triangles.size(); i++)
+					adjacency[cursor[triangles[i]]++] = i / 3;
+
+			} // cursor
+
+			// an edge used by anything but exactly two triangles is open or non-manifold
+			std::vector<Edge> edges = collectEdges(triangles);
+			std::vector<uint8_t> borderEdge(edges.size(), 0);
+			std::fill(border.begin(), border.end(), 0);
+
+			for (size_t i = 0; i < edges.size();) {
+				size_t j = i + 1;
+				while (j < edges.size() && edges[j].a == edges[i].a && edges[j].b == edges[i].b)
+					j++;
+
+				if (j - i != 2) {
+					borderEdge[i] = 1;
+					border[edges[i].a] = 1;
+					border[edges[i].b] = 1;
+
+				} // if
+
+				i = j;
+
+			} // for
+
+			std::vector<Collapse> candidates;
+			for (size_t i = 0; i < edges.size(); i++) {
+				if (i > 0 && edges[i].a == edges[i - 1].a && edges[i].b == edges[i - 1].b)
+					continue;
+
+				Collapse best{ std::numeric_limits<double>::max(), NO_POSITION, NO_POSITION };
+				uint32_t ends[2] = { edges[i].a, edges[i].b };
+
+				for (int k = 0; k < 2; k++) {
+					uint32_t from = ends[k];
+					uint32_t to = ends[1 - k];
+
+					// a border vertex may only slide along the border, never into the surface
+					if (border[from] && !borderEdge[i])
+						continue;
+
+					double cost = quadrics[from].evaluate(positions[to]) + quadrics[to].evaluate(positions[to]);
+					if (cost < best.cost)
+						best = { cost, from, to };
+
+				} // for
+
+				if (best.from != NO_POSITION && best.cost <= maxCost)
+					candidates.push_back(best);
+
+			} // for
+
+			if (candidates.empty())
+				break;
+
+			std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+			uint32_t trianglesToRemove = triangleCount - static_cast<uint32_t>(targetIndexCount / 3);
+			uint32_t trianglesRemoved = 0;
+			uint32_t collapses = 0;
+			std::fill(locked.begin(), locked.end(), 0);
+
+			for (const auto& collapse : candidates) {
+				if (trianglesRemoved >= trianglesToRemove)
+					break;
+
+				if (locked[collapse.from] || locked[collapse.to])
+					continue;
+
+				// moving the vertex must not fold any of the remaining triangles around it over
+				bool flips = false;
+				uint32_t removes = 0;
+				for (uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1] && !flips; i++) {
+					const uint32_t* triangle = &triangles[adjacency[i] * 3];
+					if (triangle[0] == collapse.to || triangle[1] == collapse.to || triangle[2] == collapse.to) {
+						removes++;
+						continue;
+
+					} // if
+
+					glm::vec3 p[3], q[3];
+					for (int k = 0; k < 3; k++) {
+						p[k] = positions[triangle[k]];
+						q[k] = triangle[k] == collapse.from ? positions[collapse.to] : p[k];
+
+					} // for
+
+					flips = glm::dot(triangleNormal(p[0], p[1], p[2]), triangleNormal(q[0], q[1], q[2])) <= 0.f;
+
+				} // for
+
+				if (flips)
+					continue;
+
+				collapseTo[collapse.from] = collapse.to;
+				quadrics[collapse.to].add(quadrics[collapse.from]);
+				largestCost = std::max(largestCost, collapse.cost);
+				trianglesRemoved += removes;
+				collapses++;
+
+				// the flip test above only holds while the one ring stays put, so nothing around it moves this pass
+				for (uint32_t i = adjacencyOffsets[collapse.from]; i < adjacencyOffsets[collapse.from + 1]; i++) {
+					const uint32_t* triangle = &triangles[adjacency[i] * 3];
+					locked[triangle[0]] = locked[triangle[1]] = locked[triangle[2]] = 1;
+
+				} // for
+
+			} // for
+
+			if (collapses == 0)
+				break;
+
+			// move the corners of collapsed positions and drop the triangles that became degenerate
+			size_t write = 0;
+			for (size_t t = 0; t < triangleCount; t++) {
+				uint32_t corner[3];
+				uint32_t position[3];
+				for (int k = 0; k < 3; k++) {
+					corner[k] = result[t * 3 + k];
+					position[k] = triangles[t * 3 + k];
+
+					uint32_t to = collapseTo[position[k]];
+					if (to != NO_POSITION) {
+						corner[k] = closestCorner(vertices, corner[k], &corners[cornerOffsets[to]], cornerOffsets[to + 1] - cornerOffsets[to]);
+						position[k] = to;
+
+					} // if
+
+				} // for
+
+				if (position[0] == position[1] || position[1] == position[2] || position[0] == position[2])
+					continue;
+
+				for (int k = 0; k < 3; k++) {
+					result[write + k] = corner[k];
+					triangles[write + k] = position[k];
+
+				} // for
+
+				write += 3;
+
+			} // for
+
+			result.resize(write);
+			triangles.resize(write);
+			std::fill(collapseTo.begin(), collapseTo.end(), NO_POSITION);
+
+		} // while
+
+		if (error != nullptr)
+			*error = static_cast<float>(std::sqrt(largestCost));
+
+		return result;
+
+	} // simplify
+
+} // lve
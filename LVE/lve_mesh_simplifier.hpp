@@ -0,0 +1,26 @@
+#pragma once
+
+#include "lve_model.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+	// quadric error edge collapse (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics")
+	// the result only references vertices that already exist, so every level of detail can share one vertex buffer
+	class LveMeshSimplifier {
+	public:
+		// collapses edges until at most targetIndexCount indices are left or the next collapse would move the surface
+		// further than maxError (model space units), error receives the largest error actually introduced
+		static std::vector<uint32_t> simplify(
+			const std::vector<LveModel::Vertex>& vertices,
+			const std::vector<uint32_t>& indices,
+			size_t targetIndexCount,
+			float maxError,
+			float* error = nullptr);
+
+	}; // LveMeshSimplifier
+
+} // lve
@@ -1,5 +1,10 @@
 #include "lve_model.hpp"
 #include "lve_device.hpp"
+#include "lve_mesh_cache.hpp"
+#include "lve_mesh_optimizer.hpp"
+#include "lve_mesh_simplifier.hpp"
+#include "lve_frustum.hpp"
+#include "lve_obj_parser.hpp"
 
 //libs
 #define TINYOBJLOADER_IMPLEMENTATION 
@@ -8,11 +13,16 @@
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
+#include <glm/gtc/packing.hpp>
 
 // std
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <unordered_map>
 
 namespace std {
@@ -31,105 +41,555 @@ namespace std {
 
 namespace lve { 
 
-	LveModel::LveModel(LveDevice& device, const LveModel::Builder &builder) : lveDevice{device} {
-		createVertexBuffers(builder.vertices);
-		createIndexBuffers(builder.indices);
+	namespace {
+
+		LveModel::Vertex makeVertex(const tinyobj::attrib_t& attrib, const tinyobj::index_t& index) {
+			LveModel::Vertex vertex{};
+
+			if (index.vertex_index >= 0) {
+				vertex.position = {
+					attrib.vertices[3 * index.vertex_index + 0],
+					attrib.vertices[3 * index.vertex_index + 1],
+					attrib.vertices[3 * index.vertex_index + 2]
+
+				}; // vertex.position
+
+				vertex.color = {
+					attrib.colors[3 * index.vertex_index + 0],
+					attrib.colors[3 * index.vertex_index + 1],
+					attrib.colors[3 * index.vertex_index + 2]
+
+				}; // vertex.color
+
+			} // if
+
+			if (index.normal_index >= 0) {
+				vertex.normal = {
+					attrib.normals[3 * index.normal_index + 0],
+					attrib.normals[3 * index.normal_index + 1],
+					attrib.normals[3 * index.normal_index + 2]
+
+				}; // vertex.normal
+
+			} // if (index.normal_index >= 0)
+
+			if (index.texcoord_index >= 0) {
+				vertex.uv = {
+					attrib.texcoords[2 * index.texcoord_index + 0],
+					attrib.texcoords[2 * index.texcoord_index + 1],
+
+				}; // vertex.uv
+
+			} // if (index.texcoord_index >= 0)
+
+			return vertex;
+
+		} // makeVertex
+
+		// open addressing hash table with linear probing from an OBJ index tuple to a vertex index
+		// all entries live in one flat array so a lookup usually touches a single cache line
+		class IndexTupleTable {
+		public:
+			explicit IndexTupleTable(size_t cornerCount) {
+				// most meshes share every position between ~6 corners, start around there and grow if needed
+				size_t capacity = 64;
+				while (capacity < cornerCount / 2)
+					capacity <<= 1;
+
+				entries.resize(capacity);
+				mask = capacity - 1;
+
+			} // IndexTupleTable
+
+			// returns the value already stored for the tuple, or stores and returns value
+			uint32_t findOrInsert(const tinyobj::index_t& index, uint32_t value) {
+				for (size_t slot = hash(index) & mask;; slot = (slot + 1) & mask) {
+					Entry& entry = entries[slot];
+					if (entry.value == EMPTY) {
+						entry = { index.vertex_index, index.normal_index, index.texcoord_index, value };
+						if (++count * 2 > entries.size())
+							grow();
+
+						return value;
+
+					} // if
+
+					if (entry.vertex == index.vertex_index && entry.normal == index.normal_index && entry.texcoord == index.texcoord_index)
+						return entry.value;
+
+				} // for
+
+			} // findOrInsert
+
+		private:
+			static constexpr uint32_t EMPTY = UINT32_MAX;
+
+			struct Entry {
+				int vertex = 0;
+				int normal = 0;
+				int texcoord = 0;
+				uint32_t value = EMPTY;
+
+			}; // Entry
+
+			static size_t hash(const tinyobj::index_t& index) {
+				uint32_t h = static_cast<uint32_t>(index.vertex_index) * 0x9e3779b1u;
+				h ^= static_cast<uint32_t>(index.normal_index) * 0x85ebca77u;
+				h ^= static_cast<uint32_t>(index.texcoord_index) * 0xc2b2ae3du;
+				return h ^ (h >> 16);
+
+			} // hash
+
+			void grow() {
+				std::vector<Entry> old(entries.size() * 2);
+				old.swap(entries);
+				mask = entries.size() - 1;
+
+				for (const Entry& entry : old) {
+					if (entry.value == EMPTY)
+						continue;
+
+					size_t slot = hash({ entry.vertex, entry.normal, entry.texcoord }) & mask;
+					while (entries[slot].value != EMPTY)
+						slot = (slot + 1) & mask;
+
+					entries[slot] = entry;
+
+				} // for
+
+			} // grow
+
+			std::vector<Entry> entries;
+			size_t mask = 0;
+			size_t count = 0;
+
+		}; // IndexTupleTable
+
+		static_assert(sizeof(LveModel::Vertex) == 11 * sizeof(float), "Vertex is compared as a flat array of floats");
+
+		// lexicographic order over every float of the vertex, -0 and 0 compare equal just like Vertex::operator==
+		int compareVertices(const LveModel::Vertex& a, const LveModel::Vertex& b) {
+			const float* x = reinterpret_cast<const float*>(&a);
+			const float* y = reinterpret_cast<const float*>(&b);
+			for (int i = 0; i < 11; i++) {
+				if (x[i] < y[i])
+					return -1;
+
+				if (y[i] < x[i])
+					return 1;
+
+			} // for
+
+			return 0;
+
+		} // compareVertices
+
+		bool hasNaN(const LveModel::Vertex& vertex) {
+			const float* x = reinterpret_cast<const float*>(&vertex);
+			for (int i = 0; i < 11; i++) {
+				if (x[i] != x[i])
+					return true;
+
+			} // for
+
+			return false;
+
+		} // hasNaN
+
+		// merges vertices that are equal but were stored under different index tuples, keeping the first occurrence
+		// sorting with the vertex index as tie breaker puts the first occurrence at the front of every run of equals,
+		// so compacting in order reproduces the vertex order of the hash map path exactly
+		void weldEqualVertices(std::vector<LveModel::Vertex>& vertices, std::vector<uint32_t>& indices) {
+			std::vector<uint32_t> order;
+			order.reserve(vertices.size());
+			for (uint32_t i = 0; i < vertices.size(); i++) {
+				// NaN has no place in a strict weak ordering, those vertices are only welded by index
+				if (!hasNaN(vertices[i]))
+					order.push_back(i);
+
+			} // for
+
+			std::sort(order.begin(), order.end(), [&vertices](uint32_t a, uint32_t b) {
+				int result = compareVertices(vertices[a], vertices[b]);
+				return result != 0 ? result < 0 : a < b;
+
+			}); // sort
+
+			std::vector<uint32_t> first(vertices.size());
+			for (uint32_t i = 0; i < vertices.size(); i++)
+				first[i] = i;
+
+			bool anyWelded = false;
+			for (size_t i = 1; i < order.size(); i++) {
+				if (compareVertices(vertices[order[i - 1]], vertices[order[i]]) == 0) {
+					first[order[i]] = first[order[i - 1]];
+					anyWelded = true;
+
+				} // if
+
+			} // for
+
+			if (!anyWelded)
+				return;
+
+			std::vector<uint32_t> remap(vertices.size());
+			uint32_t count = 0;
+			for (uint32_t i = 0; i < vertices.size(); i++) {
+				if (first[i] == i) {
+					vertices[count] = vertices[i];
+					remap[i] = count++;
+
+				} // if
+				else {
+					remap[i] = remap[first[i]];
+
+				} // else
+
+			} // for
+
+			vertices.resize(count);
+			for (uint32_t& index : indices)
+				index = remap[index];
+
+		} // weldEqualVertices
+
+		// bounding sphere and normal cone of a finished meshlet
+		void computeMeshletBounds(LveModel::Meshlet& meshlet, const std::vector<LveModel::Vertex>& vertices, const std::vector<uint32_t>& indices) {
+			glm::vec3 boundsMin{ std::numeric_limits<float>::max() };
+			glm::vec3 boundsMax{ -std::numeric_limits<float>::max() };
+			for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i++) {
+				boundsMin = glm::min(boundsMin, vertices[indices[i]].position);
+				boundsMax = glm::max(boundsMax, vertices[indices[i]].position);
+
+			} // for
+
+			meshlet.center = (boundsMin + boundsMax) * 0.5f;
+			meshlet.radius = 0.f;
+			for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i++)
+				meshlet.radius = std::max(meshlet.radius, glm::length(vertices[indices[i]].position - meshlet.center));
+
+			// face normals oriented by the vertex normals, so the cone does not depend on the winding convention
+			std::vector<glm::vec3> faceNormals;
+			faceNormals.reserve(meshlet.indexCount / 3);
+			glm::vec3 axis{ 0.f };
+
+			for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.indexCount; i += 3) {
+				const auto& v0 = vertices[indices[i + 0]];
+				const auto& v1 = vertices[indices[i + 1]];
+				const auto& v2 = vertices[indices[i + 2]];
+
+				glm::vec3 normal = glm::cross(v1.position - v0.position, v2.position - v0.position);
+				float length = glm::length(normal);
+				if (length <= 0.f)
+					continue;
+
+				normal /= length;
+				if (glm::dot(normal, v0.normal + v1.normal + v2.normal) < 0.f)
+					normal = -normal;
+
+				faceNormals.push_back(normal);
+				axis += normal;
+
+			} // for
+
+			float axisLength = glm::length(axis);
+			meshlet.coneAxis = axisLength > 0.f ? axis / axisLength : glm::vec3{ 0.f, 0.f, 1.f };
+			meshlet.coneCutoff = 1.f;
+
+			if (faceNormals.empty() || axisLength <= 0.f)
+				return;
+
+			float minDot = 1.f;
+			for (const auto& normal : faceNormals)
+				minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+
+			// a cone of 90 degrees or more can always be seen from the front by some triangle
+			meshlet.coneCutoff = minDot <= 0.f ? 1.f : std::sqrt(1.f - minDot * minDot);
+
+		} // computeMeshletBounds
+
+		// the parts of the config that change the built mesh, a cache written with different ones is rebuilt
+		uint32_t meshCacheFlags(const ModelLoadConfigInfo& configInfo) {
+			uint32_t flags = 0;
+
+			// HashMap and IndexTupleSorted produce the same mesh
+			if (configInfo.weldMode == VertexWeldMode::IndexTuple)
+				flags |= 1u << 0;
+
+			if (configInfo.optimizeMesh)
+				flags |= 1u << 1;
+
+			if (configInfo.buildMeshlets)
+				flags |= 1u << 2;
+
+			if (configInfo.buildLods)
+				flags |= 1u << 3;
+
+			return flags;
+
+		} // meshCacheFlags
+
+		// how far level 1 may drift from the full mesh, as a fraction of the mesh's bounding radius, every further level
+		// is selected at half the screen size and so may drift twice as far for the same error in pixels
+		constexpr float LOD_MAX_ERROR = 0.03f;
+
+		// a level only pays for its index memory when it drops a good part of the previous level's triangles
+		constexpr float LOD_MIN_REDUCTION = 0.75f;
+
+		// the index ranges to work on one level at a time, a builder without levels is one range
+		std::vector<LveModel::Lod> lodRanges(const std::vector<LveModel::Lod>& lods, size_t indexCount) {
+			if (!lods.empty())
+				return lods;
+
+			LveModel::Lod lod{};
+			lod.indexCount = static_cast<uint32_t>(indexCount);
+			return { lod };
+
+		} // lodRanges
+
+	} // namespace
+
+	LveModel::LveModel(LveGeometryPool& geometryPool, const LveModel::Builder &builder, bool compactVertices) : LveModel{ geometryPool, builder.view(), compactVertices } {} // LveModel
+
+	LveModel::LveModel(LveGeometryPool& geometryPool, const MeshView& mesh, bool compactVertices) : geometryPool{ geometryPool } {
+		createVertexBuffers(mesh.vertices, mesh.vertexCount, compactVertices);
+		createIndexBuffers(mesh.indices, mesh.indexCount);
+
+		binding.vertexBuffer = geometryPool.getBuffer(vertexAllocation);
+		if (hasIndexBuffer)
+			binding.indexBuffer = geometryPool.getBuffer(indexAllocation);
+
+		// the pool's defragmenter may move the ranges into another of its buffers, the offsets are patched in place
+		geometryPool.setOwner(vertexAllocation, [this]() { binding.vertexBuffer = this->geometryPool.getBuffer(vertexAllocation); });
+		if (hasIndexBuffer)
+			geometryPool.setOwner(indexAllocation, [this]() { binding.indexBuffer = this->geometryPool.getBuffer(indexAllocation); });
+
+		meshlets.assign(mesh.meshlets, mesh.meshlets + mesh.meshletCount);
+
+		lods.assign(mesh.lods, mesh.lods + mesh.lodCount);
+		if (lods.empty()) {
+			Lod lod{};
+			lod.indexCount = mesh.indexCount;
+			lod.meshletCount = mesh.meshletCount;
+			lods.push_back(lod);
+
+		} // if
+
+		bounds = mesh.bounds != nullptr ? *mesh.bounds : Bounds::compute(mesh.vertices, mesh.vertexCount);
 
 	} // LveModel
 
-	LveModel::~LveModel() {} // ~LveModel
+	LveModel::~LveModel() {
+		// frames still in flight may be drawing the model
+		geometryPool.retire(vertexAllocation);
+		geometryPool.retire(indexAllocation);
+
+	} // ~LveModel
+
+	std::unique_ptr<LveModel> LveModel::createModelFromFile(LveGeometryPool& geometryPool, const std::string& filepath, const ModelLoadConfigInfo& configInfo) {
+		// the binary cache is mapped and copied straight into the staging buffers, no parsing or welding
+		if (auto cache = LveMeshCache::load(filepath, meshCacheFlags(configInfo))) {
+			std::cout << "Vertex count: " << cache->vertexCount() << " (cached)\n";
+			return std::make_unique<LveModel>(geometryPool, cache->view(), configInfo.compactVertices);
+
+		} // if
 
-	std::unique_ptr<LveModel> LveModel::createModelFromFile(LveDevice& device, const std::string& filepath) {
 		Builder builder{};
-		builder.loadModel(filepath);
+		builder.loadModel(filepath, configInfo);
 		std::cout << "Vertex count: " << builder.vertices.size() << "\n";
-		return std::make_unique<LveModel>(device, builder);
+
+		// simplified from the welded mesh so every level is optimized and split into meshlets on its own below
+		if (configInfo.buildLods) {
+			builder.buildLods();
+			std::cout << "LOD triangles:";
+			for (const auto& lod : builder.lods)
+				std::cout << " " << lod.indexCount / 3;
+
+			std::cout << " (" << filepath << ")\n";
+
+		} // if
+
+		if (configInfo.optimizeMesh) {
+			float acmrBefore = LveMeshOptimizer::computeAcmr(builder.indices, builder.vertices.size());
+			builder.optimize();
+			float acmrAfter = LveMeshOptimizer::computeAcmr(builder.indices, builder.vertices.size());
+			std::cout << "ACMR: " << acmrBefore << " -> " << acmrAfter << " (" << filepath << ")\n";
+
+		} // if
+
+		if (configInfo.buildMeshlets) {
+			builder.buildMeshlets();
+			std::cout << "Meshlet count: " << builder.meshlets.size() << "\n";
+
+		} // if
+
+		if (!LveMeshCache::write(filepath, builder, meshCacheFlags(configInfo)))
+			std::cerr << "failed to write mesh cache: " << LveMeshCache::cachePathFor(filepath) << "\n";
+
+		return std::make_unique<LveModel>(geometryPool, builder, configInfo.compactVertices);
 		
 	} // createModelFromFile
 
 	void LveModel::bind(VkCommandBuffer commandBuffer) {
-		VkBuffer buffers[] = { vertexBuffer->getBuffer()};
+		// the whole pool buffers are bound, draws select the model's ranges through firstIndex and vertexOffset
+		VkBuffer buffers[] = { binding.vertexBuffer };
 		VkDeviceSize offsets[] = { 0 };
 		vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
 
 		if (hasIndexBuffer)
-			vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+			vkCmdBindIndexBuffer(commandBuffer, binding.indexBuffer, 0, binding.indexType);
 
 	} // bind
 
-	void LveModel::draw(VkCommandBuffer commandBuffer) {
+	void LveModel::draw(VkCommandBuffer commandBuffer, uint32_t lod, uint32_t instanceCount, uint32_t firstInstance) {
+		assert(lod < lods.size() && "lod out of range");
+
 		if (hasIndexBuffer)
-			vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+			vkCmdDrawIndexed(commandBuffer, lods[lod].indexCount, instanceCount, indexAllocation.offset + lods[lod].firstIndex, static_cast<int32_t>(vertexAllocation.offset), firstInstance);
 		else
-			vkCmdDraw(commandBuffer, vertexCount, 1, 0, 1);
+			vkCmdDraw(commandBuffer, vertexCount, instanceCount, vertexAllocation.offset, firstInstance);
 
 	} // draw
 
-	void LveModel::createVertexBuffers(const std::vector<Vertex>& vertices) {
-		// note: HOST = CPU and DEVICE = GPU
-		vertexCount = static_cast<uint32_t>(vertices.size());
-		assert(vertexCount >= 3 && "Vertex count must be at least 3");
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount; // formula for giving us the total number of bytes 
-		uint32_t vertexSize = sizeof(vertices[0]); // device local memory is faster however the host cannot access this
+	template<typename DrawRange>
+	uint32_t LveModel::cullMeshlets(const LveFrustum& frustum, const glm::vec3& cameraPosition, bool backfaceCulling, uint32_t lod, DrawRange&& draw) const {
+		assert(lod < lods.size() && "lod out of range");
 
-		LveBuffer stagingBuffer{
-			lveDevice,
-			vertexSize,
-			vertexCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		uint32_t drawnMeshlets = 0;
+		uint32_t firstIndex = 0;
+		uint32_t indexCount = 0;
 
-		}; // stagingBuffer
+		for (uint32_t m = lods[lod].firstMeshlet; m < lods[lod].firstMeshlet + lods[lod].meshletCount; m++) {
+			const Meshlet& meshlet = meshlets[m];
+			bool visible = frustum.intersectsSphere(meshlet.center, meshlet.radius);
 
-		stagingBuffer.map();
-		stagingBuffer.writeToBuffer( (void*) vertices.data());
+			// the camera is behind every triangle of the cluster when it sits inside the cone opposite to the
+			// triangles' facing, tested conservatively against the whole bounding sphere
+			if (visible && backfaceCulling) {
+				glm::vec3 toCenter = meshlet.center - cameraPosition;
+				visible = glm::dot(toCenter, meshlet.coneAxis) < meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius;
 
-		vertexBuffer = std::make_unique<LveBuffer>(
-			lveDevice,
-			vertexSize,
-			vertexCount,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+			} // if
 
-		); // vertexBuffer
+			if (!visible)
+				continue;
 
-		// we need to perform a copy operation to move the contents of the staging buffer to the vertex buffer
-		lveDevice.copyBuffer(stagingBuffer.getBuffer(), vertexBuffer->getBuffer(), bufferSize);
-	} // createVertexBuffers
+			drawnMeshlets++;
 
-	void LveModel::createIndexBuffers(const std::vector<uint32_t>& indices) {
-		indexCount = static_cast<uint32_t>(indices.size());
-		hasIndexBuffer = indexCount > 0;
-		if (!hasIndexBuffer)
+			// survivors next to each other in the index buffer become a single draw
+			if (indexCount > 0 && firstIndex + indexCount == meshlet.firstIndex) {
+				indexCount += meshlet.indexCount;
+				continue;
+
+			} // if
+
+			if (indexCount > 0)
+				draw(firstIndex, indexCount);
+
+			firstIndex = meshlet.firstIndex;
+			indexCount = meshlet.indexCount;
+
+		} // for
+
+		if (indexCount > 0)
+			draw(firstIndex, indexCount);
+
+		return drawnMeshlets;
+
+	} // cullMeshlets
+
+	uint32_t LveModel::drawMeshlets(VkCommandBuffer commandBuffer, const LveFrustum& frustum, const glm::vec3& cameraPosition, bool backfaceCulling, uint32_t lod, uint32_t firstInstance) {
+		return cullMeshlets(frustum, cameraPosition, backfaceCulling, lod, [&](uint32_t firstIndex, uint32_t indexCount) {
+			vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexAllocation.offset + firstIndex, static_cast<int32_t>(vertexAllocation.offset), firstInstance);
+
+		}); // cullMeshlets
+
+	} // drawMeshlets
+
+	VkDrawIndexedIndirectCommand LveModel::getDrawCommand(uint32_t lod, uint32_t instanceCount, uint32_t firstInstance) const {
+		assert(lod < lods.size() && "lod out of range");
+		assert(hasIndexBuffer && "indirect commands are indexed");
+
+		return { lods[lod].indexCount, instanceCount, indexAllocation.offset + lods[lod].firstIndex, static_cast<int32_t>(vertexAllocation.offset), firstInstance };
+
+	} // getDrawCommand
+
+	uint32_t LveModel::appendMeshletDrawCommands(std::vector<VkDrawIndexedIndirectCommand>& commands, const LveFrustum& frustum, const glm::vec3& cameraPosition, bool backfaceCulling, uint32_t lod, uint32_t firstInstance) const {
+		return cullMeshlets(frustum, cameraPosition, backfaceCulling, lod, [&](uint32_t firstIndex, uint32_t indexCount) {
+			commands.push_back({ indexCount, 1, indexAllocation.offset + firstIndex, static_cast<int32_t>(vertexAllocation.offset), firstInstance });
+
+		}); // cullMeshlets
+
+	} // appendMeshletDrawCommands
+
+	void LveModel::createVertexBuffers(const Vertex* vertices, uint32_t vertexCount, bool compactVertices) {
+		assert(vertexCount >= 3 && "Vertex count must be at least 3");
+		this->compactVertices = compactVertices;
+
+		if (!compactVertices) {
+			createVertexBuffer(vertices, sizeof(vertices[0]), vertexCount);
 			return;
 
-		VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount; // formula for giving us the total number of bytes 
-		uint32_t indexSize = sizeof(indices[0]); // device local memory is faster however the host cannot access this
+		} // if
 
-		LveBuffer stagingBuffer{
-			lveDevice,
-			indexSize,
-			indexCount,
-			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		// quantize against the bounds of this mesh, a flat axis keeps a unit extent so nothing divides by zero
+		glm::vec3 boundsMin = vertices[0].position;
+		glm::vec3 boundsMax = vertices[0].position;
+		for (uint32_t i = 1; i < vertexCount; i++) {
+			boundsMin = glm::min(boundsMin, vertices[i].position);
+			boundsMax = glm::max(boundsMax, vertices[i].position);
 
-		}; // stagingBuffer
+		} // for
 
-		stagingBuffer.map();
-		stagingBuffer.writeToBuffer((void*)indices.data());
+		glm::vec3 boundsExtent = boundsMax - boundsMin;
+		for (int axis = 0; axis < 3; axis++) {
+			if (boundsExtent[axis] <= 0.f)
+				boundsExtent[axis] = 1.f;
 
+		} // for
 
-		indexBuffer = std::make_unique<LveBuffer>(
-			lveDevice,
-			indexSize, 
-			indexCount,
-			VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT 
+		std::vector<CompactVertex> compact(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			compact[i] = CompactVertex::encode(vertices[i], boundsMin, boundsExtent);
 
-		); // indexBuffer
+		// unorm positions come out of the vertex fetch in [0, 1], scale and offset them back into model space
+		dequantizationMatrix = glm::mat4{ 1.f };
+		dequantizationMatrix[0][0] = boundsExtent.x;
+		dequantizationMatrix[1][1] = boundsExtent.y;
+		dequantizationMatrix[2][2] = boundsExtent.z;
+		dequantizationMatrix[3] = glm::vec4{ boundsMin, 1.f };
 
-		// we need to perform a copy operation to move the contents of the staging buffer to the vertex buffer
-		lveDevice.copyBuffer(stagingBuffer.getBuffer(), indexBuffer->getBuffer(), bufferSize);
+		createVertexBuffer(compact.data(), sizeof(CompactVertex), vertexCount);
+
+	} // createVertexBuffers
+
+	void LveModel::createVertexBuffer(const void* vertexData, uint32_t vertexSize, uint32_t vertexCount) {
+		// device local memory is faster however the host cannot access this, the pool copies through a staging buffer
+		this->vertexCount = vertexCount;
+		vertexAllocation = geometryPool.uploadVertices(vertexData, vertexSize, vertexCount);
+
+	} // createVertexBuffer
+
+	void LveModel::createIndexBuffers(const uint32_t* indices, uint32_t indexCount) {
+		this->indexCount = indexCount;
+		hasIndexBuffer = indexCount > 0;
+		if (!hasIndexBuffer)
+			return;
+
+		// half the index memory and bandwidth when every vertex can be addressed with 16 bits,
+		// createVertexBuffers runs first so vertexCount is already known here, the indices are relative
+		// to the model's first vertex so this holds wherever the pool puts it
+		if (vertexCount < 65536) {
+			std::vector<uint16_t> shortIndices(indices, indices + indexCount);
+			indexAllocation = geometryPool.uploadIndices(shortIndices.data(), sizeof(uint16_t), indexCount);
+			binding.indexType = VK_INDEX_TYPE_UINT16;
+
+		} // if
+		else {
+			indexAllocation = geometryPool.uploadIndices(indices, sizeof(uint32_t), indexCount);
+			binding.indexType = VK_INDEX_TYPE_UINT32;
+
+		} // else
 
 	} // createIndexBuffers
 
@@ -150,64 +610,177 @@ namespace lve {
 		attributeDescriptions.push_back({ 2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal) });
 		attributeDescriptions.push_back({ 3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv) });
 
+		return attributeDescriptions;
+
+	} // getAttributeDescriptions
+
+	std::vector<VkVertexInputBindingDescription> LveModel::CompactVertex::getBindingDescriptions() {
+		std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+		bindingDescriptions[0].binding = 0;
+		bindingDescriptions[0].stride = sizeof(CompactVertex);
+		bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return bindingDescriptions;
+
+	} // getBindingDescriptions
+
+	std::vector<VkVertexInputAttributeDescription> LveModel::CompactVertex::getAttributeDescriptions() {
+		std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+		// same locations as Vertex, the formats expand everything to floats before the shader sees it
+		// the octahedral normal arrives as (x, y, 0) and is unfolded in simple_shader.vert
+		attributeDescriptions.push_back({ 0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(CompactVertex, position) });
+		attributeDescriptions.push_back({ 1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(CompactVertex, color) });
+		attributeDescriptions.push_back({ 2, 0, VK_FORMAT_R16G16_SNORM, offsetof(CompactVertex, normal) });
+		attributeDescriptions.push_back({ 3, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(CompactVertex, uv) });
 
 		return attributeDescriptions;
 
 	} // getAttributeDescriptions
 
-	void LveModel::Builder::loadModel(const std::string& filepath) {
-		tinyobj::attrib_t attrib;
-		std::vector<tinyobj::shape_t> shapes;
-		std::vector<tinyobj::material_t> materials;
-		std::string warn, err;
+	LveModel::Instance LveModel::Instance::make(const glm::mat4& modelMatrix, const glm::mat3& normalMatrix) {
+		static_assert(sizeof(Instance) == 80, "Instance has to match the std430 array stride in the shaders");
 
-		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) 
-			throw std::runtime_error(warn + err);
-		
-		vertices.clear();
-		indices.clear();
+		Instance instance{};
+		for (int row = 0; row < 3; row++)
+			instance.modelRows[row] = glm::vec4(modelMatrix[0][row], modelMatrix[1][row], modelMatrix[2][row], modelMatrix[3][row]);
 
-		std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+		float largest = 0.f;
+		for (int column = 0; column < 3; column++) {
+			for (int row = 0; row < 3; row++)
+				largest = std::max(largest, std::abs(normalMatrix[column][row]));
 
-		for (const auto& shape : shapes) {
-			for (const auto& index : shape.mesh.indices) {
-				Vertex vertex{};
+		} // for
 
-				if (index.vertex_index >= 0) {
-					vertex.position = {
-						attrib.vertices[3 * index.vertex_index + 0],
-						attrib.vertices[3 * index.vertex_index + 1],
-						attrib.vertices[3 * index.vertex_index + 2]
+		float scale = largest > 0.f ? 1.f / largest : 1.f;
+		for (int element = 0; element < 9; element++) {
+			uint32_t half = glm::packHalf1x16(normalMatrix[element / 3][element % 3] * scale);
+			instance.normalMatrix[element / 2] |= half << (element % 2 * 16);
 
-					}; // vertex.position
+		} // for
 
-					vertex.color = {
-						attrib.colors[3 * index.vertex_index + 0],
-						attrib.colors[3 * index.vertex_index + 1],
-						attrib.colors[3 * index.vertex_index + 2]
+		return instance;
 
-					}; // vertex.position
+	} // make
 
-				} // if
+	LveModel::CompactVertex LveModel::CompactVertex::encode(const Vertex& vertex, const glm::vec3& boundsMin, const glm::vec3& boundsExtent) {
+		CompactVertex compact{};
+
+		glm::vec3 position = glm::clamp((vertex.position - boundsMin) / boundsExtent, 0.f, 1.f);
+		for (int i = 0; i < 3; i++)
+			compact.position[i] = static_cast<uint16_t>(std::lround(position[i] * 65535.f));
+
+		// octahedral mapping: project onto |x| + |y| + |z| = 1 and fold the lower half over the diagonals
+		glm::vec3 normal = vertex.normal;
+		float l1 = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+		glm::vec2 octahedral{ 0.f, 0.f };
+		if (l1 > 0.f) {
+			octahedral = { normal.x / l1, normal.y / l1 };
+			if (normal.z < 0.f) {
+				octahedral = {
+					(1.f - std::fabs(octahedral.y)) * (octahedral.x >= 0.f ? 1.f : -1.f),
+					(1.f - std::fabs(octahedral.x)) * (octahedral.y >= 0.f ? 1.f : -1.f)
+
+				}; // octahedral
+
+			} // if
+
+		} // if
+
+		for (int i = 0; i < 2; i++)
+			compact.normal[i] = static_cast<int16_t>(std::lround(glm::clamp(octahedral[i], -1.f, 1.f) * 32767.f));
+
+		glm::vec3 color = glm::clamp(vertex.color, 0.f, 1.f);
+		for (int i = 0; i < 3; i++)
+			compact.color[i] = static_cast<uint8_t>(std::lround(color[i] * 255.f));
+
+		compact.color[3] = 255;
+
+		compact.uv[0] = glm::packHalf1x16(vertex.uv.x);
+		compact.uv[1] = glm::packHalf1x16(vertex.uv.y);
+
+		return compact;
+
+	} // encode
+
+	// CPU mirror of the vertex input formats and simple_shader.vert, used to check the encoding
+	LveModel::Vertex LveModel::CompactVertex::decode(const glm::vec3& boundsMin, const glm::vec3& boundsExtent) const {
+		Vertex vertex{};
+
+		for (int i = 0; i < 3; i++)
+			vertex.position[i] = boundsMin[i] + position[i] / 65535.f * boundsExtent[i];
+
+		glm::vec3 n{
+			std::max(normal[0] / 32767.f, -1.f),
+			std::max(normal[1] / 32767.f, -1.f),
+			0.f
+
+		}; // n
+
+		n.z = 1.f - std::fabs(n.x) - std::fabs(n.y);
+		float t = std::max(-n.z, 0.f);
+		n.x += n.x >= 0.f ? -t : t;
+		n.y += n.y >= 0.f ? -t : t;
+		vertex.normal = glm::normalize(n);
+
+		for (int i = 0; i < 3; i++)
+			vertex.color[i] = color[i] / 255.f;
+
+		vertex.uv = { glm::unpackHalf1x16(uv[0]), glm::unpackHalf1x16(uv[1]) };
+
+		return vertex;
 
-				if (index.normal_index >= 0) {
-					vertex.normal = {
-						attrib.normals[3 * index.normal_index + 0],
-						attrib.normals[3 * index.normal_index + 1],
-						attrib.normals[3 * index.normal_index + 2]
+	} // decode
 
-					}; // vertex.normal
+	LveModel::Bounds LveModel::Bounds::compute(const Vertex* vertices, uint32_t vertexCount) {
+		Bounds bounds{};
+		if (vertexCount == 0)
+			return bounds;
 
-				} // if (index.normal_index >= 0)
+		bounds.min = vertices[0].position;
+		bounds.max = vertices[0].position;
+		for (uint32_t i = 1; i < vertexCount; i++) {
+			bounds.min = glm::min(bounds.min, vertices[i].position);
+			bounds.max = glm::max(bounds.max, vertices[i].position);
 
-				if (index.texcoord_index >= 0) {
-					vertex.uv = {
-						attrib.texcoords[2 * index.texcoord_index + 0],
-						attrib.texcoords[2 * index.texcoord_index + 1],
+		} // for
 
-					}; // vertex.normal
+		// centered on the box rather than the minimal sphere, good enough to size the model on screen
+		bounds.center = (bounds.min + bounds.max) * 0.5f;
+		for (uint32_t i = 0; i < vertexCount; i++)
+			bounds.radius = std::max(bounds.radius, glm::length(vertices[i].position - bounds.center));
 
-				} // if (index.texcoord_index >= 0)
+		return bounds;
+
+	} // compute
+
+	void LveModel::Builder::loadModel(const std::string& filepath, const ModelLoadConfigInfo& configInfo) {
+		LveObjData obj{};
+		if (configInfo.parserThreadCount == 1 || !LveObjParser::load(filepath, configInfo.parserThreadCount, obj))
+			LveObjParser::loadWithTinyObj(filepath, obj);
+
+		if (!obj.warning.empty())
+			std::cerr << "warning: " << filepath << ": " << obj.warning;
+
+		weldVertices(obj, configInfo.weldMode);
+		computeBounds();
+
+	} // loadModel
+
+	void LveModel::Builder::computeBounds() {
+		bounds = Bounds::compute(vertices.data(), static_cast<uint32_t>(vertices.size()));
+
+	} // computeBounds
+
+	void LveModel::Builder::weldVertices(const LveObjData& obj, VertexWeldMode weldMode) {
+		vertices.clear();
+		indices.clear();
+		indices.reserve(obj.indices.size());
+
+		if (weldMode == VertexWeldMode::HashMap) {
+			std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+
+			for (const auto& index : obj.indices) {
+				Vertex vertex = makeVertex(obj.attrib, index);
 
 				if (uniqueVertices.count(vertex) == 0) {
 					uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
@@ -217,10 +790,175 @@ namespace lve {
 
 				indices.push_back(uniqueVertices[vertex]);
 
-			} // for (const auto& index : shape.mesh.indices)
+			} // for (const auto& index : obj.indices)
+
+			return;
 
-		} // for (const auto& shape : shapes)
+		} // if (weldMode == VertexWeldMode::HashMap)
 
-	} // loadModel
+		// corners sharing the same index tuple always build the same vertex, so only the first one is assembled
+		IndexTupleTable table{ obj.indices.size() };
+		for (const auto& index : obj.indices) {
+			uint32_t nextVertex = static_cast<uint32_t>(vertices.size());
+			uint32_t vertexIndex = table.findOrInsert(index, nextVertex);
+			if (vertexIndex == nextVertex)
+				vertices.push_back(makeVertex(obj.attrib, index));
+
+			indices.push_back(vertexIndex);
+
+		} // for (const auto& index : obj.indices)
+
+		if (weldMode == VertexWeldMode::IndexTupleSorted)
+			weldEqualVertices(vertices, indices);
+
+	} // weldVertices
+
+	LveModel::MeshView LveModel::Builder::view() const {
+		MeshView mesh{};
+		mesh.vertices = vertices.data();
+		mesh.vertexCount = static_cast<uint32_t>(vertices.size());
+		mesh.indices = indices.data();
+		mesh.indexCount = static_cast<uint32_t>(indices.size());
+		mesh.meshlets = meshlets.data();
+		mesh.meshletCount = static_cast<uint32_t>(meshlets.size());
+		mesh.lods = lods.data();
+		mesh.lodCount = static_cast<uint32_t>(lods.size());
+		mesh.bounds = &bounds;
+		return mesh;
+
+	} // view
+
+	void LveModel::Builder::buildLods() {
+		lods.clear();
+		meshlets.clear();
+
+		Lod full{};
+		full.indexCount = static_cast<uint32_t>(indices.size());
+		lods.push_back(full);
+
+		if (vertices.empty())
+			return;
+
+		glm::vec3 boundsMin = vertices[0].position;
+		glm::vec3 boundsMax = vertices[0].position;
+		for (const auto& vertex : vertices) {
+			boundsMin = glm::min(boundsMin, vertex.position);
+			boundsMax = glm::max(boundsMax, vertex.position);
+
+		} // for
+
+		float maxError = LOD_MAX_ERROR * glm::length(boundsMax - boundsMin) * 0.5f;
+		size_t triangleCount = indices.size() / 3;
+
+		// every level is simplified from the previous one, so the errors add up along the chain
+		std::vector<uint32_t> source = indices;
+		for (uint32_t level = 1; level < MAX_LODS; level++) {
+			size_t targetIndexCount = static_cast<size_t>(triangleCount * LOD_TRIANGLE_RATIOS[level]) * 3;
+
+			float error = 0.f;
+			std::vector<uint32_t> simplified = LveMeshSimplifier::simplify(vertices, source, targetIndexCount, maxError - lods.back().error, &error);
+			maxError *= 2.f;
+			if (simplified.empty() || simplified.size() > source.size() * LOD_MIN_REDUCTION)
+				break;
+
+			Lod lod{};
+			lod.firstIndex = static_cast<uint32_t>(indices.size());
+			lod.indexCount = static_cast<uint32_t>(simplified.size());
+			lod.error = lods.back().error + error;
+			lods.push_back(lod);
+
+			indices.insert(indices.end(), simplified.begin(), simplified.end());
+			source.swap(simplified);
+
+		} // for
+
+	} // buildLods
+
+	void LveModel::Builder::buildMeshlets() {
+		meshlets.clear();
+		std::vector<Lod> ranges = lodRanges(lods, indices.size());
+
+		// greedy split in index order, after Builder::optimize neighbouring triangles are already spatially close
+		std::vector<uint32_t> meshletOfVertex(vertices.size(), UINT32_MAX);
+		uint32_t meshletVertices = 0;
+		Meshlet meshlet{};
+
+		auto finishMeshlet = [this, &meshlet]() {
+			computeMeshletBounds(meshlet, vertices, indices);
+			meshlets.push_back(meshlet);
+
+		}; // finishMeshlet
+
+		// vertices of the triangle the meshlet does not reference yet, a degenerate triangle repeats one
+		auto countNewVertices = [&meshletOfVertex](const uint32_t* triangle, uint32_t id) {
+			uint32_t count = meshletOfVertex[triangle[0]] != id ? 1 : 0;
+			if (meshletOfVertex[triangle[1]] != id && triangle[1] != triangle[0])
+				count++;
+
+			if (meshletOfVertex[triangle[2]] != id && triangle[2] != triangle[0] && triangle[2] != triangle[1])
+				count++;
+
+			return count;
+
+		}; // countNewVertices
+
+		// every level gets its own meshlets, none of them straddles two levels
+		for (auto& range : ranges) {
+			range.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+			meshlet = Meshlet{};
+			meshlet.firstIndex = range.firstIndex;
+			meshletVertices = 0;
+
+			for (uint32_t first = range.firstIndex; first + 3 <= range.firstIndex + range.indexCount; first += 3) {
+				uint32_t id = static_cast<uint32_t>(meshlets.size());
+				const uint32_t* triangle = &indices[first];
+				uint32_t newVertices = countNewVertices(triangle, id);
+
+				if (meshlet.indexCount > 0 && (meshletVertices + newVertices > MAX_MESHLET_VERTICES || meshlet.indexCount / 3 + 1 > MAX_MESHLET_TRIANGLES)) {
+					finishMeshlet();
+
+					id++;
+					meshlet = Meshlet{};
+					meshlet.firstIndex = first;
+					meshletVertices = 0;
+					newVertices = countNewVertices(triangle, id);
+
+				} // if
+
+				for (int k = 0; k < 3; k++)
+					meshletOfVertex[triangle[k]] = id;
+
+				meshletVertices += newVertices;
+				meshlet.indexCount += 3;
+
+			} // for
+
+			if (meshlet.indexCount > 0)
+				finishMeshlet();
+
+			range.meshletCount = static_cast<uint32_t>(meshlets.size()) - range.firstMeshlet;
+
+		} // for
+
+		if (!lods.empty())
+			lods.swap(ranges);
+
+	} // buildMeshlets
+
+	void LveModel::Builder::optimize() {
+		// order matters: overdraw works on the cache friendly runs, and the fetch remap has to see the final triangle order
+		// levels of detail are drawn on their own, so their triangles are reordered per level and never mixed
+		for (const auto& range : lodRanges(lods, indices.size())) {
+			std::vector<uint32_t> levelIndices(indices.begin() + range.firstIndex, indices.begin() + range.firstIndex + range.indexCount);
+			LveMeshOptimizer::optimizeVertexCache(levelIndices, vertices.size());
+			LveMeshOptimizer::optimizeOverdraw(levelIndices, vertices);
+			std::copy(levelIndices.begin(), levelIndices.end(), indices.begin() + range.firstIndex);
+
+		} // for
+
+		// level 0 comes first in the index buffer, so its fetch order wins, the coarser levels only use vertices it already placed
+		LveMeshOptimizer::optimizeVertexFetch(vertices, indices);
+
+	} // optimize
 
 } // lve
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "lve_device.hpp"
 #include "lve_buffer.hpp"
+#include "lve_geometry_pool.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS // forces in radians and not degrees
@@ -9,10 +10,44 @@
 #include <glm/glm.hpp>
 
 // stds
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <string>
 
 namespace lve {
+
+	struct LveObjData;
+	class LveFrustum;
+
+	// how Builder::loadModel merges the face corners of an .obj into unique vertices
+	enum class VertexWeldMode {
+		HashMap, // std::unordered_map keyed on the whole Vertex, the original path
+		IndexTuple, // flat table keyed on the (vertex, normal, texcoord) indices, keeps duplicates stored under different indices
+		IndexTupleSorted, // IndexTuple followed by a sort based weld of equal vertices, same output as HashMap
+
+	}; // VertexWeldMode
+
+	// knobs for loading a model from disk
+	struct ModelLoadConfigInfo {
+		// threads used to parse the .obj, 0 = one per hardware thread, 1 = the single threaded tinyobj path
+		uint32_t parserThreadCount = 0;
+		VertexWeldMode weldMode = VertexWeldMode::IndexTupleSorted;
+
+		// reorder triangles for the vertex cache and overdraw and vertices for fetch locality after welding
+		bool optimizeMesh = false;
+
+		// upload LveModel::CompactVertex instead of Vertex, only changes the GPU copy so the mesh cache is shared
+		bool compactVertices = false;
+
+		// split the triangles into LveModel::Meshlet clusters that can be culled before drawing
+		bool buildMeshlets = false;
+
+		// append simplified levels of detail (LveModel::LOD_TRIANGLE_RATIOS of the triangles) to the index buffer
+		bool buildLods = false;
+
+	}; // ModelLoadConfigInfo
+
 	class LveModel {
 	
 	public:
@@ -36,39 +71,188 @@ namespace lve {
 
 		}; // Vertex
 
+		// opt-in 20 byte layout of Vertex, decoded by the vertex input formats and simple_shader.vert
+		// positions are unorm16 inside the mesh bounds (getDequantizationMatrix maps them back to model space),
+		// normals are octahedral snorm16, colors rgba8 unorm and uvs half floats
+		struct CompactVertex {
+			uint16_t position[4]{}; // w is padding, R16G16B16 formats are rarely supported for vertex input
+			int16_t normal[2]{};
+			uint8_t color[4]{};
+			uint16_t uv[2]{};
+
+			static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
+			static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
+
+			static CompactVertex encode(const Vertex& vertex, const glm::vec3& boundsMin, const glm::vec3& boundsExtent);
+			Vertex decode(const glm::vec3& boundsMin, const glm::vec3& boundsExtent) const;
+
+		}; // CompactVertex
+
+		// per object data, one per drawn object in a storage buffer at set 1 of the simple render system, std430 layout of
+		// Instance in simple_shader.vert and cull.comp, the vertex shader picks it with gl_InstanceIndex, which starts
+		// at firstInstance, so every object sharing a model is a single instanced or indirect draw
+		struct Instance {
+			glm::vec4 modelRows[3]{ { 1.f, 0.f, 0.f, 0.f }, { 0.f, 1.f, 0.f, 0.f }, { 0.f, 0.f, 1.f, 0.f } }; // mat3x4, the last row is always 0 0 0 1
+			uint32_t normalMatrix[5]{}; // the mat3 column by column as half floats, two to a uint
+			uint32_t padding[3]{};
+
+			// normalMatrix is scaled so its largest element is 1, the shader normalizes the normals anyway and the
+			// halves cannot overflow on tiny scales
+			static Instance make(const glm::mat4& modelMatrix, const glm::mat3& normalMatrix);
+
+		}; // Instance
+
+		// a cluster of at most MAX_MESHLET_VERTICES vertices and MAX_MESHLET_TRIANGLES triangles, everything in model space
+		// the triangles are a contiguous range of the index buffer, so a meshlet is drawn with a plain vkCmdDrawIndexed
+		// and needs no mesh shader support
+		struct Meshlet {
+			glm::vec3 center{}; // bounding sphere
+			float radius = 0.f;
+			glm::vec3 coneAxis{}; // average facing of the triangles
+			float coneCutoff = 1.f; // sine of the cone half angle, 1 = the cone is too wide to ever be back facing
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+
+		}; // Meshlet
+
+		static constexpr uint32_t MAX_MESHLET_VERTICES = 64;
+		static constexpr uint32_t MAX_MESHLET_TRIANGLES = 124;
+
+		// one level of detail, every level shares the vertex buffer and owns a range of the index buffer and the meshlets
+		// level 0 is the full mesh, the following ones have fewer triangles
+		struct Lod {
+			uint32_t firstIndex = 0;
+			uint32_t indexCount = 0;
+			uint32_t firstMeshlet = 0;
+			uint32_t meshletCount = 0;
+			float error = 0.f; // how far the surface may be from the full mesh, in model space
+
+		}; // Lod
+
+		// axis aligned box and the sphere around its center, both in model space
+		struct Bounds {
+			glm::vec3 min{ 0.f };
+			glm::vec3 max{ 0.f };
+			glm::vec3 center{ 0.f };
+			float radius = 0.f;
+
+			static Bounds compute(const Vertex* vertices, uint32_t vertexCount);
+
+		}; // Bounds
+
+		static constexpr uint32_t MAX_LODS = 4;
+		static constexpr float LOD_TRIANGLE_RATIOS[MAX_LODS] = { 1.f, 0.5f, 0.25f, 0.12f };
+
+		// non-owning view of what a model is created from, filled from a Builder or straight from a mapped mesh cache
+		struct MeshView {
+			const Vertex* vertices = nullptr;
+			uint32_t vertexCount = 0;
+			const uint32_t* indices = nullptr;
+			uint32_t indexCount = 0;
+			const Meshlet* meshlets = nullptr;
+			uint32_t meshletCount = 0;
+			const Lod* lods = nullptr;
+			uint32_t lodCount = 0; // 0 = only the full mesh
+			const Bounds* bounds = nullptr; // nullptr = computed from the vertices
+
+		}; // MeshView
+
 		// this is a temporary builder object storing our vertex and index information until it can be copied over to the model's index and buffer index memory
 		struct Builder {
 			std::vector<Vertex> vertices{};
 			std::vector<uint32_t> indices {};
+			std::vector<Meshlet> meshlets{};
+			std::vector<Lod> lods{}; // empty = the indices are a single level
+			Bounds bounds{};
+
+			void loadModel(const std::string& filepath, const ModelLoadConfigInfo& configInfo = {});
+			void weldVertices(const LveObjData& obj, VertexWeldMode weldMode);
+			void computeBounds(); // loadModel calls it, only needed again after changing the vertices by hand
+			void buildLods();
+			void optimize();
+			void buildMeshlets();
 
-			void loadModel(const std::string& filepath);
+			MeshView view() const;
 
 		}; // Data
 
-		LveModel(LveDevice& lveDevice, const LveModel::Builder &builder);
+		// the model only holds ranges of the pool's buffers and gives them back when it is destroyed, the pool keeps
+		// pointers to them to patch them when it defragments, so models never move
+		LveModel(LveGeometryPool& geometryPool, const LveModel::Builder &builder, bool compactVertices = false);
+		LveModel(LveGeometryPool& geometryPool, const MeshView& mesh, bool compactVertices = false);
 		~LveModel();
 
 		LveModel(const LveModel&) = delete;
 		LveModel& operator=(const LveModel&) = delete;
 
-		static std::unique_ptr<LveModel> createModelFromFile(LveDevice& device, const std::string& filepath);
+		static std::unique_ptr<LveModel> createModelFromFile(LveGeometryPool& geometryPool, const std::string& filepath, const ModelLoadConfigInfo& configInfo = {});
 
+		// models with the same binding share their buffers, bind only has to be called when it changes between draws
+		const LveGeometryPool::Binding& getBinding() const { return binding; } // getBinding
 		void bind(VkCommandBuffer commandBuffer);
-		void draw(VkCommandBuffer commandBuffer);
+
+		// false while the vertex or index upload is still in flight, the model must not be drawn until then
+		bool isResident() const { return geometryPool.isResident(vertexAllocation) && geometryPool.isResident(indexAllocation); } // isResident
+
+		// firstInstance is the index of the first object's Instance in the storage buffer bound for the draw
+		void draw(VkCommandBuffer commandBuffer, uint32_t lod = 0, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+
+		// draws only the meshlets of the lod that survive frustum and (optionally) backface cone culling, adjacent survivors
+		// are merged into one draw, frustum and cameraPosition have to be in model space, returns the meshlets drawn
+		// the culling is for one object, so only a single instance is drawn
+		uint32_t drawMeshlets(VkCommandBuffer commandBuffer, const LveFrustum& frustum, const glm::vec3& cameraPosition, bool backfaceCulling, uint32_t lod = 0, uint32_t firstInstance = 0);
+
+		// the draws of draw and drawMeshlets appended as records for vkCmdDrawIndexedIndirect instead of being recorded,
+		// only for models with an index buffer, appendMeshletDrawCommands returns the meshlets drawn like drawMeshlets
+		VkDrawIndexedIndirectCommand getDrawCommand(uint32_t lod = 0, uint32_t instanceCount = 1, uint32_t firstInstance = 0) const;
+		void appendDrawCommand(std::vector<VkDrawIndexedIndirectCommand>& commands, uint32_t lod = 0, uint32_t instanceCount = 1, uint32_t firstInstance = 0) const {
+			commands.push_back(getDrawCommand(lod, instanceCount, firstInstance));
+
+		} // appendDrawCommand
+		uint32_t appendMeshletDrawCommands(std::vector<VkDrawIndexedIndirectCommand>& commands, const LveFrustum& frustum, const glm::vec3& cameraPosition, bool backfaceCulling, uint32_t lod = 0, uint32_t firstInstance = 0) const;
+
+		uint32_t getLodCount() const { return static_cast<uint32_t>(lods.size()); } // getLodCount
+		const Lod& getLod(uint32_t lod) const { return lods[lod]; } // getLod
+
+		// bounding box and sphere of the vertices in model space
+		const Bounds& getBounds() const { return bounds; } // getBounds
+		const glm::vec3& getBoundingCenter() const { return bounds.center; } // getBoundingCenter
+		float getBoundingRadius() const { return bounds.radius; } // getBoundingRadius
+
+		bool hasMeshlets() const { return !meshlets.empty(); } // hasMeshlets
+		uint32_t getMeshletCount() const { return static_cast<uint32_t>(meshlets.size()); } // getMeshletCount
+
+		bool hasIndices() const { return hasIndexBuffer; } // hasIndices
+		bool hasCompactVertices() const { return compactVertices; } // hasCompactVertices
+
+		// maps vertex buffer positions to model space, the identity unless the vertices are compact
+		const glm::mat4& getDequantizationMatrix() const { return dequantizationMatrix; } // getDequantizationMatrix
 
 
 	private:
-		LveDevice& lveDevice;
+		LveGeometryPool& geometryPool;
 
-		std::unique_ptr<LveBuffer> vertexBuffer;
+		LveGeometryPool::Allocation vertexAllocation;
 		uint32_t vertexCount;
+		bool compactVertices = false;
+		glm::mat4 dequantizationMatrix{ 1.f };
 
-		void createVertexBuffers(const std::vector<Vertex>& vertices);
-		void createIndexBuffers(const std::vector<uint32_t>& indices);
+		void createVertexBuffers(const Vertex* vertices, uint32_t vertexCount, bool compactVertices);
+		void createVertexBuffer(const void* vertexData, uint32_t vertexSize, uint32_t vertexCount);
+		void createIndexBuffers(const uint32_t* indices, uint32_t indexCount);
+
+		// calls draw(firstIndex, indexCount) for every run of adjacent meshlets of the lod that survives culling
+		template<typename DrawRange>
+		uint32_t cullMeshlets(const LveFrustum& frustum, const glm::vec3& cameraPosition, bool backfaceCulling, uint32_t lod, DrawRange&& draw) const;
 
 		bool hasIndexBuffer = false;
-		std::unique_ptr<LveBuffer> indexBuffer;
+		LveGeometryPool::Allocation indexAllocation;
 		uint32_t indexCount;
+		LveGeometryPool::Binding binding{}; // the index type is 16 bit whenever every vertex fits
+
+		std::vector<Meshlet> meshlets;
+		std::vector<Lod> lods; // never empty, level 0 covers the full mesh
+		Bounds bounds{};
 
 	}; // LveModel
 
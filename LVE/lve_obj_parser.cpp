@@ -0,0 +1,558 @@
+#include "lve_obj_parser.hpp"
+#include "lve_mesh_cache.hpp"
+
+// std
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace lve {
+
+	namespace {
+
+		// chunks smaller than this are not worth a thread of their own
+		constexpr size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+		constexpr uint8_t RELATIVE_VERTEX = 1 << 0;
+		constexpr uint8_t RELATIVE_TEXCOORD = 1 << 1;
+		constexpr uint8_t RELATIVE_NORMAL = 1 << 2;
+
+		// a normal or texcoord index that points outside of its array, -1 already means the corner has none
+		constexpr int INVALID_INDEX = -2;
+
+		// a face corner as written in the file, negative OBJ indices are relative to the attributes read so far
+		// which a worker only knows for its own chunk, so they are resolved once every chunk has been counted
+		struct RawCorner {
+			int vertex;
+			int texcoord;
+			int normal;
+			uint8_t relative;
+
+		}; // RawCorner
+
+		struct Chunk {
+			const char* begin = nullptr;
+			const char* end = nullptr;
+
+			// thread local buffers, appended to the shared attributes in chunk order
+			std::vector<tinyobj::real_t> positions;
+			std::vector<tinyobj::real_t> colors;
+			std::vector<tinyobj::real_t> normals;
+			std::vector<tinyobj::real_t> texcoords;
+			std::vector<RawCorner> corners;
+			std::vector<uint32_t> faceSizes;
+
+			// number of attributes in all of the chunks before this one
+			int vertexBase = 0;
+			int normalBase = 0;
+			int texcoordBase = 0;
+
+			std::vector<tinyobj::index_t> triangles;
+			uint32_t invalidFaces = 0; // with a position index out of range
+			bool needsTinyObj = false;
+			std::string error;
+
+		}; // Chunk
+
+		inline bool isSpace(char c) { return c == ' ' || c == '\t'; }
+		inline bool isLineEnd(char c) { return c == '\n' || c == '\r'; }
+
+		// same contract as tinyobj's parseReal: the token runs to the next blank and a token that is not a number
+		// reports false, std::from_chars does the conversion without locale lookups or allocations
+		bool tryParseReal(const char*& p, const char* end, tinyobj::real_t& out) {
+			while (p < end && isSpace(*p))
+				p++;
+
+			const char* tokenEnd = p;
+			while (tokenEnd < end && !isSpace(*tokenEnd) && !isLineEnd(*tokenEnd))
+				tokenEnd++;
+
+			const char* first = p;
+			if (first < tokenEnd && *first == '+')
+				first++;
+
+			p = tokenEnd;
+
+			double value = 0.0;
+			auto result = std::from_chars(first, tokenEnd, value);
+			if (first == tokenEnd || result.ec != std::errc{})
+				return false;
+
+			out = static_cast<tinyobj::real_t>(value);
+			return true;
+
+		} // tryParseReal
+
+		tinyobj::real_t parseReal(const char*& p, const char* end, tinyobj::real_t defaultValue) {
+			tinyobj::real_t value = defaultValue;
+			tryParseReal(p, end, value);
+			return value;
+
+		} // parseReal
+
+		// atoi semantics, then skip to the next separator like tinyobj's parseTriple does
+		int parseInt(const char*& p, const char* end) {
+			bool negative = false;
+			if (p < end && (*p == '-' || *p == '+')) {
+				negative = *p == '-';
+				p++;
+
+			} // if
+
+			int value = 0;
+			while (p < end && *p >= '0' && *p <= '9') {
+				value = value * 10 + (*p - '0');
+				p++;
+
+			} // while
+
+			while (p < end && *p != '/' && !isSpace(*p) && !isLineEnd(*p))
+				p++;
+
+			return negative ? -value : value;
+
+		} // parseInt
+
+		// zero based index, -1 for a missing texcoord/normal, relative indices are kept chunk local for now
+		bool fixIndex(int index, int localCount, bool allowZero, int& out, uint8_t& relative, uint8_t relativeBit) {
+			if (index > 0) {
+				out = index - 1;
+				return true;
+
+			} // if
+
+			if (index == 0) {
+				out = -1;
+				return allowZero;
+
+			} // if
+
+			out = localCount + index;
+			relative |= relativeBit;
+			return true;
+
+		} // fixIndex
+
+		bool parseCorner(const char*& p, const char* end, const Chunk& chunk, RawCorner& corner) {
+			int vertexCount = static_cast<int>(chunk.positions.size() / 3);
+			int normalCount = static_cast<int>(chunk.normals.size() / 3);
+			int texcoordCount = static_cast<int>(chunk.texcoords.size() / 2);
+
+			corner = { -1, -1, -1, 0 };
+			if (!fixIndex(parseInt(p, end), vertexCount, false, corner.vertex, corner.relative, RELATIVE_VERTEX))
+				return false;
+
+			if (p >= end || *p != '/')
+				return true;
+
+			p++;
+
+			// i//k
+			if (p < end && *p == '/') {
+				p++;
+				return fixIndex(parseInt(p, end), normalCount, true, corner.normal, corner.relative, RELATIVE_NORMAL);
+
+			} // if
+
+			// i/j/k or i/j
+			if (!fixIndex(parseInt(p, end), texcoordCount, true, corner.texcoord, corner.relative, RELATIVE_TEXCOORD))
+				return false;
+
+			if (p >= end || *p != '/')
+				return true;
+
+			p++;
+			return fixIndex(parseInt(p, end), normalCount, true, corner.normal, corner.relative, RELATIVE_NORMAL);
+
+		} // parseCorner
+
+		void parseChunk(Chunk& chunk) {
+			const char* p = chunk.begin;
+			const char* end = chunk.end;
+
+			while (p < end) {
+				const char* lineEnd = p;
+				while (lineEnd < end && !isLineEnd(*lineEnd))
+					lineEnd++;
+
+				const char* token = p;
+				p = lineEnd + 1;
+
+				while (token < lineEnd && isSpace(*token))
+					token++;
+
+				if (lineEnd - token < 2)
+					continue;
+
+				// vertex, with the tinyobj vertex color extension (x y z r g b)
+				if (token[0] == 'v' && isSpace(token[1])) {
+					token += 2;
+					chunk.positions.push_back(parseReal(token, lineEnd, 0.f));
+					chunk.positions.push_back(parseReal(token, lineEnd, 0.f));
+					chunk.positions.push_back(parseReal(token, lineEnd, 0.f));
+
+					// tinyobj stores w in red and keeps green and blue at 1 for the 4 component form
+					tinyobj::real_t r = 1.f, g = 1.f, b = 1.f;
+					if (tryParseReal(token, lineEnd, r)) {
+						if (tryParseReal(token, lineEnd, g)) {
+							if (!tryParseReal(token, lineEnd, b))
+								r = g = b = 1.f;
+
+						} // if
+						else {
+							g = b = 1.f;
+
+						} // else
+
+					} // if
+
+					chunk.colors.push_back(r);
+					chunk.colors.push_back(g);
+					chunk.colors.push_back(b);
+					continue;
+
+				} // if
+
+				if (lineEnd - token < 3 && token[0] != 'f')
+					continue;
+
+				// normal
+				if (token[0] == 'v' && token[1] == 'n' && isSpace(token[2])) {
+					token += 3;
+					chunk.normals.push_back(parseReal(token, lineEnd, 0.f));
+					chunk.normals.push_back(parseReal(token, lineEnd, 0.f));
+					chunk.normals.push_back(parseReal(token, lineEnd, 0.f));
+					continue;
+
+				} // if
+
+				// texcoord
+				if (token[0] == 'v' && token[1] == 't' && isSpace(token[2])) {
+					token += 3;
+					chunk.texcoords.push_back(parseReal(token, lineEnd, 0.f));
+					chunk.texcoords.push_back(parseReal(token, lineEnd, 0.f));
+					continue;
+
+				} // if
+
+				// face
+				if (token[0] == 'f' && isSpace(token[1])) {
+					token += 2;
+					uint32_t faceSize = 0;
+
+					while (true) {
+						while (token < lineEnd && (isSpace(*token) || *token == '\r'))
+							token++;
+
+						if (token >= lineEnd)
+							break;
+
+						RawCorner corner{};
+						if (!parseCorner(token, lineEnd, chunk, corner)) {
+							chunk.error = "Failed to parse `f' line (e.g. a zero value for vertex index)";
+							return;
+
+						} // if
+
+						chunk.corners.push_back(corner);
+						faceSize++;
+
+					} // while
+
+					chunk.faceSizes.push_back(faceSize);
+					continue;
+
+				} // if
+
+				// groups, materials, smoothing groups, lines and points do not affect the welded mesh
+
+			} // while
+
+		} // parseChunk
+
+		bool resolveIndex(int& index, bool relative, int base, int count) {
+			if (relative)
+				index += base;
+
+			return index >= 0 && index < count;
+
+		} // resolveIndex
+
+		// turns the raw corners of a chunk into the exact triangle list tinyobj's triangulation produces
+		void triangulateChunk(Chunk& chunk, const tinyobj::attrib_t& attrib) {
+			const int vertexCount = static_cast<int>(attrib.vertices.size() / 3);
+			const int normalCount = static_cast<int>(attrib.normals.size() / 3);
+			const int texcoordCount = static_cast<int>(attrib.texcoords.size() / 2);
+			const auto& v = attrib.vertices;
+
+			chunk.triangles.reserve(chunk.corners.size());
+
+			size_t cornerIndex = 0;
+			for (uint32_t faceSize : chunk.faceSizes) {
+				RawCorner* face = chunk.corners.data() + cornerIndex;
+				cornerIndex += faceSize;
+
+				bool valid = true;
+				for (uint32_t i = 0; i < faceSize; i++) {
+					RawCorner& corner = face[i];
+					valid &= resolveIndex(corner.vertex, corner.relative & RELATIVE_VERTEX, chunk.vertexBase, vertexCount);
+
+					// left for dropInvalidTriangles, which treats the tinyobj path the same way
+					if ((corner.texcoord >= 0 || (corner.relative & RELATIVE_TEXCOORD)) &&
+						!resolveIndex(corner.texcoord, corner.relative & RELATIVE_TEXCOORD, chunk.texcoordBase, texcoordCount))
+						corner.texcoord = INVALID_INDEX;
+
+					if ((corner.normal >= 0 || (corner.relative & RELATIVE_NORMAL)) &&
+						!resolveIndex(corner.normal, corner.relative & RELATIVE_NORMAL, chunk.normalBase, normalCount))
+						corner.normal = INVALID_INDEX;
+
+				} // for
+
+				// the whole face is skipped, as tinyobj does with quads and larger polygons, since it cannot be split
+				// without its positions, one broken face should not cost the whole model
+				if (!valid) {
+					chunk.invalidFaces++;
+					continue;
+
+				} // if
+
+				auto toIndex = [](const RawCorner& corner) {
+					tinyobj::index_t index{};
+					index.vertex_index = corner.vertex;
+					index.normal_index = corner.normal;
+					index.texcoord_index = corner.texcoord;
+					return index;
+
+				}; // toIndex
+
+				// degenerated faces are skipped, same as tinyobj
+				if (faceSize < 3)
+					continue;
+
+				if (faceSize == 3) {
+					chunk.triangles.push_back(toIndex(face[0]));
+					chunk.triangles.push_back(toIndex(face[1]));
+					chunk.triangles.push_back(toIndex(face[2]));
+					continue;
+
+				} // if
+
+				// tinyobj ear clips larger polygons, leave those files to it rather than risk a different triangulation
+				if (faceSize > 4) {
+					chunk.needsTinyObj = true;
+					return;
+
+				} // if
+
+				// quads are split along the shorter diagonal, evaluated in the same order and precision as tinyobj
+				size_t vi0 = static_cast<size_t>(face[0].vertex);
+				size_t vi1 = static_cast<size_t>(face[1].vertex);
+				size_t vi2 = static_cast<size_t>(face[2].vertex);
+				size_t vi3 = static_cast<size_t>(face[3].vertex);
+
+				tinyobj::real_t e02x = v[vi2 * 3 + 0] - v[vi0 * 3 + 0];
+				tinyobj::real_t e02y = v[vi2 * 3 + 1] - v[vi0 * 3 + 1];
+				tinyobj::real_t e02z = v[vi2 * 3 + 2] - v[vi0 * 3 + 2];
+				tinyobj::real_t e13x = v[vi3 * 3 + 0] - v[vi1 * 3 + 0];
+				tinyobj::real_t e13y = v[vi3 * 3 + 1] - v[vi1 * 3 + 1];
+				tinyobj::real_t e13z = v[vi3 * 3 + 2] - v[vi1 * 3 + 2];
+
+				tinyobj::real_t sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+				tinyobj::real_t sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+				if (sqr02 < sqr13) {
+					// [0, 1, 2], [0, 2, 3]
+					for (int i : { 0, 1, 2, 0, 2, 3 })
+						chunk.triangles.push_back(toIndex(face[i]));
+
+				} // if
+				else {
+					// [0, 1, 3], [1, 2, 3]
+					for (int i : { 0, 1, 3, 1, 2, 3 })
+						chunk.triangles.push_back(toIndex(face[i]));
+
+				} // else
+
+			} // for
+
+		} // triangulateChunk
+
+		bool isValidCorner(const tinyobj::index_t& index, const tinyobj::attrib_t& attrib) {
+			return index.vertex_index >= 0 && static_cast<size_t>(index.vertex_index) < attrib.vertices.size() / 3 &&
+				index.normal_index >= -1 && (index.normal_index == -1 || static_cast<size_t>(index.normal_index) < attrib.normals.size() / 3) &&
+				index.texcoord_index >= -1 && (index.texcoord_index == -1 || static_cast<size_t>(index.texcoord_index) < attrib.texcoords.size() / 2);
+
+		} // isValidCorner
+
+		// drops the triangles with a corner outside of the attribute arrays, weldVertices reads them unchecked, returns
+		// how many went, both load paths run it so they skip the same faces
+		uint32_t dropInvalidTriangles(const tinyobj::attrib_t& attrib, std::vector<tinyobj::index_t>& indices) {
+			size_t kept = 0;
+			for (size_t t = 0; t + 3 <= indices.size(); t += 3) {
+				if (!isValidCorner(indices[t], attrib) || !isValidCorner(indices[t + 1], attrib) || !isValidCorner(indices[t + 2], attrib))
+					continue;
+
+				for (size_t k = 0; k < 3; k++)
+					indices[kept++] = indices[t + k];
+
+			} // for
+
+			uint32_t dropped = static_cast<uint32_t>((indices.size() - kept) / 3);
+			indices.resize(kept);
+			return dropped;
+
+		} // dropInvalidTriangles
+
+		template <typename Function>
+		void forEachChunk(std::vector<Chunk>& chunks, Function function) {
+			if (chunks.size() == 1) {
+				function(chunks[0]);
+				return;
+
+			} // if
+
+			std::vector<std::thread> workers;
+			workers.reserve(chunks.size());
+			for (auto& chunk : chunks)
+				workers.emplace_back([&chunk, &function]() { function(chunk); });
+
+			for (auto& worker : workers)
+				worker.join();
+
+		} // forEachChunk
+
+		template <typename T>
+		void appendInOrder(std::vector<Chunk>& chunks, std::vector<T>& destination, std::vector<T> Chunk::*member) {
+			size_t total = 0;
+			for (auto& chunk : chunks)
+				total += (chunk.*member).size();
+
+			destination.resize(total);
+
+			size_t offset = 0;
+			for (auto& chunk : chunks) {
+				auto& source = chunk.*member;
+				if (!source.empty())
+					std::memcpy(destination.data() + offset, source.data(), source.size() * sizeof(T));
+
+				offset += source.size();
+				std::vector<T>().swap(source);
+
+			} // for
+
+		} // appendInOrder
+
+	} // namespace
+
+	bool LveObjParser::load(const std::string& filepath, uint32_t threadCount, LveObjData& data) {
+		auto file = LveMappedFile::open(filepath);
+		if (!file)
+			throw std::runtime_error("failed to open file: " + filepath);
+
+		if (threadCount == 0)
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+		const char* begin = reinterpret_cast<const char*>(file->data());
+		const char* end = begin + file->size();
+
+		size_t chunkCount = std::min<size_t>(threadCount, std::max<size_t>(1, file->size() / MIN_CHUNK_SIZE));
+		std::vector<Chunk> chunks(chunkCount);
+
+		// split into line aligned chunks, each boundary is moved forward to just past the next line break
+		const char* chunkBegin = begin;
+		for (size_t i = 0; i < chunkCount; i++) {
+			const char* chunkEnd = i + 1 == chunkCount ? end : begin + file->size() * (i + 1) / chunkCount;
+			chunkEnd = std::max(chunkEnd, chunkBegin);
+			while (chunkEnd < end && chunkEnd[-1] != '\n')
+				chunkEnd++;
+
+			chunks[i].begin = chunkBegin;
+			chunks[i].end = chunkEnd;
+			chunkBegin = chunkEnd;
+
+		} // for
+
+		forEachChunk(chunks, parseChunk);
+
+		for (auto& chunk : chunks) {
+			if (!chunk.error.empty())
+				throw std::runtime_error(chunk.error + ": " + filepath);
+
+		} // for
+
+		// every chunk needs the number of attributes before it to resolve its relative indices
+		int vertexBase = 0, normalBase = 0, texcoordBase = 0;
+		for (auto& chunk : chunks) {
+			chunk.vertexBase = vertexBase;
+			chunk.normalBase = normalBase;
+			chunk.texcoordBase = texcoordBase;
+			vertexBase += static_cast<int>(chunk.positions.size() / 3);
+			normalBase += static_cast<int>(chunk.normals.size() / 3);
+			texcoordBase += static_cast<int>(chunk.texcoords.size() / 2);
+
+		} // for
+
+		data.attrib = tinyobj::attrib_t{};
+		data.indices.clear();
+		data.warning.clear();
+
+		appendInOrder(chunks, data.attrib.vertices, &Chunk::positions);
+		appendInOrder(chunks, data.attrib.colors, &Chunk::colors);
+		appendInOrder(chunks, data.attrib.normals, &Chunk::normals);
+		appendInOrder(chunks, data.attrib.texcoords, &Chunk::texcoords);
+
+		forEachChunk(chunks, [&data](Chunk& chunk) { triangulateChunk(chunk, data.attrib); });
+
+		for (auto& chunk : chunks) {
+			if (chunk.needsTinyObj)
+				return false;
+
+			if (!chunk.error.empty())
+				throw std::runtime_error(chunk.error + ": " + filepath);
+
+		} // for
+
+		uint32_t invalidFaces = 0;
+		for (const auto& chunk : chunks)
+			invalidFaces += chunk.invalidFaces;
+
+		if (invalidFaces > 0)
+			data.warning = std::to_string(invalidFaces) + " face(s) with invalid vertex index skipped\n";
+
+		appendInOrder(chunks, data.indices, &Chunk::triangles);
+
+		uint32_t invalidTriangles = dropInvalidTriangles(data.attrib, data.indices);
+		if (invalidTriangles > 0)
+			data.warning += std::to_string(invalidTriangles) + " triangle(s) with invalid index skipped\n";
+
+		return true;
+
+	} // load
+
+	void LveObjParser::loadWithTinyObj(const std::string& filepath, LveObjData& data) {
+		std::vector<tinyobj::shape_t> shapes;
+		std::vector<tinyobj::material_t> materials;
+		std::string warn, err;
+
+		data.attrib = tinyobj::attrib_t{};
+		data.indices.clear();
+		data.warning.clear();
+
+		if (!tinyobj::LoadObj(&data.attrib, &shapes, &materials, &warn, &err, filepath.c_str()))
+			throw std::runtime_error(warn + err);
+
+		data.warning = warn;
+
+		for (const auto& shape : shapes)
+			data.indices.insert(data.indices.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
+
+		// tinyobj only checks the positions of quads and larger polygons
+		uint32_t invalidTriangles = dropInvalidTriangles(data.attrib, data.indices);
+		if (invalidTriangles > 0)
+			data.warning += std::to_string(invalidTriangles) + " triangle(s) with invalid index skipped\n";
+
+	} // loadWithTinyObj
+
+} // lve
@@ -0,0 +1,37 @@
+#pragma once
+
+// libs
+#include <tiny_obj_loader.h>
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+	// the flattened result of an OBJ load, the face corners of every shape are stored in file order
+	// this is exactly what LveModel::Builder::loadModel walks when welding vertices
+	struct LveObjData {
+		tinyobj::attrib_t attrib;
+		std::vector<tinyobj::index_t> indices;
+		std::string warning; // faces that were skipped and the like, empty for a clean file
+
+	}; // LveObjData
+
+	// multi-threaded OBJ reader producing the same attributes and triangulation as tinyobj::LoadObj
+	// the file is memory mapped and split into line aligned chunks, every worker parses its own chunk into
+	// thread local buffers and the chunks are merged back in file order so the output is deterministic
+	class LveObjParser {
+	public:
+		// threadCount = 0 picks std::thread::hardware_concurrency()
+		// returns false when the file uses something only tinyobj handles (polygons with more than 4 corners),
+		// the caller should then fall back to loadWithTinyObj
+		static bool load(const std::string& filepath, uint32_t threadCount, LveObjData& data);
+
+		// the single threaded reference path
+		static void loadWithTinyObj(const std::string& filepath, LveObjData& data);
+
+	}; // LveObjParser
+
+} // lve
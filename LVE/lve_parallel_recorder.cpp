@@ -0,0 +1,206 @@
+#include "lve_parallel_recorder.hpp"
+
+// std
+#include <algorithm>
+#include <stdexcept>
+
+namespace lve {
+
+	LveParallelRecorder::LveParallelRecorder(LveDevice& device, uint32_t frameCount, uint32_t threadCount) : lveDevice{ device } {
+		if (threadCount == 0)
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+		// secondaries are only ever recorded for one frame and reset with their pool, so the pools are transient and
+		// do not need to reset single command buffers
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = lveDevice.findPhysicalQueueFamilies().graphicsFamily;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		threads.resize(threadCount);
+		for (Thread& thread : threads) {
+			thread.frames.resize(frameCount);
+			for (ThreadFrame& frame : thread.frames) {
+				if (vkCreateCommandPool(lveDevice.device(), &poolInfo, nullptr, &frame.commandPool) != VK_SUCCESS)
+					throw std::runtime_error("failed to create recording thread command pool!");
+
+			} // for
+
+		} // for
+
+		for (uint32_t t = 1; t < threadCount; t++)
+			threads[t].worker = std::thread{ &LveParallelRecorder::workerLoop, this, t };
+
+	} // LveParallelRecorder
+
+	LveParallelRecorder::~LveParallelRecorder() {
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			stopping = true;
+
+		} // lock
+
+		workAvailable.notify_all();
+
+		for (Thread& thread : threads) {
+			if (thread.worker.joinable())
+				thread.worker.join();
+
+			// destroying a pool frees its command buffers
+			for (ThreadFrame& frame : thread.frames)
+				vkDestroyCommandPool(lveDevice.device(), frame.commandPool, nullptr);
+
+		} // for
+
+	} // ~LveParallelRecorder
+
+	void LveParallelRecorder::beginRenderPass(int frameIndex, VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent) {
+		this->frameIndex = frameIndex;
+
+		for (Thread& thread : threads) {
+			ThreadFrame& frame = thread.frames[frameIndex];
+			vkResetCommandPool(lveDevice.device(), frame.commandPool, 0);
+			frame.usedCommandBuffers = 0;
+
+		} // for
+
+		inheritanceInfo = VkCommandBufferInheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass = renderPass;
+		inheritanceInfo.subpass = 0;
+		inheritanceInfo.framebuffer = framebuffer;
+
+		// dynamic state does not carry over from the primary, every secondary sets it again
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.width = static_cast<float>(extent.width);
+		viewport.height = static_cast<float>(extent.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+		scissor = VkRect2D{ { 0, 0 }, extent };
+
+	} // beginRenderPass
+
+	void LveParallelRecorder::record(VkCommandBuffer primaryCommandBuffer, uint32_t taskCount, const std::function<void(VkCommandBuffer commandBuffer, uint32_t task)>& recordTask) {
+		if (taskCount == 0)
+			return;
+
+		this->recordTask = &recordTask;
+		this->taskCount = taskCount;
+		nextTask = 0;
+		taskCommandBuffers.assign(taskCount, VK_NULL_HANDLE);
+		taskError = nullptr;
+
+		// a single task is recorded right here, waking the workers would only cost time
+		uint32_t workerCount = taskCount > 1 ? getThreadCount() - 1 : 0;
+		if (workerCount > 0) {
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+				generation++;
+				busyWorkers = workerCount;
+
+			} // lock
+
+			workAvailable.notify_all();
+
+		} // if
+
+		runTasks(0);
+
+		if (workerCount > 0) {
+			std::unique_lock<std::mutex> lock{ mutex };
+			workDone.wait(lock, [this]() { return busyWorkers == 0; });
+
+		} // if
+
+		this->recordTask = nullptr;
+		if (taskError)
+			std::rethrow_exception(taskError);
+
+		vkCmdExecuteCommands(primaryCommandBuffer, taskCount, taskCommandBuffers.data());
+
+	} // record
+
+	void LveParallelRecorder::workerLoop(uint32_t thread) {
+		uint64_t seenGeneration = 0;
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock{ mutex };
+				workAvailable.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+				if (stopping)
+					return;
+
+				seenGeneration = generation;
+
+			} // lock
+
+			runTasks(thread);
+
+			std::lock_guard<std::mutex> lock{ mutex };
+			if (--busyWorkers == 0)
+				workDone.notify_one();
+
+		} // while
+
+	} // workerLoop
+
+	void LveParallelRecorder::runTasks(uint32_t thread) {
+		// tasks are claimed one at a time, so a thread that gets cheap slices simply takes more of them
+		for (uint32_t task = nextTask++; task < taskCount; task = nextTask++) {
+			try {
+				VkCommandBuffer commandBuffer = beginSecondary(thread);
+				(*recordTask)(commandBuffer, task);
+
+				if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+					throw std::runtime_error("failed to record secondary command buffer!");
+
+				taskCommandBuffers[task] = commandBuffer;
+
+			} // try
+			catch (...) {
+				std::lock_guard<std::mutex> lock{ mutex };
+				if (!taskError)
+					taskError = std::current_exception();
+
+			} // catch
+
+		} // for
+
+	} // runTasks
+
+	VkCommandBuffer LveParallelRecorder::beginSecondary(uint32_t thread) {
+		ThreadFrame& frame = threads[thread].frames[frameIndex];
+
+		if (frame.usedCommandBuffers == frame.commandBuffers.size()) {
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			allocInfo.commandPool = frame.commandPool;
+			allocInfo.commandBufferCount = 1;
+
+			VkCommandBuffer commandBuffer;
+			if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+				throw std::runtime_error("failed to allocate secondary command buffer!");
+
+			frame.commandBuffers.push_back(commandBuffer);
+
+		} // if
+
+		VkCommandBuffer commandBuffer = frame.commandBuffers[frame.usedCommandBuffers++];
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+			throw std::runtime_error("failed to begin recording secondary command buffer!");
+
+		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+		return commandBuffer;
+
+	} // beginSecondary
+
+} // lve
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lve {
+
+	// records the inside of a render pass as secondary command buffers on several threads, every thread has its own
+	// command pool per frame in flight (pools are externally synchronized) and the threads live as long as this,
+	// a frame only wakes them instead of starting new ones
+	class LveParallelRecorder {
+	public:
+		// threadCount = 0 picks std::thread::hardware_concurrency(), the thread calling record counts as one of them
+		LveParallelRecorder(LveDevice& device, uint32_t frameCount, uint32_t threadCount = 0);
+		~LveParallelRecorder();
+
+		LveParallelRecorder(const LveParallelRecorder&) = delete;
+		LveParallelRecorder& operator=(const LveParallelRecorder&) = delete;
+
+		uint32_t getThreadCount() const { return static_cast<uint32_t>(threads.size()); } // getThreadCount
+
+		// call once the primary has begun the render pass with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS, it resets
+		// the pools of frameIndex, so the fence of that frame has to have signalled like it has after LveRenderer::beginFrame
+		void beginRenderPass(int frameIndex, VkRenderPass renderPass, VkFramebuffer framebuffer, VkExtent2D extent);
+
+		// records taskCount secondary command buffers spread over the threads and executes them in the primary in task
+		// order, every one of them already has the viewport and scissor set, nothing else is inherited from the primary
+		// recordTask runs concurrently, so tasks must only touch their own command buffer and state
+		void record(VkCommandBuffer primaryCommandBuffer, uint32_t taskCount, const std::function<void(VkCommandBuffer commandBuffer, uint32_t task)>& recordTask);
+
+	private:
+		struct ThreadFrame {
+			VkCommandPool commandPool = VK_NULL_HANDLE;
+			std::vector<VkCommandBuffer> commandBuffers; // allocated as needed, reused once the pool is reset
+			uint32_t usedCommandBuffers = 0;
+
+		}; // ThreadFrame
+
+		struct Thread {
+			std::vector<ThreadFrame> frames;
+			std::thread worker; // not started for the first thread, that is whoever calls record
+
+		}; // Thread
+
+		void workerLoop(uint32_t thread);
+		void runTasks(uint32_t thread);
+		VkCommandBuffer beginSecondary(uint32_t thread);
+
+		LveDevice& lveDevice;
+		std::vector<Thread> threads;
+
+		int frameIndex = 0;
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		VkViewport viewport{};
+		VkRect2D scissor{};
+
+		// the record call in progress
+		const std::function<void(VkCommandBuffer, uint32_t)>* recordTask = nullptr;
+		uint32_t taskCount = 0;
+		std::atomic<uint32_t> nextTask{ 0 };
+		std::vector<VkCommandBuffer> taskCommandBuffers;
+		std::exception_ptr taskError; // the first exception a task threw, rethrown by record
+
+		std::mutex mutex;
+		std::condition_variable workAvailable;
+		std::condition_variable workDone;
+		uint64_t generation = 0; // bumped by every record call that wakes the workers
+		uint32_t busyWorkers = 0;
+		bool stopping = false;
+
+	}; // LveParallelRecorder
+
+} // lve
@@ -196,8 +196,7 @@ namespace lve {
 		shaderStages[0].pName = "main";
 		shaderStages[0].flags = 0;
 		shaderStages[0].pNext = nullptr;
-		// to be covered later
-		shaderStages[0].pSpecializationInfo = nullptr; // customizes shader functionality 
+		shaderStages[0].pSpecializationInfo = configInfo.vertSpecializationInfo; // customizes shader functionality 
 
 		shaderStages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		shaderStages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -28,6 +28,9 @@ namespace lve {
 		VkRenderPass renderPass = nullptr;
 		uint32_t subpass = 0;
 
+		// specialization constants for the vertex shader, has to stay alive until the pipeline is created
+		const VkSpecializationInfo* vertSpecializationInfo = nullptr;
+
 	}; // PipelineConfigInfo
 
 	class LvePipeline {
@@ -49,9 +52,11 @@ namespace lve {
 		static void defaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
 		static void enableAlphaBlending(PipelineConfigInfo& configInfo);
 
-	private:
+		// the whole file, for loading .spv shaders, shared with LveComputePipeline
 		static std::vector<char> readFile(const std::string& filePath);
 
+	private:
+
 		void createGraphicsPipeline(const std::string& vertFilePath, 
 			const std::string& fragFilePath, 
 			const PipelineConfigInfo& configInfo);
@@ -0,0 +1,113 @@
+#include "lve_range_allocator.hpp"
+
+// std
+#include <cassert>
+
+namespace lve {
+
+	LveRangeAllocator::LveRangeAllocator(uint64_t capacity) : capacity{ capacity } {
+		if (capacity > 0)
+			insertFreeRange(0, capacity);
+
+	} // LveRangeAllocator
+
+	uint64_t LveRangeAllocator::allocate(uint64_t size, uint64_t alignment) {
+		assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+		if (size == 0)
+			return NO_SPACE;
+
+		// smallest free range that still fits once its start is aligned
+		for (auto it = freeBySize.lower_bound({ size, 0 }); it != freeBySize.end(); ++it) {
+			uint64_t rangeOffset = it->second;
+			uint64_t rangeSize = it->first;
+			uint64_t offset = (rangeOffset + alignment - 1) & ~(alignment - 1);
+			uint64_t padding = offset - rangeOffset;
+			if (padding + size > rangeSize)
+				continue;
+
+			eraseFreeRange(freeByOffset.find(rangeOffset));
+
+			// the padding stays with the allocation so freeing it gives the whole range back,
+			// only the tail is returned to the free list
+			if (padding + size < rangeSize)
+				insertFreeRange(offset + size, rangeSize - padding - size);
+
+			allocations[offset] = { size, padding };
+			used += padding + size;
+			return offset;
+
+		} // for
+
+		return NO_SPACE;
+
+	} // allocate
+
+	void LveRangeAllocator::free(uint64_t offset) {
+		auto allocation = allocations.find(offset);
+		assert(allocation != allocations.end() && "freeing a range that was never allocated");
+		if (allocation == allocations.end())
+			return;
+
+		uint64_t start = offset - allocation->second.second;
+		uint64_t size = allocation->second.first + allocation->second.second;
+		used -= size;
+		allocations.erase(allocation);
+
+		// merge with the free ranges right before and right after it
+		auto next = freeByOffset.lower_bound(start);
+		if (next != freeByOffset.begin()) {
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == start) {
+				start = previous->first;
+				size += previous->second;
+				eraseFreeRange(previous);
+
+			} // if
+
+		} // if
+
+		next = freeByOffset.lower_bound(start + size);
+		if (next != freeByOffset.end() && next->first == start + size) {
+			size += next->second;
+			eraseFreeRange(next);
+
+		} // if
+
+		insertFreeRange(start, size);
+
+	} // free
+
+	LveRangeAllocator::Stats LveRangeAllocator::getStats() const {
+		Stats stats{};
+		stats.capacity = capacity;
+		stats.used = used;
+		stats.freeRangeCount = freeByOffset.size();
+		stats.largestFreeRange = freeBySize.empty() ? 0 : freeBySize.rbegin()->first;
+		stats.allocationCount = allocations.size();
+		return stats;
+
+	} // getStats
+
+	std::vector<std::pair<uint64_t, uint64_t>> LveRangeAllocator::getAllocations() const {
+		std::vector<std::pair<uint64_t, uint64_t>> ranges;
+		ranges.reserve(allocations.size());
+		for (const auto& [offset, allocation] : allocations)
+			ranges.push_back({ offset, allocation.first });
+
+		return ranges;
+
+	} // getAllocations
+
+	void LveRangeAllocator::insertFreeRange(uint64_t offset, uint64_t size) {
+		freeByOffset[offset] = size;
+		freeBySize.insert({ size, offset });
+
+	} // insertFreeRange
+
+	void LveRangeAllocator::eraseFreeRange(std::map<uint64_t, uint64_t>::iterator range) {
+		freeBySize.erase({ range->second, range->first });
+		freeByOffset.erase(range);
+
+	} // eraseFreeRange
+
+} // lve
@@ -0,0 +1,62 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace lve {
+
+	// best fit allocator over an abstract range [0, capacity), it only does the bookkeeping, whatever the units are
+	// (bytes, vertices, indices) is up to the owner, freed ranges are merged with their free neighbours right away
+	class LveRangeAllocator {
+	public:
+		static constexpr uint64_t NO_SPACE = UINT64_MAX;
+
+		struct Stats {
+			uint64_t capacity = 0;
+			uint64_t used = 0;
+			uint64_t freeRangeCount = 0;
+			uint64_t largestFreeRange = 0;
+			uint64_t allocationCount = 0;
+
+			// 0 when all free space is one range, towards 1 the more it is split into small pieces
+			float fragmentation() const {
+				uint64_t free = capacity - used;
+				return free == 0 ? 0.f : 1.f - static_cast<float>(largestFreeRange) / static_cast<float>(free);
+
+			} // fragmentation
+
+		}; // Stats
+
+		explicit LveRangeAllocator(uint64_t capacity);
+
+		// returns the offset of the range or NO_SPACE, alignment has to be a power of two
+		uint64_t allocate(uint64_t size, uint64_t alignment = 1);
+		void free(uint64_t offset);
+
+		uint64_t getCapacity() const { return capacity; } // getCapacity
+		uint64_t getUsed() const { return used; } // getUsed
+		bool isEmpty() const { return allocations.empty(); } // isEmpty
+
+		Stats getStats() const;
+
+		// (offset, size) of every live range in offset order, without the alignment padding
+		std::vector<std::pair<uint64_t, uint64_t>> getAllocations() const;
+
+	private:
+		void insertFreeRange(uint64_t offset, uint64_t size);
+		void eraseFreeRange(std::map<uint64_t, uint64_t>::iterator range);
+
+		uint64_t capacity;
+		uint64_t used = 0;
+
+		std::map<uint64_t, uint64_t> freeByOffset; // offset -> size, to find the neighbours of a freed range
+		std::set<std::pair<uint64_t, uint64_t>> freeBySize; // (size, offset), to find the best fit
+		std::map<uint64_t, std::pair<uint64_t, uint64_t>> allocations; // offset -> (size, padding in front of it)
+
+	}; // LveRangeAllocator
+
+} // lve
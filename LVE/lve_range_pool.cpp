@@ -0,0 +1,188 @@
+#include "lve_range_pool.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+
+namespace lve {
+
+	LveRangePool::LveRangePool(uint64_t blockBytes, uint32_t framesInFlight, BlockAdded blockAdded, BlockReleased blockReleased)
+		: blockBytes{ blockBytes }, framesInFlight{ framesInFlight }, blockAdded{ std::move(blockAdded) }, blockReleased{ std::move(blockReleased) } {} // LveRangePool
+
+	uint32_t LveRangePool::findArena(uint32_t key, uint32_t elementSize) {
+		for (uint32_t a = 0; a < arenas.size(); a++) {
+			if (arenas[a].key == key && arenas[a].elementSize == elementSize)
+				return a;
+
+		} // for
+
+		Arena& arena = arenas.emplace_back();
+		arena.key = key;
+		arena.elementSize = elementSize;
+		return static_cast<uint32_t>(arenas.size() - 1);
+
+	} // findArena
+
+	LveRangePool::Allocation LveRangePool::allocate(uint32_t arenaIndex, uint32_t count) {
+		assert(count > 0 && "cannot allocate an empty range");
+
+		Allocation allocation{};
+		allocation.arena = arenaIndex;
+		allocation.count = count;
+		Arena& arena = arenas[arenaIndex];
+
+		uint64_t offset = allocateRange(arena, count, allocation.block);
+
+		// no block has room
+		if (offset == LveRangeAllocator::NO_SPACE) {
+			uint32_t capacity = std::max(static_cast<uint32_t>(blockBytes / arena.elementSize), count);
+
+			auto slot = std::find(arena.blocks.begin(), arena.blocks.end(), nullptr);
+			allocation.block = static_cast<uint32_t>(slot - arena.blocks.begin());
+			if (slot == arena.blocks.end())
+				arena.blocks.push_back(std::make_unique<LveRangeAllocator>(capacity));
+			else
+				*slot = std::make_unique<LveRangeAllocator>(capacity);
+
+			if (blockAdded)
+				blockAdded(arenaIndex, allocation.block, capacity);
+
+			offset = arena.blocks[allocation.block]->allocate(count);
+			arena.defragmenter.invalidate();
+
+		} // if
+
+		allocation.offset = static_cast<uint32_t>(offset);
+		return allocation;
+
+	} // allocate
+
+	void LveRangePool::free(Allocation& allocation) {
+		if (!allocation.isValid())
+			return;
+
+		arenas[allocation.arena].owners.erase({ allocation.block, allocation.offset });
+		freeRange(allocation.arena, allocation.block, allocation.offset);
+
+		allocation = Allocation{};
+
+	} // free
+
+	void LveRangePool::retire(Allocation& allocation) {
+		if (!allocation.isValid())
+			return;
+
+		arenas[allocation.arena].owners.erase({ allocation.block, allocation.offset });
+		retiring.push_back(RetiringRange{ allocation.arena, allocation.block, allocation.offset, frame });
+
+		allocation = Allocation{};
+
+	} // retire
+
+	void LveRangePool::setOwner(Allocation& allocation, std::function<void()> relocated) {
+		if (!allocation.isValid())
+			return;
+
+		arenas[allocation.arena].owners[{ allocation.block, allocation.offset }] = Owner{ &allocation, std::move(relocated) };
+
+	} // setOwner
+
+	std::vector<LveRangePool::Move> LveRangePool::defragment(uint64_t byteBudget, const std::function<bool(const Allocation& allocation)>& canMove) {
+		frame++;
+
+		// after framesInFlight calls no submitted frame can still be reading a range that was moved away from or retired
+		auto retired = std::partition(retiring.begin(), retiring.end(), [&](const RetiringRange& range) {
+			return range.frame + framesInFlight > frame;
+		});
+		for (auto it = retired; it != retiring.end(); ++it)
+			freeRange(it->arena, it->block, it->offset);
+
+		retiring.erase(retired, retiring.end());
+
+		std::vector<Move> moves;
+		uint64_t moved = 0;
+
+		for (uint32_t a = 0; a < arenas.size() && moved < byteBudget; a++) {
+			Arena& arena = arenas[a];
+
+			std::vector<LveRangeAllocator*> blocks(arena.blocks.size(), nullptr);
+			for (size_t b = 0; b < arena.blocks.size(); b++)
+				blocks[b] = arena.blocks[b].get();
+
+			// moved away ranges have no owner anymore
+			auto canMoveRange = [&](uint32_t block, uint64_t offset) {
+				auto owner = arena.owners.find({ block, static_cast<uint32_t>(offset) });
+				return owner != arena.owners.end() && canMove(*owner->second.handle);
+			};
+
+			uint64_t budget = (byteBudget - moved) / arena.elementSize;
+			for (const auto& move : arena.defragmenter.step(blocks, budget, canMoveRange)) {
+				auto node = arena.owners.extract({ move.srcBlock, static_cast<uint32_t>(move.srcOffset) });
+				node.mapped().handle->block = move.dstBlock;
+				node.mapped().handle->offset = static_cast<uint32_t>(move.dstOffset);
+				node.key() = { move.dstBlock, static_cast<uint32_t>(move.dstOffset) };
+				const Owner& owner = arena.owners.insert(std::move(node)).position->second;
+
+				retiring.push_back(RetiringRange{ a, move.srcBlock, static_cast<uint32_t>(move.srcOffset), frame });
+				moves.push_back(Move{ a, move });
+				moved += move.size * arena.elementSize;
+				defragmentStats.moveCount++;
+
+				if (owner.relocated)
+					owner.relocated();
+
+			} // for
+
+		} // for
+
+		defragmentStats.movedBytes += moved;
+		return moves;
+
+	} // defragment
+
+	uint64_t LveRangePool::allocateRange(Arena& arena, uint32_t count, uint32_t& block) {
+		// the block defragment is emptying comes last, whatever lands there has to be moved again
+		uint32_t victim = arena.defragmenter.getVictim();
+		for (uint32_t b = 0; b < arena.blocks.size(); b++) {
+			if (arena.blocks[b] == nullptr || b == victim)
+				continue;
+
+			uint64_t offset = arena.blocks[b]->allocate(count);
+			if (offset != LveRangeAllocator::NO_SPACE) {
+				block = b;
+				return offset;
+
+			} // if
+
+		} // for
+
+		if (victim < arena.blocks.size() && arena.blocks[victim] != nullptr) {
+			block = victim;
+			return arena.blocks[victim]->allocate(count);
+
+		} // if
+
+		return LveRangeAllocator::NO_SPACE;
+
+	} // allocateRange
+
+	void LveRangePool::freeRange(uint32_t arenaIndex, uint32_t block, uint32_t offset) {
+		Arena& arena = arenas[arenaIndex];
+		auto& slot = arena.blocks[block];
+		slot->free(offset);
+		arena.defragmenter.invalidate();
+
+		// keep the first block of every arena around for the next range, give later empty ones back
+		if (slot->isEmpty() && block > 0) {
+			slot.reset();
+			arena.defragmenter.blockReleased(block);
+			defragmentStats.releasedBlocks++;
+
+			if (blockReleased)
+				blockReleased(arenaIndex, block);
+
+		} // if
+
+	} // freeRange
+
+} // lve
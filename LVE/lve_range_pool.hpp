@@ -0,0 +1,129 @@
+#pragma once
+
+#include "lve_defragmenter.hpp"
+#include "lve_range_allocator.hpp"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace lve {
+
+	// the bookkeeping of LveGeometryPool without any Vulkan objects: ranges sub-allocated out of growable blocks, one
+	// set of blocks per arena, the owners defragment patches when their range moves and the ranges waiting for the
+	// frames in flight before they can be reused, what backs a block is up to the owner, which hears about every block
+	// added and released through the callbacks
+	class LveRangePool {
+	public:
+		// a range of one of the blocks, offset and count are in elements
+		struct Allocation {
+			uint32_t arena = UINT32_MAX;
+			uint32_t block = 0;
+			uint32_t offset = 0;
+			uint32_t count = 0;
+			uint64_t uploadTicket = 0; // left to the owner, LveGeometryPool keeps the upload batch carrying the data here
+
+			bool isValid() const { return arena != UINT32_MAX; } // isValid
+
+		}; // Allocation
+
+		// a range defragment moved, the owner copies the elements from src to dst before anything reads dst
+		struct Move {
+			uint32_t arena = 0;
+			LveDefragmenter::Move range{};
+
+		}; // Move
+
+		struct DefragmentStats {
+			uint64_t moveCount = 0;
+			uint64_t movedBytes = 0;
+			uint32_t releasedBlocks = 0; // emptied blocks given back, by defragment or by frees
+
+		}; // DefragmentStats
+
+		using BlockAdded = std::function<void(uint32_t arena, uint32_t block, uint32_t capacity)>;
+		using BlockReleased = std::function<void(uint32_t arena, uint32_t block)>;
+
+		// blocks hold blockBytes worth of elements, ranges stop being read framesInFlight defragment calls after they were
+		// moved away from or retired
+		LveRangePool(uint64_t blockBytes, uint32_t framesInFlight, BlockAdded blockAdded = {}, BlockReleased blockReleased = {});
+
+		LveRangePool(const LveRangePool&) = delete;
+		LveRangePool& operator=(const LveRangePool&) = delete;
+
+		// the arena for this key and element size, added on first use, the key is opaque (LveGeometryPool uses the usage flags)
+		uint32_t findArena(uint32_t key, uint32_t elementSize);
+
+		// a free range in one of the arena's blocks, adding a block when none has room, a range larger than a whole
+		// block gets a block of its own size
+		Allocation allocate(uint32_t arena, uint32_t count);
+
+		// the range can be reused right away, the caller makes sure nothing still reads from it
+		void free(Allocation& allocation);
+
+		// frees the range once the frames in flight that may still read it are done, the handle is reset right away
+		void retire(Allocation& allocation);
+
+		// lets defragment move the range: the handle is patched in place and relocated is called after it, so the handle
+		// has to stay at the same address until it is freed, ranges without an owner are never moved
+		void setOwner(Allocation& allocation, std::function<void()> relocated = {});
+
+		// frees the retired ranges no frame in flight can still read and moves up to byteBudget of live ranges out of the
+		// emptiest blocks, the handles are already patched when it returns, call it once per frame
+		std::vector<Move> defragment(uint64_t byteBudget, const std::function<bool(const Allocation& allocation)>& canMove);
+
+		uint32_t getArenaCount() const { return static_cast<uint32_t>(arenas.size()); } // getArenaCount
+		uint32_t getKey(uint32_t arena) const { return arenas[arena].key; } // getKey
+		uint32_t getElementSize(uint32_t arena) const { return arenas[arena].elementSize; } // getElementSize
+
+		// released blocks leave a null slot so block indices stay valid
+		const std::vector<std::unique_ptr<LveRangeAllocator>>& getBlocks(uint32_t arena) const { return arenas[arena].blocks; } // getBlocks
+
+		size_t getRetiringCount() const { return retiring.size(); } // getRetiringCount
+		const DefragmentStats& getDefragmentStats() const { return defragmentStats; } // getDefragmentStats
+
+	private:
+		struct Owner {
+			Allocation* handle = nullptr;
+			std::function<void()> relocated{};
+
+		}; // Owner
+
+		struct Arena {
+			uint32_t key = 0;
+			uint32_t elementSize = 0;
+			std::vector<std::unique_ptr<LveRangeAllocator>> blocks{};
+			std::map<std::pair<uint32_t, uint32_t>, Owner> owners{}; // (block, offset) -> handle to patch when it moves
+			LveDefragmenter defragmenter{};
+
+		}; // Arena
+
+		// a moved or retired range, freed once no frame in flight can still be reading it
+		struct RetiringRange {
+			uint32_t arena;
+			uint32_t block;
+			uint32_t offset;
+			uint64_t frame;
+
+		}; // RetiringRange
+
+		uint64_t allocateRange(Arena& arena, uint32_t count, uint32_t& block);
+		void freeRange(uint32_t arenaIndex, uint32_t block, uint32_t offset);
+
+		uint64_t blockBytes;
+		uint32_t framesInFlight;
+		BlockAdded blockAdded;
+		BlockReleased blockReleased;
+		std::vector<Arena> arenas;
+
+		uint64_t frame = 0; // defragment calls so far
+		std::vector<RetiringRange> retiring;
+		DefragmentStats defragmentStats{};
+
+	}; // LveRangePool
+
+} // lve
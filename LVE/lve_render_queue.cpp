@@ -0,0 +1,144 @@
+#include "lve_render_queue.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <iomanip>
+
+namespace lve {
+
+	namespace {
+
+		constexpr uint64_t fieldMask(uint32_t bits) { return (uint64_t{ 1 } << bits) - 1; } // fieldMask
+
+		// below this an insertion sort beats clearing and walking the histograms, it is stable like the radix sort
+		constexpr size_t RADIX_SORT_MIN_PACKETS = 64;
+
+	} // namespace
+
+	// opaque:      0 | pipeline | binding | model | lod | depth
+	// translucent: 1 | inverted depth | pipeline | binding | model | lod left 0
+	static_assert(1 + LveRenderQueue::PIPELINE_BITS + LveRenderQueue::BINDING_BITS + LveRenderQueue::MODEL_BITS + LveRenderQueue::LOD_BITS + LveRenderQueue::DEPTH_BITS <= 64, "the key fields have to fit 64 bits");
+
+	uint64_t LveRenderQueue::opaqueKey(uint32_t pipeline, uint32_t binding, uint32_t model, uint32_t lod, uint32_t depth) {
+		uint64_t key = pipeline & fieldMask(PIPELINE_BITS);
+		key = (key << BINDING_BITS) | (binding & fieldMask(BINDING_BITS));
+		key = (key << MODEL_BITS) | (model & fieldMask(MODEL_BITS));
+		key = (key << LOD_BITS) | (lod & fieldMask(LOD_BITS));
+		key = (key << DEPTH_BITS) | (depth & fieldMask(DEPTH_BITS));
+		return key;
+
+	} // opaqueKey
+
+	uint64_t LveRenderQueue::translucentKey(uint32_t pipeline, uint32_t binding, uint32_t model, uint32_t depth) {
+		uint64_t key = 1;
+		key = (key << DEPTH_BITS) | (~depth & fieldMask(DEPTH_BITS));
+		key = (key << PIPELINE_BITS) | (pipeline & fieldMask(PIPELINE_BITS));
+		key = (key << BINDING_BITS) | (binding & fieldMask(BINDING_BITS));
+		key = (key << MODEL_BITS) | (model & fieldMask(MODEL_BITS));
+		return key << LOD_BITS;
+
+	} // translucentKey
+
+	uint32_t LveRenderQueue::quantizeDepth(float depth, float farDepth) {
+		float normalized = farDepth > 0.f ? depth / farDepth : 0.f;
+		normalized = std::clamp(normalized, 0.f, 1.f); // also behind the camera, which only happens for objects around it
+		return static_cast<uint32_t>(normalized * static_cast<float>(fieldMask(DEPTH_BITS)));
+
+	} // quantizeDepth
+
+	void LveRenderQueue::clear() {
+		if (!packets.empty() || frame.pipelineBinds + frame.pipelineBindsSkipped > 0) {
+			totals.packets += frame.packets;
+			totals.pipelineBinds += frame.pipelineBinds;
+			totals.pipelineBindsSkipped += frame.pipelineBindsSkipped;
+			totals.geometryBinds += frame.geometryBinds;
+			totals.geometryBindsSkipped += frame.geometryBindsSkipped;
+			frameCount++;
+
+		} // if
+
+		packets.clear();
+		stateIds.clear();
+		frame = Stats{};
+
+	} // clear
+
+	void LveRenderQueue::sort() {
+		frame.packets = packets.size();
+
+		if (packets.size() < RADIX_SORT_MIN_PACKETS) {
+			for (size_t i = 1; i < packets.size(); i++) {
+				Packet packet = packets[i];
+				size_t j = i;
+				for (; j > 0 && packets[j - 1].key > packet.key; j--)
+					packets[j] = packets[j - 1];
+
+				packets[j] = packet;
+
+			} // for
+
+			return;
+
+		} // if
+
+		// least significant byte first, every pass is stable so the earlier bytes stay in order within equal later ones,
+		// the histograms of all eight passes come out of one walk over the keys
+		std::array<std::array<uint32_t, 256>, 8> histograms{};
+		for (const Packet& packet : packets) {
+			for (int pass = 0; pass < 8; pass++)
+				histograms[pass][(packet.key >> (pass * 8)) & 0xFF]++;
+
+		} // for
+
+		scratch.resize(packets.size());
+		for (int pass = 0; pass < 8; pass++) {
+			auto& histogram = histograms[pass];
+
+			// a byte every key shares (the unused bits, the pipeline of a single pipeline system) would not move anything
+			if (histogram[(packets[0].key >> (pass * 8)) & 0xFF] == packets.size())
+				continue;
+
+			uint32_t offset = 0;
+			for (uint32_t& count : histogram) {
+				uint32_t bucketSize = count;
+				count = offset;
+				offset += bucketSize;
+
+			} // for
+
+			for (const Packet& packet : packets)
+				scratch[histogram[(packet.key >> (pass * 8)) & 0xFF]++] = packet;
+
+			packets.swap(scratch);
+
+		} // for
+
+	} // sort
+
+	uint32_t LveRenderQueue::stateId(uint64_t state) {
+		return stateIds.try_emplace(state, static_cast<uint32_t>(stateIds.size())).first->second;
+
+	} // stateId
+
+	void LveRenderQueue::addBinds(const Stats& binds) {
+		frame.pipelineBinds += binds.pipelineBinds;
+		frame.pipelineBindsSkipped += binds.pipelineBindsSkipped;
+		frame.geometryBinds += binds.geometryBinds;
+		frame.geometryBindsSkipped += binds.geometryBindsSkipped;
+
+	} // addBinds
+
+	void LveRenderQueue::printStats(std::ostream& out, const char* name) const {
+		if (frameCount == 0)
+			return;
+
+		double frames = static_cast<double>(frameCount);
+		out << std::fixed << std::setprecision(1) << "Render queue (" << name << "): " << totals.packets / frames << " packets, "
+			<< totals.pipelineBinds / frames << " pipeline binds (" << totals.pipelineBindsSkipped / frames << " saved), "
+			<< totals.geometryBinds / frames << " geometry binds (" << totals.geometryBindsSkipped / frames << " saved) per frame over "
+			<< frameCount << " frames\n";
+
+	} // printStats
+
+} // lve
@@ -0,0 +1,74 @@
+#pragma once
+
+// std
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+	// the draws of a render system for one frame, each a 64 bit key and the index of whatever the system draws, sorted
+	// by key with a radix sort so draws sharing state end up next to each other and recording only binds what changes
+	// opaque keys group by pipeline, geometry binding, model and lod and go front to back within those for early z,
+	// translucent keys come after every opaque one and go back to front, their state only breaks ties
+	class LveRenderQueue {
+	public:
+		struct Packet {
+			uint64_t key;
+			uint32_t item; // up to the system that pushed it, usually an index into its own array
+
+		}; // Packet
+
+		// widths of the key fields, ids past them wrap around, which only costs adjacency since recording still
+		// compares the real state before skipping a bind
+		static constexpr uint32_t PIPELINE_BITS = 6;
+		static constexpr uint32_t BINDING_BITS = 10;
+		static constexpr uint32_t MODEL_BITS = 16;
+		static constexpr uint32_t LOD_BITS = 2;
+		static constexpr uint32_t DEPTH_BITS = 24;
+
+		// per frame, or summed over every frame for the totals, a skipped bind is one the previous draw left bound
+		struct Stats {
+			uint64_t packets = 0;
+			uint64_t pipelineBinds = 0;
+			uint64_t pipelineBindsSkipped = 0;
+			uint64_t geometryBinds = 0;
+			uint64_t geometryBindsSkipped = 0;
+
+		}; // Stats
+
+		static uint64_t opaqueKey(uint32_t pipeline, uint32_t binding, uint32_t model, uint32_t lod, uint32_t depth);
+		static uint64_t translucentKey(uint32_t pipeline, uint32_t binding, uint32_t model, uint32_t depth);
+
+		// distance along the view direction over the distance of the far plane, clamped to DEPTH_BITS
+		static uint32_t quantizeDepth(float depth, float farDepth);
+
+		// starts a frame, the stats of the last one are added to the totals
+		void clear();
+
+		void push(uint64_t key, uint32_t item) { packets.push_back(Packet{ key, item }); } // push
+		void sort();
+		const std::vector<Packet>& getPackets() const { return packets; } // getPackets
+
+		// small ids for the key fields, handed out in the order the states (handles, pointers) are first seen this frame
+		uint32_t stateId(uint64_t state);
+
+		// recording reports the binds its draws needed, counted per command buffer so threads never share the counters
+		void addBinds(const Stats& binds);
+
+		const Stats& getFrameStats() const { return frame; } // getFrameStats
+		void printStats(std::ostream& out, const char* name) const;
+
+	private:
+		std::vector<Packet> packets;
+		std::vector<Packet> scratch; // the other buffer of the radix sort
+		std::unordered_map<uint64_t, uint32_t> stateIds;
+
+		Stats frame{};
+		Stats totals{}; // of every frame before the current one
+		uint64_t frameCount = 0;
+
+	}; // LveRenderQueue
+
+} // lve
@@ -147,6 +147,15 @@ namespace lve {
 		 
  		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
  		renderPassInfo.pClearValues = clearValues.data();
+
+ 		// with secondaries the primary may only execute them until the render pass ends, so they set the viewport themselves
+ 		if (parallelRecorder != nullptr) {
+ 			vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+ 			parallelRecorder->beginRenderPass(currentFrameIndex, renderPassInfo.renderPass, renderPassInfo.framebuffer, renderPassInfo.renderArea.extent);
+ 			return;
+
+ 		} // if
+
  		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
  		VkViewport viewport{};
@@ -171,6 +180,17 @@ namespace lve {
 
 	} // endSwapChainRenderPass
 
+	void LveRenderer::enableParallelRecording(uint32_t threadCount) {
+		assert(!isFrameStarted && "Can't switch to parallel recording while a frame is in progress");
+
+		// the secondaries of an earlier recorder may still be executing
+		if (parallelRecorder != nullptr)
+			vkDeviceWaitIdle(lveDevice.device());
+
+		parallelRecorder = std::make_unique<LveParallelRecorder>(lveDevice, LveSwapChain::MAX_FRAMES_IN_FLIGHT, threadCount);
+
+	} // enableParallelRecording
+
 	LveRenderer::~LveRenderer() {
 		freeCommandBuffers();
 
@@ -3,6 +3,7 @@
 #include "lve_window.hpp"
 #include "lve_device.hpp"
 #include "lve_swap_chain.hpp"
+#include "lve_parallel_recorder.hpp"
 
 // std
 #include <memory>
@@ -24,6 +25,13 @@ namespace lve {
         void beginSwapChainRenderPass(VkCommandBuffer commandBuffer);
         void endSwapChainRenderPass(VkCommandBuffer commandBuffer);
 
+        // from now on the swap chain render pass only takes secondary command buffers, recorded by threadCount threads
+        // (0 = one per hardware thread) through getParallelRecorder, call outside of a frame
+        void enableParallelRecording(uint32_t threadCount = 0);
+
+        // null while the render pass is recorded inline into the frame's command buffer
+        LveParallelRecorder* getParallelRecorder() const { return parallelRecorder.get(); } // getParallelRecorder
+
         bool isFrameInProgress() const { return isFrameStarted; } // isFrameInProgress
 
         VkCommandBuffer getCurrentCommandBuffer() const { 
@@ -56,6 +64,7 @@ namespace lve {
 
         std::unique_ptr<LveSwapChain> lveSwapChain;
         std::vector<VkCommandBuffer> commandBuffers;
+        std::unique_ptr<LveParallelRecorder> parallelRecorder;
 
         uint32_t currentImageIndex; 
         int currentFrameIndex;
@@ -50,7 +50,7 @@ namespace lve {
         for (int i = 0; i < depthImages.size(); i++) {
             vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
             vkDestroyImage(device.device(), depthImages[i], nullptr);
-            vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+            device.memoryAllocator().free(depthImageMemorys[i]);
         }
 
         for (auto framebuffer : swapChainFramebuffers) {
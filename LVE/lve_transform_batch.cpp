@@ -0,0 +1,194 @@
+#include "lve_transform_batch.hpp"
+
+// std
+#include <cmath>
+
+// SSE2 is part of x64, so the vector path needs no /arch flag and no runtime check
+#if defined(_M_X64) || defined(__x86_64__)
+#define LVE_TRANSFORM_X64
+#include <emmintrin.h>
+#endif
+
+namespace lve {
+
+	namespace {
+
+#ifdef LVE_TRANSFORM_X64
+		// sine and cosine of four angles at once with the single precision polynomials of Cephes (as in sse_mathfun),
+		// the angle is reduced to [-pi/4, pi/4] around the nearest multiple of pi/2 in three steps so it keeps its
+		// precision for angles up to a few thousand radians, the multiple picks the polynomial and the signs
+		void sinCos(__m128 x, __m128& sine, __m128& cosine) {
+			const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+			__m128 signSine = _mm_and_ps(x, signMask);
+			x = _mm_andnot_ps(signMask, x);
+
+			// the octant of |x| rounded up to even, so y is the nearest multiple of pi/2 counted in pi/4
+			__m128i octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.27323954473516f)));
+			octant = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+			__m128 y = _mm_cvtepi32_ps(octant);
+
+			// octants 4 and 6 negate the sine, 2 and 4 the cosine, 2 and 6 swap the two polynomials
+			signSine = _mm_xor_ps(signSine, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29)));
+			__m128 signCosine = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)), _mm_set1_epi32(4)), 29));
+			__m128 keepMask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_setzero_si128()));
+
+			// pi/4 split into three parts, the first ones multiply by y without rounding
+			x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(0.78515625f)));
+			x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(2.4187564849853515625e-4f)));
+			x = _mm_sub_ps(x, _mm_mul_ps(y, _mm_set1_ps(3.77489497744594108e-8f)));
+			__m128 z = _mm_mul_ps(x, x);
+
+			__m128 c = _mm_set1_ps(2.443315711809948e-5f);
+			c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(-1.388731625493765e-3f));
+			c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(4.166664568298827e-2f));
+			c = _mm_mul_ps(_mm_mul_ps(c, z), z);
+			c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.f));
+
+			__m128 s = _mm_set1_ps(-1.9515295891e-4f);
+			s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(8.3321608736e-3f));
+			s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(-1.6666654611e-1f));
+			s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, z), x), x);
+
+			sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(keepMask, s), _mm_andnot_ps(keepMask, c)), signSine);
+			cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(keepMask, c), _mm_andnot_ps(keepMask, s)), signCosine);
+
+		} // sinCos
+#endif
+
+	} // namespace
+
+	bool LveTransformBatch::isSupported(Path path) {
+		switch (path) {
+#ifdef LVE_TRANSFORM_X64
+		case Path::Sse:
+			return true;
+#endif
+		case Path::Scalar:
+			return true;
+
+		default:
+			return false;
+
+		} // switch
+
+	} // isSupported
+
+	LveTransformBatch::Path LveTransformBatch::fastestPath() {
+		return isSupported(Path::Sse) ? Path::Sse : Path::Scalar;
+
+	} // fastestPath
+
+	void LveTransformBatch::clear() {
+		eulerTransforms.clear();
+		orientationTransforms.clear();
+		angleX.clear();
+		angleY.clear();
+		angleZ.clear();
+
+	} // clear
+
+	void LveTransformBatch::add(TransformComponent& transform) {
+		if (!transform.isDirty())
+			return;
+
+		if (transform.hasOrientation()) {
+			orientationTransforms.push_back(&transform);
+			return;
+
+		} // if
+
+		eulerTransforms.push_back(&transform);
+		angleX.push_back(transform.getRotation().x);
+		angleY.push_back(transform.getRotation().y);
+		angleZ.push_back(transform.getRotation().z);
+
+	} // add
+
+	void LveTransformBatch::update(Path path) {
+		uint32_t count = static_cast<uint32_t>(eulerTransforms.size());
+		for (auto& elements : rotations)
+			elements.resize(count);
+
+		uint32_t first = 0;
+		if (path == Path::Sse && isSupported(Path::Sse))
+			first = rotationsSse();
+
+		rotationsScalar(first);
+
+		for (uint32_t i = 0; i < count; i++) {
+			glm::mat3 rotation{
+				{ rotations[0][i], rotations[1][i], rotations[2][i] },
+				{ rotations[3][i], rotations[4][i], rotations[5][i] },
+				{ rotations[6][i], rotations[7][i], rotations[8][i] }
+
+			}; // rotation
+
+			eulerTransforms[i]->build(rotation);
+
+		} // for
+
+		for (TransformComponent* transform : orientationTransforms)
+			transform->build(transform->rotationMatrix());
+
+	} // update
+
+	// the same elements as TransformComponent::rotationMatrix, Ry * Rx * Rz column by column
+	void LveTransformBatch::rotationsScalar(uint32_t first) {
+		for (uint32_t i = first; i < eulerTransforms.size(); i++) {
+			const float c3 = std::cos(angleZ[i]);
+			const float s3 = std::sin(angleZ[i]);
+			const float c2 = std::cos(angleX[i]);
+			const float s2 = std::sin(angleX[i]);
+			const float c1 = std::cos(angleY[i]);
+			const float s1 = std::sin(angleY[i]);
+
+			rotations[0][i] = c1 * c3 + s1 * s2 * s3;
+			rotations[1][i] = c2 * s3;
+			rotations[2][i] = c1 * s2 * s3 - c3 * s1;
+			rotations[3][i] = c3 * s1 * s2 - c1 * s3;
+			rotations[4][i] = c2 * c3;
+			rotations[5][i] = c1 * c3 * s2 + s1 * s3;
+			rotations[6][i] = c2 * s1;
+			rotations[7][i] = -s2;
+			rotations[8][i] = c1 * c2;
+
+		} // for
+
+	} // rotationsScalar
+
+#ifdef LVE_TRANSFORM_X64
+	uint32_t LveTransformBatch::rotationsSse() {
+		uint32_t count = static_cast<uint32_t>(eulerTransforms.size());
+
+		uint32_t first = 0;
+		for (; first + 4 <= count; first += 4) {
+			__m128 s1, c1, s2, c2, s3, c3;
+			sinCos(_mm_loadu_ps(&angleY[first]), s1, c1);
+			sinCos(_mm_loadu_ps(&angleX[first]), s2, c2);
+			sinCos(_mm_loadu_ps(&angleZ[first]), s3, c3);
+
+			__m128 s1s2 = _mm_mul_ps(s1, s2);
+			__m128 c1s2 = _mm_mul_ps(c1, s2);
+			_mm_storeu_ps(&rotations[0][first], _mm_add_ps(_mm_mul_ps(c1, c3), _mm_mul_ps(s1s2, s3)));
+			_mm_storeu_ps(&rotations[1][first], _mm_mul_ps(c2, s3));
+			_mm_storeu_ps(&rotations[2][first], _mm_sub_ps(_mm_mul_ps(c1s2, s3), _mm_mul_ps(c3, s1)));
+			_mm_storeu_ps(&rotations[3][first], _mm_sub_ps(_mm_mul_ps(c3, s1s2), _mm_mul_ps(c1, s3)));
+			_mm_storeu_ps(&rotations[4][first], _mm_mul_ps(c2, c3));
+			_mm_storeu_ps(&rotations[5][first], _mm_add_ps(_mm_mul_ps(c1s2, c3), _mm_mul_ps(s1, s3)));
+			_mm_storeu_ps(&rotations[6][first], _mm_mul_ps(c2, s1));
+			_mm_storeu_ps(&rotations[7][first], _mm_sub_ps(_mm_setzero_ps(), s2));
+			_mm_storeu_ps(&rotations[8][first], _mm_mul_ps(c1, c2));
+
+		} // for
+
+		return first;
+
+	} // rotationsSse
+#else
+	uint32_t LveTransformBatch::rotationsSse() {
+		return 0;
+
+	} // rotationsSse
+#endif
+
+} // lve
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "lve_game_object.hpp"
+
+// std
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+	// rebuilds the matrices of many dirty transforms in one pass: the angles are gathered into contiguous arrays, the
+	// sines and cosines of 4 transforms at a time come out of one SSE2 polynomial and the rotations are built in the
+	// same lanes, only the scale and the write back into each TransformComponent are per object
+	// transforms with a quaternion need no trig, they are built one by one in the same pass
+	class LveTransformBatch {
+	public:
+		// the implementations of update, Sse agrees with Scalar (std::sin / std::cos) to a few ulp
+		enum class Path { Scalar, Sse };
+
+		// compiled in, Scalar always is
+		static bool isSupported(Path path);
+		static Path fastestPath();
+
+		void clear();
+
+		// clean transforms are skipped, so adding every object each frame only costs a branch for the static ones
+		void add(TransformComponent& transform);
+
+		// the transforms added since clear, no matter their representation
+		uint32_t size() const { return static_cast<uint32_t>(eulerTransforms.size() + orientationTransforms.size()); } // size
+
+		// builds every transform added since clear, they are clean afterwards
+		void update() { update(fastestPath()); } // update
+		void update(Path path);
+
+	private:
+		// the vector path stops at the last whole register and returns where the scalar path has to carry on
+		void rotationsScalar(uint32_t first);
+		uint32_t rotationsSse();
+
+		std::vector<TransformComponent*> eulerTransforms;
+		std::vector<TransformComponent*> orientationTransforms;
+
+		// the angles of eulerTransforms, and the elements of their rotations column by column once update has run
+		std::vector<float> angleX, angleY, angleZ;
+		std::vector<float> rotations[9];
+
+	}; // LveTransformBatch
+
+} // lve
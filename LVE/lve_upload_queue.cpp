@@ -0,0 +1,611 @@
+#include "lve_upload_queue.hpp"
+
+// std
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+	namespace {
+
+		VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+			return (value + alignment - 1) & ~(alignment - 1);
+
+		} // alignUp
+
+		// buffer to image copies need offsets that are a multiple of 4 and of the texel size, 16 covers every format
+		constexpr VkDeviceSize MIN_COPY_ALIGNMENT = 16;
+
+		// everything that reads uploaded geometry, uniforms or textures
+		constexpr VkPipelineStageFlags CONSUMER_STAGES =
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+		constexpr VkAccessFlags CONSUMER_ACCESS =
+			VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+		VkCommandPool createCommandPool(VkDevice device, uint32_t queueFamily) {
+			VkCommandPoolCreateInfo poolInfo{};
+			poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolInfo.queueFamilyIndex = queueFamily;
+			poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+			VkCommandPool pool;
+			if (vkCreateCommandPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+				throw std::runtime_error("failed to create upload command pool!");
+
+			return pool;
+
+		} // createCommandPool
+
+		VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool pool) {
+			VkCommandBufferAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocInfo.commandPool = pool;
+			allocInfo.commandBufferCount = 1;
+
+			VkCommandBuffer commandBuffer;
+			if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+				throw std::runtime_error("failed to allocate upload command buffer!");
+
+			return commandBuffer;
+
+		} // allocateCommandBuffer
+
+		VkFence createFence(VkDevice device) {
+			VkFenceCreateInfo fenceInfo{};
+			fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+			VkFence fence;
+			if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+				throw std::runtime_error("failed to create upload fence!");
+
+			return fence;
+
+		} // createFence
+
+		void beginCommandBuffer(VkCommandBuffer commandBuffer) {
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+			if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+				throw std::runtime_error("failed to begin upload command buffer!");
+
+		} // beginCommandBuffer
+
+	} // namespace
+
+	LveUploadQueue::LveUploadQueue(LveDevice& device, VkDeviceSize ringSize) : lveDevice{ device }, ringSize{ ringSize } {
+		copyAlignment = std::max(MIN_COPY_ALIGNMENT, lveDevice.properties.limits.optimalBufferCopyOffsetAlignment);
+
+		QueueFamilyIndices indices = lveDevice.findPhysicalQueueFamilies();
+		dedicatedTransfer = lveDevice.hasDedicatedTransferQueue();
+		graphicsFamily = indices.graphicsFamily;
+		transferFamily = dedicatedTransfer ? indices.transferFamily : indices.graphicsFamily;
+		queue = lveDevice.transferQueue();
+
+		commandPool = createCommandPool(lveDevice.device(), transferFamily);
+		if (dedicatedTransfer)
+			acquirePool = createCommandPool(lveDevice.device(), graphicsFamily);
+
+		// note: HOST = CPU and DEVICE = GPU
+		ring = std::make_unique<LveBuffer>(
+			lveDevice,
+			ringSize,
+			1,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		ring->map();
+		ringData = static_cast<char*>(ring->getMappedMemory());
+
+	} // LveUploadQueue
+
+	LveUploadQueue::~LveUploadQueue() {
+		flush();
+
+		while (!acquiring.empty()) {
+			vkWaitForFences(lveDevice.device(), 1, &acquiring.front().acquireFence, VK_TRUE, UINT64_MAX);
+			recycle(acquiring.front());
+			acquiring.pop_front();
+
+		} // while
+
+		for (auto& batch : freeBatches) {
+			vkDestroyFence(lveDevice.device(), batch.fence, nullptr);
+			vkFreeCommandBuffers(lveDevice.device(), commandPool, 1, &batch.commandBuffer);
+
+			if (batch.semaphore != VK_NULL_HANDLE) {
+				vkDestroySemaphore(lveDevice.device(), batch.semaphore, nullptr);
+				vkDestroyFence(lveDevice.device(), batch.acquireFence, nullptr);
+				vkFreeCommandBuffers(lveDevice.device(), acquirePool, 1, &batch.acquireCommandBuffer);
+
+			} // if
+
+		} // for
+
+		vkDestroyCommandPool(lveDevice.device(), commandPool, nullptr);
+		if (acquirePool != VK_NULL_HANDLE)
+			vkDestroyCommandPool(lveDevice.device(), acquirePool, nullptr);
+
+	} // ~LveUploadQueue
+
+	LveUploadQueue::Ticket LveUploadQueue::uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size) {
+		assert(size > 0 && "cannot upload an empty range");
+
+		BufferCopy copy{};
+		copy.dstBuffer = dstBuffer;
+		copy.region.dstOffset = dstOffset;
+		copy.region.size = size;
+		stage(data, size, copy.srcBuffer, copy.region.srcOffset);
+
+		Batch& batch = recordingBatch();
+		batch.bufferCopies.push_back(copy);
+		return batch.ticket;
+
+	} // uploadBuffer
+
+	LveUploadQueue::Ticket LveUploadQueue::uploadImage(VkImage image, uint32_t width, uint32_t height, uint32_t layerCount, const void* data, VkDeviceSize size) {
+		assert(size > 0 && "cannot upload an empty image");
+
+		ImageCopy copy{};
+		copy.image = image;
+		copy.region.bufferRowLength = 0;
+		copy.region.bufferImageHeight = 0;
+		copy.region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		copy.region.imageSubresource.mipLevel = 0;
+		copy.region.imageSubresource.baseArrayLayer = 0;
+		copy.region.imageSubresource.layerCount = layerCount;
+		copy.region.imageOffset = { 0, 0, 0 };
+		copy.region.imageExtent = { width, height, 1 };
+		stage(data, size, copy.srcBuffer, copy.region.bufferOffset);
+
+		Batch& batch = recordingBatch();
+		batch.imageCopies.push_back(copy);
+		return batch.ticket;
+
+	} // uploadImage
+
+	LveUploadQueue::Ticket LveUploadQueue::submit() {
+		retire(false);
+
+		if (!recording)
+			return nextTicket - 1;
+
+		Batch batch = std::move(current);
+		current = Batch{};
+		recording = false;
+
+		recordCopies(batch);
+
+		if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("failed to record upload command buffer!");
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.commandBuffer;
+
+		if (dedicatedTransfer) {
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &batch.semaphore;
+
+		} // if
+
+		if (vkQueueSubmit(queue, 1, &submitInfo, batch.fence) != VK_SUCCESS)
+			throw std::runtime_error("failed to submit upload command buffer!");
+
+		stats.submitCount++;
+		pending.push_back(std::move(batch));
+		return pending.back().ticket;
+
+	} // submit
+
+	bool LveUploadQueue::isComplete(Ticket ticket) {
+		if (ticket <= completedTicket)
+			return true;
+
+		retire(false);
+		return ticket <= completedTicket;
+
+	} // isComplete
+
+	void LveUploadQueue::wait(Ticket ticket) {
+		assert(ticket < nextTicket && "no batch has this ticket");
+		if (recording && ticket >= current.ticket)
+			submit();
+
+		while (ticket > completedTicket)
+			retire(true);
+
+	} // wait
+
+	void LveUploadQueue::flush() {
+		wait(submit());
+
+	} // flush
+
+	void LveUploadQueue::printStats(std::ostream& out) const {
+		out << "Upload queue" << (dedicatedTransfer ? " (transfer family " : " (graphics family ") << transferFamily << "): "
+			<< stats.uploadCount << " uploads, " << stats.uploadedBytes / 1024 << " KiB in "
+			<< stats.submitCount << " submits, " << stats.acquireCount << " acquires, "
+			<< stats.stallCount << " ring stalls, " << stats.oversizedCount << " oversized\n";
+
+	} // printStats
+
+	void LveUploadQueue::stage(const void* data, VkDeviceSize size, VkBuffer& srcBuffer, VkDeviceSize& srcOffset) {
+		stats.uploadCount++;
+		stats.uploadedBytes += size;
+
+		// anything over half the ring would drain it for a single copy, it gets its own staging buffer instead
+		if (size > ringSize / 2) {
+			auto staging = std::make_unique<LveBuffer>(
+				lveDevice,
+				size,
+				1,
+				VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			staging->map();
+			staging->writeToBuffer(const_cast<void*>(data));
+			srcBuffer = staging->getBuffer();
+			srcOffset = 0;
+
+			recordingBatch().oversized.push_back(std::move(staging));
+			stats.oversizedCount++;
+			return;
+
+		} // if
+
+		retire(false);
+
+		// only block when the ring is full, the batch being recorded has to go out first if it holds the space
+		while (!allocateRing(size, srcOffset)) {
+			if (pending.empty())
+				submit();
+
+			retire(true);
+			stats.stallCount++;
+
+		} // while
+
+		std::memcpy(ringData + srcOffset, data, static_cast<size_t>(size));
+		srcBuffer = ring->getBuffer();
+
+		Batch& batch = recordingBatch();
+		batch.usesRing = true;
+		batch.ringEnd = ringHead;
+
+	} // stage
+
+	bool LveUploadQueue::allocateRing(VkDeviceSize size, VkDeviceSize& offset) {
+		VkDeviceSize start = alignUp(ringHead, copyAlignment);
+
+		if (ringWrapped) {
+			// the free space is between the head and the tail
+			if (start + size > ringTail)
+				return false;
+
+		} // if
+		else if (start + size > ringSize) {
+			// not enough room before the end, go around to the front if the oldest batch has left room there
+			if (size > ringTail)
+				return false;
+
+			start = 0;
+			ringWrapped = true;
+
+		} // else if
+
+		offset = start;
+		ringHead = start + size;
+		return true;
+
+	} // allocateRing
+
+	void LveUploadQueue::recordCopies(Batch& batch) {
+		VkCommandBuffer commandBuffer = batch.commandBuffer;
+
+		std::vector<VkImageMemoryBarrier> imageBarriers(batch.imageCopies.size());
+		for (size_t i = 0; i < batch.imageCopies.size(); i++) {
+			VkImageMemoryBarrier& barrier = imageBarriers[i];
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			barrier.image = batch.imageCopies[i].image;
+			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			barrier.subresourceRange.baseMipLevel = 0;
+			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = batch.imageCopies[i].region.imageSubresource.layerCount;
+
+		} // for
+
+		if (!imageBarriers.empty()) {
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				0,
+				0, nullptr,
+				0, nullptr,
+				static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+		} // if
+
+		// copies between the same pair of buffers go out as the regions of a single vkCmdCopyBuffer
+		std::stable_sort(batch.bufferCopies.begin(), batch.bufferCopies.end(), [](const BufferCopy& a, const BufferCopy& b) {
+			return a.srcBuffer != b.srcBuffer ? a.srcBuffer < b.srcBuffer : a.dstBuffer < b.dstBuffer;
+
+		}); // stable_sort
+
+		std::vector<VkBufferCopy> regions;
+		for (size_t first = 0; first < batch.bufferCopies.size();) {
+			size_t last = first;
+			regions.clear();
+			while (last < batch.bufferCopies.size()
+				&& batch.bufferCopies[last].srcBuffer == batch.bufferCopies[first].srcBuffer
+				&& batch.bufferCopies[last].dstBuffer == batch.bufferCopies[first].dstBuffer) {
+				regions.push_back(batch.bufferCopies[last].region);
+				last++;
+
+			} // while
+
+			vkCmdCopyBuffer(
+				commandBuffer,
+				batch.bufferCopies[first].srcBuffer,
+				batch.bufferCopies[first].dstBuffer,
+				static_cast<uint32_t>(regions.size()),
+				regions.data());
+
+			first = last;
+
+		} // for
+
+		for (const auto& copy : batch.imageCopies)
+			vkCmdCopyBufferToImage(commandBuffer, copy.srcBuffer, copy.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy.region);
+
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+		ownershipBarriers(batch, bufferBarriers, imageBarriers);
+
+		if (dedicatedTransfer) {
+			// release half of the ownership transfer, the graphics queue's acquire makes the writes visible there
+			for (auto& barrier : bufferBarriers) {
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = 0;
+
+			} // for
+
+			for (auto& barrier : imageBarriers) {
+				barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				barrier.dstAccessMask = 0;
+
+			} // for
+
+			vkCmdPipelineBarrier(
+				commandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0,
+				0, nullptr,
+				static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+				static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+			return;
+
+		} // if
+
+		// same queue, make the copies visible to the vertex input and the shaders of every later submission on it
+		for (auto& barrier : imageBarriers) {
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		} // for
+
+		VkMemoryBarrier memoryBarrier{};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		memoryBarrier.dstAccessMask = CONSUMER_ACCESS;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			CONSUMER_STAGES,
+			0,
+			1, &memoryBarrier,
+			0, nullptr,
+			static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+	} // recordCopies
+
+	void LveUploadQueue::ownershipBarriers(const Batch& batch, std::vector<VkBufferMemoryBarrier>& bufferBarriers, std::vector<VkImageMemoryBarrier>& imageBarriers) const {
+		uint32_t srcFamily = dedicatedTransfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED;
+		uint32_t dstFamily = dedicatedTransfer ? graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+
+		// only the written ranges change hands, the graphics queue keeps drawing from the rest of a pool buffer
+		bufferBarriers.resize(batch.bufferCopies.size());
+		for (size_t i = 0; i < batch.bufferCopies.size(); i++) {
+			VkBufferMemoryBarrier& barrier = bufferBarriers[i];
+			barrier = VkBufferMemoryBarrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barrier.srcQueueFamilyIndex = srcFamily;
+			barrier.dstQueueFamilyIndex = dstFamily;
+			barrier.buffer = batch.bufferCopies[i].dstBuffer;
+			barrier.offset = batch.bufferCopies[i].region.dstOffset;
+			barrier.size = batch.bufferCopies[i].region.size;
+
+		} // for
+
+		imageBarriers.resize(batch.imageCopies.size());
+		for (size_t i = 0; i < batch.imageCopies.size(); i++) {
+			VkImageMemoryBarrier& barrier = imageBarriers[i];
+			barrier = VkImageMemoryBarrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			barrier.srcQueueFamilyIndex = srcFamily;
+			barrier.dstQueueFamilyIndex = dstFamily;
+			barrier.image = batch.imageCopies[i].image;
+			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			barrier.subresourceRange.baseMipLevel = 0;
+			barrier.subresourceRange.levelCount = 1;
+			barrier.subresourceRange.baseArrayLayer = 0;
+			barrier.subresourceRange.layerCount = batch.imageCopies[i].region.imageSubresource.layerCount;
+
+		} // for
+
+	} // ownershipBarriers
+
+	void LveUploadQueue::submitAcquire(Batch& batch) {
+		std::vector<VkBufferMemoryBarrier> bufferBarriers;
+		std::vector<VkImageMemoryBarrier> imageBarriers;
+		ownershipBarriers(batch, bufferBarriers, imageBarriers);
+
+		for (auto& barrier : bufferBarriers)
+			barrier.dstAccessMask = CONSUMER_ACCESS;
+
+		for (auto& barrier : imageBarriers)
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		beginCommandBuffer(batch.acquireCommandBuffer);
+
+		vkCmdPipelineBarrier(
+			batch.acquireCommandBuffer,
+			CONSUMER_STAGES,
+			CONSUMER_STAGES,
+			0,
+			0, nullptr,
+			static_cast<uint32_t>(bufferBarriers.size()), bufferBarriers.data(),
+			static_cast<uint32_t>(imageBarriers.size()), imageBarriers.data());
+
+		if (vkEndCommandBuffer(batch.acquireCommandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("failed to record acquire command buffer!");
+
+		// the transfer fence has already signaled, so this wait is satisfied the moment the queue reaches it
+		VkPipelineStageFlags waitStage = CONSUMER_STAGES;
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &batch.semaphore;
+		submitInfo.pWaitDstStageMask = &waitStage;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.acquireCommandBuffer;
+
+		if (vkQueueSubmit(lveDevice.graphicsQueue(), 1, &submitInfo, batch.acquireFence) != VK_SUCCESS)
+			throw std::runtime_error("failed to submit acquire command buffer!");
+
+		stats.acquireCount++;
+
+	} // submitAcquire
+
+	void LveUploadQueue::recycle(Batch& batch) {
+		vkResetFences(lveDevice.device(), 1, &batch.fence);
+		vkResetCommandBuffer(batch.commandBuffer, 0);
+
+		if (batch.acquireFence != VK_NULL_HANDLE) {
+			vkResetFences(lveDevice.device(), 1, &batch.acquireFence);
+			vkResetCommandBuffer(batch.acquireCommandBuffer, 0);
+
+		} // if
+
+		batch.usesRing = false;
+		batch.bufferCopies.clear();
+		batch.imageCopies.clear();
+		batch.oversized.clear();
+		freeBatches.push_back(std::move(batch));
+
+	} // recycle
+
+	void LveUploadQueue::retire(bool waitOldest) {
+		while (!pending.empty()) {
+			Batch& batch = pending.front();
+			if (waitOldest) {
+				vkWaitForFences(lveDevice.device(), 1, &batch.fence, VK_TRUE, UINT64_MAX);
+				waitOldest = false;
+
+			} // if
+			else if (vkGetFenceStatus(lveDevice.device(), batch.fence) != VK_SUCCESS)
+				break;
+
+			// batches finish in submission order, so the tail simply follows them, an end at or before the tail
+			// means this batch went around the end of the ring
+			if (batch.usesRing) {
+				if (batch.ringEnd <= ringTail)
+					ringWrapped = false;
+
+				ringTail = batch.ringEnd;
+
+			} // if
+
+			batch.oversized.clear();
+			completedTicket = batch.ticket;
+
+			if (dedicatedTransfer) {
+				submitAcquire(batch);
+				acquiring.push_back(std::move(batch));
+
+			} // if
+			else
+				recycle(batch);
+
+			pending.pop_front();
+
+		} // while
+
+		// the semaphore and command buffers of an acquire can be reused once the graphics queue is past it
+		while (!acquiring.empty() && vkGetFenceStatus(lveDevice.device(), acquiring.front().acquireFence) == VK_SUCCESS) {
+			recycle(acquiring.front());
+			acquiring.pop_front();
+
+		} // while
+
+		// nothing in flight or being recorded reads the ring, start over at the front
+		if (!ringWrapped && ringHead == ringTail)
+			ringHead = ringTail = 0;
+
+	} // retire
+
+	LveUploadQueue::Batch& LveUploadQueue::recordingBatch() {
+		if (recording)
+			return current;
+
+		if (!freeBatches.empty()) {
+			current = std::move(freeBatches.back());
+			freeBatches.pop_back();
+
+		} // if
+		else {
+			current.commandBuffer = allocateCommandBuffer(lveDevice.device(), commandPool);
+			current.fence = createFence(lveDevice.device());
+
+			if (dedicatedTransfer) {
+				VkSemaphoreCreateInfo semaphoreInfo{};
+				semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+				if (vkCreateSemaphore(lveDevice.device(), &semaphoreInfo, nullptr, &current.semaphore) != VK_SUCCESS)
+					throw std::runtime_error("failed to create upload semaphore!");
+
+				current.acquireCommandBuffer = allocateCommandBuffer(lveDevice.device(), acquirePool);
+				current.acquireFence = createFence(lveDevice.device());
+
+			} // if
+
+		} // else
+
+		beginCommandBuffer(current.commandBuffer);
+
+		// the ticket is known up front so resources can be tagged with the batch that carries their data
+		current.ticket = nextTicket++;
+		recording = true;
+		return current;
+
+	} // recordingBatch
+
+} // lve
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_buffer.hpp"
+
+// std
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+namespace lve {
+
+	// batches host to device copies: the data goes into a persistently mapped staging ring, the copies are recorded
+	// into one command buffer and submitted together with a fence, instead of a staging buffer, a submit and a
+	// vkQueueWaitIdle per copy, ring space is recycled once the fence of the batch that used it has signaled
+	//
+	// on devices with a transfer only queue family the batches run there, overlapping with rendering, and release
+	// what they wrote to the graphics family, once a batch's fence has signaled a small graphics submission waits on
+	// its semaphore and acquires the resources, so the graphics queue never waits for a copy still in flight
+	class LveUploadQueue {
+	public:
+		static constexpr VkDeviceSize DEFAULT_RING_SIZE = 32 * 1024 * 1024;
+
+		// identifies a batch, 0 is never used so it can mean "nothing to wait for"
+		using Ticket = uint64_t;
+
+		struct Stats {
+			uint64_t uploadCount = 0;
+			uint64_t submitCount = 0;
+			uint64_t stallCount = 0; // times an upload had to wait for the GPU because the ring was full
+			uint64_t oversizedCount = 0; // uploads too large for the ring that got a staging buffer of their own
+			uint64_t acquireCount = 0; // ownership transfers submitted to the graphics queue
+			VkDeviceSize uploadedBytes = 0;
+
+		}; // Stats
+
+		LveUploadQueue(LveDevice& device, VkDeviceSize ringSize = DEFAULT_RING_SIZE);
+		~LveUploadQueue();
+
+		LveUploadQueue(const LveUploadQueue&) = delete;
+		LveUploadQueue& operator=(const LveUploadQueue&) = delete;
+
+		// the data is copied right away, the GPU copy happens when the batch is submitted, copies within one batch
+		// run unordered so they must not write overlapping ranges, returns the ticket of the batch carrying it
+		Ticket uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size);
+
+		// fills the first mip level of every layer, the image goes from undefined to shader read only optimal
+		Ticket uploadImage(VkImage image, uint32_t width, uint32_t height, uint32_t layerCount, const void* data, VkDeviceSize size);
+
+		// submits everything recorded since the last submit and picks up finished batches, call it once a frame
+		// while streaming, returns the batch's ticket or the last one when nothing was recorded
+		Ticket submit();
+
+		// complete means the data is on the graphics queue's side: everything submitted to it from now on sees it
+		bool isComplete(Ticket ticket);
+		void wait(Ticket ticket);
+
+		// submit and wait for every batch
+		void flush();
+
+		const Stats& getStats() const { return stats; } // getStats
+		void printStats(std::ostream& out) const;
+
+	private:
+		struct BufferCopy {
+			VkBuffer srcBuffer;
+			VkBuffer dstBuffer;
+			VkBufferCopy region;
+
+		}; // BufferCopy
+
+		struct ImageCopy {
+			VkBuffer srcBuffer;
+			VkImage image;
+			VkBufferImageCopy region;
+
+		}; // ImageCopy
+
+		struct Batch {
+			VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+			VkFence fence = VK_NULL_HANDLE;
+
+			// only used with a dedicated transfer queue, the semaphore orders the release before the acquire
+			VkSemaphore semaphore = VK_NULL_HANDLE;
+			VkCommandBuffer acquireCommandBuffer = VK_NULL_HANDLE;
+			VkFence acquireFence = VK_NULL_HANDLE;
+
+			Ticket ticket = 0;
+			bool usesRing = false;
+			VkDeviceSize ringEnd = 0; // ring head after this batch's last copy, the tail moves here when it retires
+			std::vector<BufferCopy> bufferCopies;
+			std::vector<ImageCopy> imageCopies;
+			std::vector<std::unique_ptr<LveBuffer>> oversized; // kept alive until the fence signals
+
+		}; // Batch
+
+		// copies the data into the ring, or into a buffer of its own when it is too large for it
+		void stage(const void* data, VkDeviceSize size, VkBuffer& srcBuffer, VkDeviceSize& srcOffset);
+		bool allocateRing(VkDeviceSize size, VkDeviceSize& offset);
+		void recordCopies(Batch& batch);
+		void submitAcquire(Batch& batch);
+		void recycle(Batch& batch);
+		void retire(bool waitOldest);
+		Batch& recordingBatch();
+
+		// the ownership transfer of everything the batch wrote, recorded identically on both queues
+		void ownershipBarriers(const Batch& batch, std::vector<VkBufferMemoryBarrier>& bufferBarriers, std::vector<VkImageMemoryBarrier>& imageBarriers) const;
+
+		LveDevice& lveDevice;
+		VkQueue queue;
+		bool dedicatedTransfer;
+		uint32_t transferFamily;
+		uint32_t graphicsFamily;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VkCommandPool acquirePool = VK_NULL_HANDLE;
+		VkDeviceSize copyAlignment;
+
+		std::unique_ptr<LveBuffer> ring;
+		char* ringData = nullptr;
+		VkDeviceSize ringSize;
+		VkDeviceSize ringHead = 0; // next free byte
+		VkDeviceSize ringTail = 0; // first byte an unfinished batch still reads
+		bool ringWrapped = false; // the head went around past the end and is now behind the tail
+
+		bool recording = false;
+		Batch current{};
+		std::deque<Batch> pending; // submitted, oldest first
+		std::deque<Batch> acquiring; // copied, the graphics queue's acquire has not finished yet
+		std::vector<Batch> freeBatches; // command buffers and fences ready for reuse
+
+		Ticket nextTicket = 1;
+		Ticket completedTicket = 0;
+		Stats stats{};
+
+	}; // LveUploadQueue
+
+} // lve
@@ -1,11 +1,28 @@
 #include "first_app.hpp"
+#include "lve_benchmarks.hpp"
 
 // ideally all we will need for now
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+	// offline benchmarks run without opening a window
+	if (argc > 1 && std::string(argv[1]) == "--benchmark") {
+		try {
+			return lve::runBenchmarks(std::vector<std::string>(argv + 2, argv + argc));
+
+		} // try
+		catch (const std::exception& e) {
+			std::cerr << e.what() << "\n";
+			return EXIT_FAILURE;
+
+		} // catch
+
+	} // if
 
-int main() {
 	// calling the function 
 	lve::FirstApp app{};
 
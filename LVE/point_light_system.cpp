@@ -6,7 +6,6 @@
 #include <cassert>
 #include <iostream>
 #include <chrono>
-#include <map>
 
 // libs
 #define GLM_FORCE_RADIANS // forces in radians and not degrees
@@ -90,10 +89,10 @@ namespace lve {
 			assert(lightIndex < MAX_LIGHTS && "Point lights exceed maximum specificed");
 
 			// update light position 
-			obj.transform.translation = glm::vec3(rotateLight * glm::vec4(obj.transform.translation, 1.f));
+			obj.transform.setTranslation(glm::vec3(rotateLight * glm::vec4(obj.transform.getTranslation(), 1.f)));
 
 			// copy light to ubo
-			ubo.pointLights[lightIndex].position = glm::vec4(obj.transform.translation, 1.f);
+			ubo.pointLights[lightIndex].position = glm::vec4(obj.transform.getTranslation(), 1.f);
 			ubo.pointLights[lightIndex].color = glm::vec4(obj.color, obj.pointLight->lightIntensity);
 
 			lightIndex++;
@@ -105,48 +104,69 @@ namespace lve {
 	} // update
 
 	void PointLightSystem::render(FrameInfo& frameInfo) {
-		// sorting the lights
-		std::map<float, LveGameObject::id_t> sorted;
+		// blended, so back to front, the keys only differ in depth
+		glm::vec3 cameraPosition = frameInfo.camera.getPosition();
+		glm::vec3 viewDirection = glm::vec3(frameInfo.camera.getInverseView()[2]);
+		const glm::vec4& farPlane = frameInfo.camera.getFrustum().getPlanes()[5];
+		float farDepth = glm::dot(glm::vec3(farPlane), cameraPosition) + farPlane.w;
+
+		renderQueue.clear();
+		lights.clear();
 		for (auto& kv : frameInfo.gameObject) {
 			auto& obj = kv.second;
 			if (obj.pointLight == nullptr)
 				continue;
-		
-			// calculate distance 
-			auto offset = frameInfo.camera.getPosition() - obj.transform.translation;
-			float distanceSquared = glm::dot(offset, offset);
-			sorted[distanceSquared] = obj.getId(); 
+
+			float depth = glm::dot(obj.transform.getTranslation() - cameraPosition, viewDirection);
+			renderQueue.push(LveRenderQueue::translucentKey(0, 0, 0, LveRenderQueue::quantizeDepth(depth, farDepth)), static_cast<uint32_t>(lights.size()));
+			lights.push_back(&obj);
 
 		} // for
 
-		lvePipeline->bind(frameInfo.commandBuffer);
+		if (lights.empty())
+			return;
+
+		renderQueue.sort();
+
+		// a render pass recorded as secondaries takes nothing inline, the billboards are one more of them
+		if (frameInfo.parallelRecorder != nullptr)
+			frameInfo.parallelRecorder->record(frameInfo.commandBuffer, 1, [&](VkCommandBuffer commandBuffer, uint32_t) { recordLights(commandBuffer, frameInfo); });
+		else
+			recordLights(frameInfo.commandBuffer, frameInfo);
+
+		// there is nothing but the billboards' pipeline to bind, the queue still counts it like every other system's
+		LveRenderQueue::Stats binds{};
+		binds.pipelineBinds = 1;
+		renderQueue.addBinds(binds);
+
+	} // render
+
+	void PointLightSystem::recordLights(VkCommandBuffer commandBuffer, FrameInfo& frameInfo) {
+		lvePipeline->bind(commandBuffer);
 
 		vkCmdBindDescriptorSets
 		(
-			frameInfo.commandBuffer,
+			commandBuffer,
 			VK_PIPELINE_BIND_POINT_GRAPHICS,
 			pipelineLayout,
 			0,
 			1,
 			&frameInfo.globalDescriptorSet,
-			0,
-			nullptr
+			1,
+			&frameInfo.globalUboOffset
 
 		); // vkCmdBindDescriptorSets
 
-		//instead of iterating through every game object, we can iterate through the map in reverse order
-		for (auto it = sorted.rbegin(); it != sorted.rend(); ++it) {
-			// use obj ID to find light object
-			// game obj are not copiable 
-			auto& obj = frameInfo.gameObject.at(it->second);
+		for (const LveRenderQueue::Packet& packet : renderQueue.getPackets()) {
+			const LveGameObject& obj = *lights[packet.item];
 
 			PointLightPushConstants push{};
-			push.position = glm::vec4(obj.transform.translation, 1.f);
+			push.position = glm::vec4(obj.transform.getTranslation(), 1.f);
 			push.color = glm::vec4(obj.color, obj.pointLight->lightIntensity);
-			push.radius = obj.transform.scale.x;
+			push.radius = obj.transform.getScale().x;
 
 			vkCmdPushConstants(
-				frameInfo.commandBuffer,
+				commandBuffer,
 				pipelineLayout,
 				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
 				0,
@@ -155,11 +175,11 @@ namespace lve {
 
 			); // vkCmdPushConstants
 
-			vkCmdDraw(frameInfo.commandBuffer, 6, 1, 0, 0); 
+			vkCmdDraw(commandBuffer, 6, 1, 0, 0); 
 
 		} // for
 
-	} // renderGameObjects
+	} // recordLights
 
 	PointLightSystem::~PointLightSystem() {
 		vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, nullptr);
@@ -5,6 +5,7 @@
 #include "lve_game_object.hpp"
 #include "lve_camera.hpp"
 #include "lve_frame_info.hpp"
+#include "lve_render_queue.hpp"
 
 // std
 #include <memory>
@@ -24,16 +25,21 @@ namespace lve {
 
         void update(FrameInfo& frameInfo, GlobalUbo& ubo);
 
+        const LveRenderQueue& getRenderQueue() const { return renderQueue; } // getRenderQueue
+
 
     private:
         void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
         void createPipeline(VkRenderPass renderPass);
+        void recordLights(VkCommandBuffer commandBuffer, FrameInfo& frameInfo);
 
         LveDevice& lveDevice;
 
         std::unique_ptr<LvePipeline> lvePipeline;
         VkPipelineLayout pipelineLayout;
         std::unique_ptr<LveModel> lveModel;
+        LveRenderQueue renderQueue; // the lights back to front
+        std::vector<LveGameObject*> lights; // what the packets point at
 
     }; // PointLightSystem
 
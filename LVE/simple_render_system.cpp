@@ -1,4 +1,7 @@
 #include "simple_render_system.hpp"
+#include "lve_frustum.hpp"
+#include "lve_swap_chain.hpp"
+#include "lve_gpu_culling.hpp"
 
 // std
 #include <stdexcept>
@@ -6,6 +9,9 @@
 #include <cassert>
 #include <iostream>
 #include <chrono>
+#include <algorithm>
+#include <limits>
+#include <cstring>
 
 // libs
 #define GLM_FORCE_RADIANS // forces in radians and not degrees
@@ -15,35 +21,102 @@
 
 namespace lve {
 
-	struct SimplePushConstantData {
-		glm::mat4 modelMatrix{ 1.f };
-		glm::mat4 normalMatrix{ 1.f };
+	namespace {
 
-	}; // SimplePushConstantData
+		// fraction of the screen height the bounding sphere has to drop below before level k + 1 replaces level k
+		constexpr float LOD_SCREEN_SIZES[LveModel::MAX_LODS - 1] = { 0.5f, 0.25f, 0.125f };
+
+		// a level only changes once the size is this far past its threshold, so objects sitting on one do not flicker
+		constexpr float LOD_HYSTERESIS = 0.1f;
+
+		// instances each frame's buffer starts with, it doubles whenever a frame draws more objects
+		constexpr uint32_t INITIAL_INSTANCE_CAPACITY = 256;
+
+		// parallel recording hands out slices of at least this many draw items, smaller ones cost more to schedule
+		// than to record, and up to this many slices per thread so threads that finish early pick up the rest
+		constexpr uint32_t MIN_ITEMS_PER_TASK = 256;
+		constexpr uint32_t TASKS_PER_THREAD = 2;
+
+		// handles are pointers on 64 bit platforms and integers elsewhere, the C style cast takes either
+		template <typename Handle>
+		uint64_t handleBits(Handle handle) { return (uint64_t)handle; } // handleBits
+
+		// one value per geometry binding for LveRenderQueue::stateId
+		uint64_t bindingState(const LveGeometryPool::Binding& binding) {
+			return handleBits(binding.vertexBuffer) * 0x9E3779B97F4A7C15ull ^ handleBits(binding.indexBuffer) ^ binding.indexType;
+
+		} // bindingState
+
+	} // namespace
 
 	SimpleRenderSystem::SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : lveDevice{device} {
+		createInstanceSets();
 		createPipelineLayout(globalSetLayout);
 		createPipeline(renderPass);
 
+		bool cullOnGpu = LveGpuCulling::isSupported(lveDevice);
+		std::vector<LveDynamicBuffer*> frameInstanceBuffers;
+		for (auto& instanceBuffer : instanceBuffers)
+			frameInstanceBuffers.push_back(instanceBuffer.get());
+
+		if (cullOnGpu) {
+			std::array<float, LveModel::MAX_LODS - 1> lodScreenSizes;
+			std::copy(std::begin(LOD_SCREEN_SIZES), std::end(LOD_SCREEN_SIZES), lodScreenSizes.begin());
+			gpuCulling = std::make_unique<LveGpuCulling>(lveDevice, frameInstanceBuffers, lodScreenSizes);
+
+		} // if
+
+		// without multi draw indirect every group is its own draw call, the records come from the frame allocator
+		indirectDrawing = lveDevice.hasMultiDrawIndirect();
+
 	} // SimpleRenderSystem
 
 
-	void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
-		VkPushConstantRange pushConstantRange{};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-		pushConstantRange.offset = 0; // mainly used for if you are using separate ranges for the vertex and fragment shaders
-		pushConstantRange.size = sizeof(SimplePushConstantData);
+	void SimpleRenderSystem::createInstanceSets() {
+		instancePool = LveDescriptorPool::Builder(lveDevice)
+			.setMaxSets(LveSwapChain::MAX_FRAMES_IN_FLIGHT)
+			.addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, LveSwapChain::MAX_FRAMES_IN_FLIGHT)
+			.build();
+
+		instanceSetLayout = LveDescriptorSetLayout::Builder(lveDevice)
+			.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+			.build();
+
+		// the instances of a frame are read until its fence signals, so every frame in flight writes its own buffer,
+		// the vertex shader and the culling pass both read it as a storage buffer
+		for (int i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+			instanceBuffers.push_back(std::make_unique<LveDynamicBuffer>(
+				lveDevice,
+				sizeof(LveModel::Instance),
+				INITIAL_INSTANCE_CAPACITY,
+				VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT));
+
+			VkDescriptorSet instanceSet;
+			auto bufferInfo = instanceBuffers.back()->buffer().descriptorInfo();
+			if (!LveDescriptorWriter(*instanceSetLayout, *instancePool).writeBuffer(0, &bufferInfo).build(instanceSet))
+				throw std::runtime_error("failed to allocate instance descriptor set!");
+
+			// growing the buffer points this frame's set at the new one
+			instanceBuffers.back()->addDescriptor(instanceSet, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, i);
+			instanceSets.push_back(instanceSet);
+
+		} // for
 
-		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout };
+	} // createInstanceSets
+
+	void SimpleRenderSystem::createPipelineLayout(VkDescriptorSetLayout globalSetLayout) {
+		std::vector<VkDescriptorSetLayout> descriptorSetLayouts{ globalSetLayout, instanceSetLayout->getDescriptorSetLayout() };
 
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 		pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size()); 
 		pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
 
-		// push constants are a way to send efficiently a very small amount of data through to our shader programs
-		pipelineLayoutInfo.pushConstantRangeCount = 1;
-		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+		// the per object matrices are read from the LveModel::Instance storage buffer at firstInstance, so there are no
+		// push constants and the whole push constant range is left for whatever needs it next
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
 
 		if (vkCreatePipelineLayout(lveDevice.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create pipeline layout!");
@@ -62,58 +135,436 @@ namespace lve {
 
 		pipelineConfig.renderPass = renderPass;
 		pipelineConfig.pipelineLayout = pipelineLayout;
+
+		// culling whole meshlets by their normal cone is only invisible when the rasterizer drops back faces too
+		meshletBackfaceCulling = (pipelineConfig.rasterizationInfo.cullMode & VK_CULL_MODE_BACK_BIT) != 0;
+
 		lvePipeline = std::make_unique<LvePipeline>(
 			lveDevice,
 			"C:\\Users\\suraj\\OneDrive\\Documents\\Visual Studio Projects\\Little Vulkan Game Engine\\simple_shader.vert.spv",
 			"C:\\Users\\suraj\\OneDrive\\Documents\\Visual Studio Projects\\Little Vulkan Game Engine\\simple_shader.frag.spv",
 			pipelineConfig);
 
+		// same shaders for LveModel::CompactVertex, a specialization constant switches the vertex shader to decoding
+		PipelineConfigInfo compactPipelineConfig{};
+		LvePipeline::defaultPipelineConfigInfo(compactPipelineConfig);
+
+		compactPipelineConfig.renderPass = renderPass;
+		compactPipelineConfig.pipelineLayout = pipelineLayout;
+		compactPipelineConfig.bindingDescriptions = LveModel::CompactVertex::getBindingDescriptions();
+		compactPipelineConfig.attributeDescriptions = LveModel::CompactVertex::getAttributeDescriptions();
+
+		VkBool32 compactVertices = VK_TRUE;
+		VkSpecializationMapEntry specializationEntry{ 0, 0, sizeof(VkBool32) }; // constant_id 0 = COMPACT_VERTICES
+		VkSpecializationInfo specializationInfo{ 1, &specializationEntry, sizeof(VkBool32), &compactVertices };
+		compactPipelineConfig.vertSpecializationInfo = &specializationInfo;
+
+		compactPipeline = std::make_unique<LvePipeline>(
+			lveDevice,
+			"C:\\Users\\suraj\\OneDrive\\Documents\\Visual Studio Projects\\Little Vulkan Game Engine\\simple_shader.vert.spv",
+			"C:\\Users\\suraj\\OneDrive\\Documents\\Visual Studio Projects\\Little Vulkan Game Engine\\simple_shader.frag.spv",
+			compactPipelineConfig);
+
 	}// createPipeline
 
+	void SimpleRenderSystem::prepareGameObjects(FrameInfo& frameInfo) {
+		LveDynamicBuffer& instanceBuffer = *instanceBuffers[frameInfo.frameIndex];
+		instanceBuffer.beginFrame(frameInfo.frameIndex);
+
+		drawItems.clear();
+		transformBatch.clear();
+		for (auto& kv : frameInfo.gameObject) {
+
+			auto& obj = kv.second;
+
+			// streamed models show up once their upload has reached the graphics queue
+			if (obj.model == nullptr || !obj.model->isResident())
+				continue;
+
+			drawItems.push_back(DrawItem{ obj.model.get(), 0, &obj });
+			transformBatch.add(obj.transform);
+
+		} // for
+
+		// only the transforms that changed since the last frame are rebuilt, the rest hand out their cached matrices
+		transformBatch.update();
+
+		frustumCuller.clear();
+		for (DrawItem& item : drawItems) {
+			item.modelMatrix = item.obj->transform.mat4();
+
+			// the culling pass tests the spheres and picks the levels itself
+			if (gpuCulling == nullptr)
+				frustumCuller.add(item.model->getBounds(), item.modelMatrix);
+
+		} // for
+
+		// an instanced draw cannot skip single objects, so whole objects are culled before they join a group
+		if (gpuCulling == nullptr) {
+			visibleItems.clear();
+			frustumCuller.cull(frameInfo.camera.getFrustum(), visibleItems);
+
+			// the survivors are compacted in place, their indices ascend so no item is overwritten before it is read
+			for (uint32_t i = 0; i < visibleItems.size(); i++) {
+				uint32_t item = visibleItems[i];
+				drawItems[i] = drawItems[item];
+				drawItems[i].lod = selectLod(*drawItems[i].obj, frustumCuller.getCenter(item), frustumCuller.getRadius(item), frameInfo.camera);
+
+			} // for
+
+			drawItems.resize(visibleItems.size());
+
+		} // if
+
+		if (drawItems.empty())
+			return;
+
+		// objects sharing a pipeline and the pool's buffers end up next to each other, within those one run per model and
+		// level, and every run goes front to back, the object's origin is close enough to order them
+		glm::vec3 cameraPosition = frameInfo.camera.getPosition();
+		glm::vec3 viewDirection = glm::vec3(frameInfo.camera.getInverseView()[2]);
+		const glm::vec4& farPlane = frameInfo.camera.getFrustum().getPlanes()[5];
+		float farDepth = glm::dot(glm::vec3(farPlane), cameraPosition) + farPlane.w;
+
+		renderQueue.clear();
+		for (uint32_t i = 0; i < drawItems.size(); i++) {
+			const DrawItem& item = drawItems[i];
+			uint32_t pipeline = item.model->hasCompactVertices() ? 1 : 0;
+			uint32_t binding = renderQueue.stateId(bindingState(item.model->getBinding()));
+			uint32_t model = renderQueue.stateId(handleBits(item.model));
+			float depth = glm::dot(glm::vec3(item.modelMatrix[3]) - cameraPosition, viewDirection);
+			renderQueue.push(LveRenderQueue::opaqueKey(pipeline, binding, model, item.lod, LveRenderQueue::quantizeDepth(depth, farDepth)), i);
+
+		} // for
+
+		renderQueue.sort();
+
+		sortedItems.clear();
+		for (const LveRenderQueue::Packet& packet : renderQueue.getPackets())
+			sortedItems.push_back(drawItems[packet.item]);
+
+		drawItems.swap(sortedItems);
+
+		// the instances are written in draw order, so a group's instances are a contiguous range starting at firstInstance
+		uint32_t instanceCount = static_cast<uint32_t>(drawItems.size());
+		instanceBuffer.reserve(instanceCount);
+		auto* instances = static_cast<LveModel::Instance*>(instanceBuffer.getMappedMemory());
+
+		for (uint32_t i = 0; i < instanceCount; i++) {
+			const DrawItem& item = drawItems[i];
+
+			// compact positions are stored inside the mesh bounds, fold the dequantization into the model matrix
+			glm::mat4 modelMatrix = item.model->hasCompactVertices() ? item.modelMatrix * item.model->getDequantizationMatrix() : item.modelMatrix;
+			instances[i] = LveModel::Instance::make(modelMatrix, item.obj->transform.normalMatrix());
+
+		} // for
+
+		instanceBuffer.buffer().flush(instanceCount * sizeof(LveModel::Instance), 0);
+
+		if (gpuCulling != nullptr)
+			recordGpuCulling(frameInfo);
+
+	} // prepareGameObjects
+
 	void SimpleRenderSystem::renderGameObjects(FrameInfo& frameInfo) {
-		lvePipeline->bind(frameInfo.commandBuffer);
+		if (drawItems.empty())
+			return;
+
+		glm::mat4 viewProjection = frameInfo.camera.getProjection() * frameInfo.camera.getView();
+		uint32_t itemCount = static_cast<uint32_t>(drawItems.size());
+
+		if (frameInfo.parallelRecorder == nullptr) {
+			RecordState state{};
+			recordGameObjects(frameInfo.commandBuffer, frameInfo, viewProjection, 0, itemCount, state);
+			renderQueue.addBinds(state.binds);
+			return;
+
+		} // if
+
+		// only direct draws cost CPU time per object, the indirect and culled paths are a handful of calls for one task
+		uint32_t taskCount = 1;
+		if (gpuCulling == nullptr && !indirectDrawing)
+			taskCount = std::clamp(itemCount / MIN_ITEMS_PER_TASK, 1u, frameInfo.parallelRecorder->getThreadCount() * TASKS_PER_THREAD);
+
+		// even slices of the draw list, each moved up to the start of a group so no instanced draw is split in two
+		taskFirstItems.clear();
+		for (uint32_t task = 0; task < taskCount; task++) {
+			uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(itemCount) * task / taskCount);
+			while (first > 0 && first < itemCount && drawItems[first].model == drawItems[first - 1].model && drawItems[first].lod == drawItems[first - 1].lod)
+				first++;
+
+			if (first < itemCount && (taskFirstItems.empty() || first > taskFirstItems.back()))
+				taskFirstItems.push_back(first);
+
+		} // for
 
+		taskCount = static_cast<uint32_t>(taskFirstItems.size());
+		taskFirstItems.push_back(itemCount);
+
+		recordStates.assign(taskCount, RecordState{});
+		frameInfo.parallelRecorder->record(frameInfo.commandBuffer, taskCount, [&](VkCommandBuffer commandBuffer, uint32_t task) {
+			recordGameObjects(commandBuffer, frameInfo, viewProjection, taskFirstItems[task], taskFirstItems[task + 1], recordStates[task]);
+
+		}); // record
+
+		for (const RecordState& state : recordStates)
+			renderQueue.addBinds(state.binds);
+
+	} // renderGameObjects
+
+	void SimpleRenderSystem::recordGameObjects(VkCommandBuffer commandBuffer, FrameInfo& frameInfo, const glm::mat4& viewProjection, uint32_t first, uint32_t end, RecordState& state) {
+		// the global set and this frame's instances stay bound for every draw
+		VkDescriptorSet descriptorSets[] = { frameInfo.globalDescriptorSet, instanceSets[frameInfo.frameIndex] };
 		vkCmdBindDescriptorSets
 		(
-			frameInfo.commandBuffer,
+			commandBuffer,
 			VK_PIPELINE_BIND_POINT_GRAPHICS,
 			pipelineLayout,
 			0,
+			2,
+			descriptorSets,
 			1,
-			&frameInfo.globalDescriptorSet,
-			0,
-			nullptr
+			&frameInfo.globalUboOffset
 
 		); // vkCmdBindDescriptorSets
 
-		for (auto& kv : frameInfo.gameObject) {
+		if (gpuCulling != nullptr)
+			recordGpuCulledDraws(commandBuffer, frameInfo, state);
+		else if (indirectDrawing)
+			recordIndirectDraws(commandBuffer, frameInfo, viewProjection, state);
+		else
+			recordDirectDraws(commandBuffer, frameInfo, viewProjection, first, end, state);
 
-			auto& obj = kv.second;
+	} // recordGameObjects
+
+	uint32_t SimpleRenderSystem::groupSize(uint32_t first, uint32_t end) const {
+		uint32_t count = 1;
+		while (first + count < end && drawItems[first + count].model == drawItems[first].model && drawItems[first + count].lod == drawItems[first].lod)
+			count++;
+
+		return count;
+
+	} // groupSize
+
+	void SimpleRenderSystem::bindModel(VkCommandBuffer commandBuffer, LveModel* model, RecordState& state) {
+		// both pipelines share the layout, so the global descriptor set stays bound across the switch
+		LvePipeline* pipeline = model->hasCompactVertices() ? compactPipeline.get() : lvePipeline.get();
+		if (pipeline != state.pipeline) {
+			pipeline->bind(commandBuffer);
+			state.pipeline = pipeline;
+			state.binds.pipelineBinds++;
+
+		} // if
+		else {
+			state.binds.pipelineBindsSkipped++;
+
+		} // else
+
+		// models sharing the geometry pool's buffers are drawn without rebinding, only their offsets differ
+		if (model->getBinding() != state.geometry) {
+			model->bind(commandBuffer);
+			state.geometry = model->getBinding();
+			state.binds.geometryBinds++;
+
+		} // if
+		else {
+			state.binds.geometryBindsSkipped++;
 
-			if (obj.model == nullptr)
+		} // else
+
+	} // bindModel
+
+	void SimpleRenderSystem::recordDirectDraws(VkCommandBuffer commandBuffer, FrameInfo& frameInfo, const glm::mat4& viewProjection, uint32_t firstItem, uint32_t endItem, RecordState& state) {
+		for (uint32_t first = firstItem, count = 0; first < endItem; first += count) {
+			count = groupSize(first, endItem);
+			LveModel* model = drawItems[first].model;
+			uint32_t lod = drawItems[first].lod;
+
+			bindModel(commandBuffer, model, state);
+
+			// meshlets are culled for one object at a time, a model drawn more than once is cheaper as one instanced draw
+			if (count == 1 && model->hasMeshlets()) {
+				// meshlet bounds are in model space, so bring the frustum and the camera there instead of moving every meshlet
+				const glm::mat4& modelMatrix = drawItems[first].modelMatrix;
+				LveFrustum modelFrustum = LveFrustum::fromMatrix(viewProjection * modelMatrix);
+				glm::vec3 cameraPosition = glm::vec3(glm::inverse(modelMatrix) * glm::vec4(frameInfo.camera.getPosition(), 1.f));
+				model->drawMeshlets(commandBuffer, modelFrustum, cameraPosition, meshletBackfaceCulling, lod, first);
+
+			} // if
+			else {
+				model->draw(commandBuffer, lod, count, first);
+
+			} // else
+
+		} // for
+
+	} // recordDirectDraws
+
+	void SimpleRenderSystem::recordIndirectDraws(VkCommandBuffer commandBuffer, FrameInfo& frameInfo, const glm::mat4& viewProjection, RecordState& state) {
+		// the items are sorted by pipeline and binding, so every batch is a contiguous run of commands
+		drawCommands.clear();
+		drawBatches.clear();
+		for (uint32_t first = 0, count = 0; first < drawItems.size(); first += count) {
+			count = groupSize(first, static_cast<uint32_t>(drawItems.size()));
+			LveModel* model = drawItems[first].model;
+			uint32_t lod = drawItems[first].lod;
+
+			// indirect records are indexed, the rare model without indices is drawn right away
+			if (!model->hasIndices()) {
+				bindModel(commandBuffer, model, state);
+				model->draw(commandBuffer, lod, count, first);
 				continue;
 
-			SimplePushConstantData push{};
-			push.modelMatrix = obj.transform.mat4(); 
-			push.normalMatrix = obj.transform.normalMatrix();
+			} // if
 
+			LvePipeline* pipeline = model->hasCompactVertices() ? compactPipeline.get() : lvePipeline.get();
+			if (drawBatches.empty() || drawBatches.back().pipeline != pipeline || drawBatches.back().model->getBinding() != model->getBinding())
+				drawBatches.push_back(DrawBatch{ pipeline, model, static_cast<uint32_t>(drawCommands.size()), 0 });
 
-			vkCmdPushConstants(
-				frameInfo.commandBuffer, 
-				pipelineLayout,
-				VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-				0,
-				sizeof(SimplePushConstantData),
-				&push
+			if (count == 1 && model->hasMeshlets()) {
+				const glm::mat4& modelMatrix = drawItems[first].modelMatrix;
+				LveFrustum modelFrustum = LveFrustum::fromMatrix(viewProjection * modelMatrix);
+				glm::vec3 cameraPosition = glm::vec3(glm::inverse(modelMatrix) * glm::vec4(frameInfo.camera.getPosition(), 1.f));
+				model->appendMeshletDrawCommands(drawCommands, modelFrustum, cameraPosition, meshletBackfaceCulling, lod, first);
 
-			); // vkCmdPushConstants
+			} // if
+			else {
+				model->appendDrawCommand(drawCommands, lod, count, first);
 
-			obj.model->bind(frameInfo.commandBuffer);
-			obj.model->draw(frameInfo.commandBuffer);
+			} // else
+
+			drawBatches.back().commandCount = static_cast<uint32_t>(drawCommands.size()) - drawBatches.back().firstCommand;
 
 		} // for
 
-	} // renderGameObjects
+		if (drawCommands.empty())
+			return;
+
+		// the records are read by this frame only, FirstApp flushes the allocator before the submit, the indirect path
+		// records as a single task so nothing else allocates meanwhile
+		constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+		LveFrameAllocator::Allocation records = frameInfo.frameAllocator.allocate(drawCommands.size() * stride);
+
+		// a full region costs the batching, not the frame, the host still has every record to draw directly
+		if (!records.isValid()) {
+			for (const DrawBatch& batch : drawBatches) {
+				bindModel(commandBuffer, batch.model, state);
+				for (uint32_t c = batch.firstCommand; c < batch.firstCommand + batch.commandCount; c++) {
+					const VkDrawIndexedIndirectCommand& command = drawCommands[c];
+					vkCmdDrawIndexed(commandBuffer, command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+
+				} // for
+
+			} // for
+
+			return;
+
+		} // if
+
+		std::memcpy(records.data, drawCommands.data(), drawCommands.size() * stride);
+
+		// one call per pipeline and binding, however many objects there are, the host knows every count so the count
+		// variant only pays off for the GPU culled draws
+		uint32_t maxDrawCount = lveDevice.properties.limits.maxDrawIndirectCount;
+		for (const DrawBatch& batch : drawBatches) {
+			bindModel(commandBuffer, batch.model, state);
+
+			VkDeviceSize offset = records.offset + static_cast<VkDeviceSize>(batch.firstCommand) * stride;
+			for (uint32_t drawn = 0; drawn < batch.commandCount; drawn += maxDrawCount) {
+				uint32_t drawCount = std::min(batch.commandCount - drawn, maxDrawCount);
+				vkCmdDrawIndexedIndirect(commandBuffer, records.buffer, offset + static_cast<VkDeviceSize>(drawn) * stride, drawCount, stride);
+
+			} // for
+
+		} // for
+
+	} // recordIndirectDraws
+
+	void SimpleRenderSystem::recordGpuCulling(FrameInfo& frameInfo) {
+		// a batch starts wherever the pipeline or the geometry binding changes between indexed objects, the objects are
+		// sorted by model, so the Object of the previous item is reused for everything but the batch
+		cullObjects.clear();
+		cullBatchFirstObjects.clear();
+		for (uint32_t i = 0; i < drawItems.size(); i++) {
+			LveModel* model = drawItems[i].model;
+			if (!model->hasIndices()) {
+				cullObjects.push_back(LveGpuCulling::Object{});
+				continue;
+
+			} // if
+
+			LveModel* batchModel = cullBatchFirstObjects.empty() ? nullptr : drawItems[cullBatchFirstObjects.back()].model;
+			if (batchModel == nullptr || batchModel->hasCompactVertices() != model->hasCompactVertices() || batchModel->getBinding() != model->getBinding())
+				cullBatchFirstObjects.push_back(i);
+
+			uint32_t batch = static_cast<uint32_t>(cullBatchFirstObjects.size()) - 1;
+			if (i > 0 && drawItems[i - 1].model == model) {
+				cullObjects.push_back(cullObjects.back());
+				cullObjects.back().batch = batch;
+
+			} // if
+			else {
+				cullObjects.push_back(LveGpuCulling::makeObject(*model, batch));
+
+			} // else
+
+		} // for
+
+		gpuCulling->cull(frameInfo.commandBuffer, frameInfo.frameIndex, frameInfo.camera, cullObjects, cullBatchFirstObjects);
+
+	} // recordGpuCulling
+
+	void SimpleRenderSystem::recordGpuCulledDraws(VkCommandBuffer commandBuffer, FrameInfo& frameInfo, RecordState& state) {
+		// the region of a batch reaches to the next one, the count buffer says how much of it the pass filled
+		uint32_t batchCount = static_cast<uint32_t>(cullBatchFirstObjects.size());
+		for (uint32_t b = 0; b < batchCount; b++) {
+			uint32_t first = cullBatchFirstObjects[b];
+			uint32_t end = b + 1 < batchCount ? cullBatchFirstObjects[b + 1] : static_cast<uint32_t>(drawItems.size());
+
+			bindModel(commandBuffer, drawItems[first].model, state);
+			gpuCulling->drawBatch(commandBuffer, frameInfo.frameIndex, b, end - first);
+
+		} // for
+
+		// the pass leaves models without indices alone, they are drawn unculled
+		for (uint32_t i = 0; i < drawItems.size(); i++) {
+			if (drawItems[i].model->hasIndices())
+				continue;
+
+			bindModel(commandBuffer, drawItems[i].model, state);
+			drawItems[i].model->draw(commandBuffer, 0, 1, i);
+
+		} // for
+
+	} // recordGpuCulledDraws
+
+	uint32_t SimpleRenderSystem::selectLod(LveGameObject& obj, const glm::vec3& center, float radius, const LveCamera& camera) {
+		uint32_t lodCount = obj.model->getLodCount();
+		if (lodCount <= 1)
+			return 0;
+
+		// projected radius over the half height of the screen, the same as the diameter over the full height,
+		// an orthographic projection does not shrink with distance
+		const glm::mat4& projection = camera.getProjection();
+		float screenSize = radius * projection[1][1];
+		if (projection[2][3] != 0.f) {
+			float distance = glm::length(center - camera.getPosition());
+			screenSize = distance > radius ? screenSize / distance : std::numeric_limits<float>::max();
+
+		} // if
+
+		uint32_t& lod = obj.lod;
+		lod = std::min(lod, lodCount - 1);
+
+		while (lod + 1 < lodCount && screenSize < LOD_SCREEN_SIZES[lod] * (1.f - LOD_HYSTERESIS))
+			lod++;
+
+		while (lod > 0 && screenSize > LOD_SCREEN_SIZES[lod - 1] * (1.f + LOD_HYSTERESIS))
+			lod--;
+
+		return lod;
+
+	} // selectLod
 
 	SimpleRenderSystem::~SimpleRenderSystem() {
 		vkDestroyPipelineLayout(lveDevice.device(), pipelineLayout, nullptr);
@@ -5,6 +5,12 @@
 #include "lve_game_object.hpp"
 #include "lve_camera.hpp"
 #include "lve_frame_info.hpp"
+#include "lve_dynamic_buffer.hpp"
+#include "lve_gpu_culling.hpp"
+#include "lve_frustum_culler.hpp"
+#include "lve_render_queue.hpp"
+#include "lve_descriptors.hpp"
+#include "lve_transform_batch.hpp"
 
 // std
 #include <memory>
@@ -17,19 +23,84 @@ namespace lve {
 
         SimpleRenderSystem(LveDevice &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout); 
         ~SimpleRenderSystem();
+        // gathers the objects and writes their instances, with GPU culling it also records the culling pass, so it goes
+        // outside of the render pass, before renderGameObjects of the same frame
+        void prepareGameObjects(FrameInfo &frameInfo);
         void renderGameObjects(FrameInfo &frameInfo);
 
+        // draw order and the binds it saved
+        const LveRenderQueue& getRenderQueue() const { return renderQueue; } // getRenderQueue
+
         SimpleRenderSystem(const SimpleRenderSystem&) = delete;
         SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
 
     private: 
+        void createInstanceSets();
         void createPipelineLayout(VkDescriptorSetLayout globalSetLayout); 
         void createPipeline(VkRenderPass renderPass);
+        uint32_t selectLod(LveGameObject& obj, const glm::vec3& center, float radius, const LveCamera& camera);
+        uint32_t groupSize(uint32_t first, uint32_t end) const; // drawItems from first on, before end, with the same model and lod
+
+        // what a command buffer has bound while it is recorded, every task of a parallel recording has its own
+        struct RecordState {
+            LvePipeline* pipeline = nullptr;
+            LveGeometryPool::Binding geometry{};
+            LveRenderQueue::Stats binds{}; // only the bind counts, added to the queue's once recording is done
+
+        }; // RecordState
+
+        // the draw items from first to end into commandBuffer, the indirect and GPU culled paths always take all of them
+        void recordGameObjects(VkCommandBuffer commandBuffer, FrameInfo& frameInfo, const glm::mat4& viewProjection, uint32_t first, uint32_t end, RecordState& state);
+        void bindModel(VkCommandBuffer commandBuffer, LveModel* model, RecordState& state);
+        void recordDirectDraws(VkCommandBuffer commandBuffer, FrameInfo& frameInfo, const glm::mat4& viewProjection, uint32_t firstItem, uint32_t endItem, RecordState& state);
+        void recordIndirectDraws(VkCommandBuffer commandBuffer, FrameInfo& frameInfo, const glm::mat4& viewProjection, RecordState& state);
+        void recordGpuCulling(FrameInfo& frameInfo);
+        void recordGpuCulledDraws(VkCommandBuffer commandBuffer, FrameInfo& frameInfo, RecordState& state);
+
+        // objects drawn with one vkCmdDrawIndexedIndirect, they share the pipeline and the geometry binding
+        struct DrawBatch {
+            LvePipeline* pipeline;
+            LveModel* model; // any of them, for binding the geometry
+            uint32_t firstCommand;
+            uint32_t commandCount;
+
+        }; // DrawBatch
+
+        // a visible object, sorted so objects drawn with one instanced draw are next to each other
+        struct DrawItem {
+            LveModel* model;
+            uint32_t lod;
+            LveGameObject* obj;
+            glm::mat4 modelMatrix{ 1.f };
+
+        }; // DrawItem
 
         LveDevice& lveDevice;
 
         std::unique_ptr<LvePipeline> lvePipeline;
+        std::unique_ptr<LvePipeline> compactPipeline; // for models with LveModel::CompactVertex
         VkPipelineLayout pipelineLayout;
+        bool meshletBackfaceCulling = false;
+        std::unique_ptr<LveDescriptorPool> instancePool;
+        std::unique_ptr<LveDescriptorSetLayout> instanceSetLayout; // set 1, the storage buffer of LveModel::Instance
+        std::vector<VkDescriptorSet> instanceSets; // per frame in flight, pointing at its instance buffer
+        std::vector<std::unique_ptr<LveDynamicBuffer>> instanceBuffers; // LveModel::Instance per object, one buffer per frame in flight
+        std::vector<DrawItem> drawItems; // kept to reuse the allocation every frame
+        LveTransformBatch transformBatch; // the dirty transforms of drawItems
+        LveFrustumCuller frustumCuller; // the world bounds of drawItems before culling, on the CPU path
+        std::vector<uint32_t> visibleItems;
+        LveRenderQueue renderQueue; // orders drawItems, the keys point back at them
+        std::vector<DrawItem> sortedItems;
+        std::vector<uint32_t> taskFirstItems; // the slices of a parallel recording, followed by the item count
+        std::vector<RecordState> recordStates;
+
+        bool indirectDrawing = false; // the device supports multi draw indirect
+        std::vector<VkDrawIndexedIndirectCommand> drawCommands; // copied to the frame allocator once they are all known
+        std::vector<DrawBatch> drawBatches;
+
+        std::unique_ptr<LveGpuCulling> gpuCulling; // null when the device cannot draw with counts from a buffer
+        std::vector<LveGpuCulling::Object> cullObjects;
+        std::vector<uint32_t> cullBatchFirstObjects;
         std::unique_ptr<LveModel> lveModel;
 
     }; // SimpleRenderSystem
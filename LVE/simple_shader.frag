@@ -26,12 +26,6 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
 
 } ubo;
 
-layout(push_constant) uniform Push {
-	mat4 modelMatrix; // proj * view * model
-	mat4 normalMatrix;
-
-} push;
-
 void main() {
 	// to avoid calculating the normal each time
 	vec3 diffuseLight = ubo.ambientLightColor.xyz * ubo.ambientLightColor.w;
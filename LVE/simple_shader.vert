@@ -29,18 +29,51 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
 
 } ubo;
 
-layout(push_constant) uniform Push {
-	mat4 modelMatrix; // proj * view * model
-	mat4 normalMatrix;
+// LveModel::Instance, one per object, gl_InstanceIndex starts at the draw's firstInstance so every object sharing a
+// model is drawn by one instanced draw
+struct Instance {
+	vec4 modelRows[3]; // mat3x4, the last row is always 0 0 0 1
+	uint normalMatrix[5]; // half floats, column by column
+	uint padding[3];
 
-} push;
+}; // Instance
+
+layout(std430, set = 1, binding = 0) readonly buffer Instances { Instance instances[]; };
+
+// set by the pipeline for LveModel::CompactVertex: positions are unorm inside the mesh bounds (the model matrix
+// already contains the dequantization), colors and uvs are expanded by the vertex formats, only the octahedral
+// normal that arrives as (x, y, 0) needs decoding here
+layout(constant_id = 0) const bool COMPACT_VERTICES = false;
+
+vec3 decodeOctahedral(vec2 e) {
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+
+} // decodeOctahedral
+
+mat3 unpackNormalMatrix(Instance instance) {
+	vec2 h01 = unpackHalf2x16(instance.normalMatrix[0]);
+	vec2 h23 = unpackHalf2x16(instance.normalMatrix[1]);
+	vec2 h45 = unpackHalf2x16(instance.normalMatrix[2]);
+	vec2 h67 = unpackHalf2x16(instance.normalMatrix[3]);
+	vec2 h8 = unpackHalf2x16(instance.normalMatrix[4]);
+	return mat3(h01, h23, h45, h67, h8.x);
+
+} // unpackNormalMatrix
 
 void main() {
-	vec4 positionWorld =  push.modelMatrix * vec4(position, 1.0);
-	gl_Position = ubo.projection * ubo.view * positionWorld;
+	vec3 vertexNormal = COMPACT_VERTICES ? decodeOctahedral(normal.xy) : normal;
+
+	// a row vector times the rows' matrix is the model matrix times the column vector
+	Instance instance = instances[gl_InstanceIndex];
+	vec3 positionWorld = vec4(position, 1.0) * mat3x4(instance.modelRows[0], instance.modelRows[1], instance.modelRows[2]);
+	gl_Position = ubo.projection * ubo.view * vec4(positionWorld, 1.0);
 
-	fragNormalWorld = normalize( mat3(push.normalMatrix) * normal );
-	fragPosWorld = positionWorld.xyz;
+	fragNormalWorld = normalize( unpackNormalMatrix(instance) * vertexNormal );
+	fragPosWorld = positionWorld;
 	fragColor = color;
 
 